@@ -0,0 +1,200 @@
+///////////////////////////////////////////////////////////////////////////////
+// batchrenderer.cpp
+// ============
+// render a list of camera views of the 3D scene into image files
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BatchRenderer.h"
+#include "FrameCapture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// vertical field of view of views that do not give one
+	const float DEFAULT_FIELD_OF_VIEW = 45.0f;
+	// largest image size accepted in a view file, where the
+	// views larger than a tile are rendered in tiles
+	const int MAX_IMAGE_SIZE = 262144;
+}
+
+/***********************************************************
+ *  BatchRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BatchRenderer::BatchRenderer(ViewManager* pViewManager, std::function<void()> drawFrame)
+	: m_tiledRenderer(pViewManager, drawFrame)
+{
+	m_pViewManager = pViewManager;
+	m_drawFrame = drawFrame;
+	m_tileSize = 0;
+	m_renderedCount = 0;
+	m_renderSeconds = 0.0;
+}
+
+/***********************************************************
+ *  ~BatchRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+BatchRenderer::~BatchRenderer()
+{
+	m_pViewManager = NULL;
+	m_renderTarget.Destroy();
+}
+
+/***********************************************************
+ *  LoadViews()
+ *
+ *  This method is used for reading the camera views from a
+ *  text file.  Each line holds the image name, its width and
+ *  height, the camera position, the point it looks at, and
+ *  an optional vertical field of view in degrees:
+ *
+ *    name width height px py pz tx ty tz [fov]
+ *
+ *  Blank lines and lines starting with '#' are skipped.
+ ***********************************************************/
+bool BatchRenderer::LoadViews(const std::string& filename, std::vector<BATCH_VIEW>& views)
+{
+	std::ifstream file(filename);
+	if (!file)
+	{
+		std::cout << "Could not open the view file: " << filename << std::endl;
+		return(false);
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+
+		size_t start = line.find_first_not_of(" \t\r");
+		if ((start == std::string::npos) || (line[start] == '#'))
+		{
+			continue;
+		}
+
+		std::istringstream fields(line);
+		BATCH_VIEW view;
+		fields >> view.name >> view.width >> view.height
+			>> view.position.x >> view.position.y >> view.position.z
+			>> view.target.x >> view.target.y >> view.target.z;
+		if (!fields)
+		{
+			std::cout << filename << "(" << lineNumber << "): expected name, size, position and target" << std::endl;
+			return(false);
+		}
+
+		view.fieldOfView = DEFAULT_FIELD_OF_VIEW;
+		float fieldOfView = 0.0f;
+		if (fields >> fieldOfView)
+		{
+			view.fieldOfView = fieldOfView;
+		}
+		else if (!fields.eof())
+		{
+			std::cout << filename << "(" << lineNumber << "): invalid field of view" << std::endl;
+			return(false);
+		}
+
+		if ((view.width < 1) || (view.height < 1) ||
+			(view.width > MAX_IMAGE_SIZE) || (view.height > MAX_IMAGE_SIZE) ||
+			(view.fieldOfView <= 0.0f) || (view.fieldOfView >= 180.0f))
+		{
+			std::cout << filename << "(" << lineNumber << "): view size or field of view out of range" << std::endl;
+			return(false);
+		}
+
+		views.push_back(view);
+	}
+
+	if (views.empty())
+	{
+		std::cout << "No views found in: " << filename << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  RenderViews()
+ *
+ *  This method is used for rendering the views at the first
+ *  index and every viewStep after it, which lets several
+ *  processes split one list between them.  The target is
+ *  sized once for the largest of these views that fits in a
+ *  tile, and each view renders into its lower left area.
+ ***********************************************************/
+bool BatchRenderer::RenderViews(
+	const std::vector<BATCH_VIEW>& views,
+	size_t firstView,
+	size_t viewStep,
+	const std::string& outputDirectory,
+	const std::string& imageFormat)
+{
+	viewStep = std::max<size_t>(1, viewStep);
+	int tileSize = (m_tileSize > 0) ? std::min(m_tileSize, TiledRenderer::GetMaxTileSize()) : TiledRenderer::GetDefaultTileSize();
+
+	int maxWidth = 0;
+	int maxHeight = 0;
+	for (size_t i = firstView; i < views.size(); i += viewStep)
+	{
+		if ((views[i].width <= tileSize) && (views[i].height <= tileSize))
+		{
+			maxWidth = std::max(maxWidth, views[i].width);
+			maxHeight = std::max(maxHeight, views[i].height);
+		}
+	}
+	if ((maxWidth > 0) && (maxHeight > 0) &&
+		(m_renderTarget.Resize(std::max(maxWidth, m_renderTarget.GetWidth()), std::max(maxHeight, m_renderTarget.GetHeight())) == false))
+	{
+		return(false);
+	}
+
+	FrameCapture frameCapture(outputDirectory, imageFormat);
+	bool bTilesSaved = true;
+	auto startTime = std::chrono::steady_clock::now();
+
+	for (size_t i = firstView; i < views.size(); i += viewStep)
+	{
+		const BATCH_VIEW& view = views[i];
+
+		if ((view.width > tileSize) || (view.height > tileSize))
+		{
+			std::string filename = (std::filesystem::path(outputDirectory) / (view.name + "." + imageFormat)).string();
+			if (m_tiledRenderer.RenderStill(filename, view.width, view.height,
+				view.position, view.target, view.fieldOfView, tileSize) == false)
+			{
+				bTilesSaved = false;
+			}
+			m_renderedCount++;
+			continue;
+		}
+
+		m_pViewManager->SetFramebufferSize(view.width, view.height);
+		m_pViewManager->SetCameraPose(view.position, view.target, view.fieldOfView);
+
+		m_renderTarget.Bind(view.width, view.height);
+		m_drawFrame();
+		frameCapture.CaptureFrame(view.name, view.width, view.height);
+		m_renderedCount++;
+	}
+
+	// the throughput counts the views as done once saved
+	bool bSaved = (frameCapture.Finish()) && (bTilesSaved);
+
+	std::chrono::duration<double> renderTime = std::chrono::steady_clock::now() - startTime;
+	m_renderSeconds += renderTime.count();
+
+	return(bSaved);
+}
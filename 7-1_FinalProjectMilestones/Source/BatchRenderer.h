@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+// batchrenderer.h
+// ============
+// render a list of camera views of the 3D scene into image files
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ViewManager.h"
+#include "RenderTarget.h"
+#include "TiledRenderer.h"
+
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  BATCH_VIEW
+ *
+ *  One camera view of a batch, with the size and name of
+ *  the image it is saved to.
+ ***********************************************************/
+struct BATCH_VIEW
+{
+	std::string name;
+	int width;
+	int height;
+	glm::vec3 position;
+	glm::vec3 target;
+	float fieldOfView;
+};
+
+/***********************************************************
+ *  BatchRenderer
+ *
+ *  This class contains the code for rendering many views of
+ *  a scene that is prepared once.  The views are drawn back
+ *  to back into one offscreen target, which is allocated at
+ *  the largest view size.  The views are read back and
+ *  saved by a frame capture, so the next view is drawn while
+ *  the earlier ones are still being copied and encoded.
+ *  Views larger than the tile size are rendered in tiles and
+ *  streamed to their files instead.
+ ***********************************************************/
+class BatchRenderer
+{
+public:
+	// constructor
+	BatchRenderer(ViewManager* pViewManager, std::function<void()> drawFrame);
+	// destructor
+	~BatchRenderer();
+
+	// read the camera views listed in a text file
+	static bool LoadViews(const std::string& filename, std::vector<BATCH_VIEW>& views);
+
+	// set the size of the tiles that large views are split
+	// into, where zero uses the default size
+	void SetTileSize(int tileSize) { m_tileSize = tileSize; }
+
+	// render every view from the first one, stepping by the
+	// passed in count, and save them in the output directory
+	bool RenderViews(
+		const std::vector<BATCH_VIEW>& views,
+		size_t firstView,
+		size_t viewStep,
+		const std::string& outputDirectory,
+		const std::string& imageFormat);
+
+	// number of views rendered and the time they took
+	int GetRenderedCount() const { return(m_renderedCount); }
+	double GetRenderSeconds() const { return(m_renderSeconds); }
+
+private:
+	// pointer to view manager object
+	ViewManager* m_pViewManager;
+	// draws the scene into the bound framebuffer
+	std::function<void()> m_drawFrame;
+	// offscreen target that every view is drawn into
+	RenderTarget m_renderTarget;
+	// renders the views that are larger than the tile size
+	TiledRenderer m_tiledRenderer;
+	int m_tileSize;
+	int m_renderedCount;
+	double m_renderSeconds;
+};
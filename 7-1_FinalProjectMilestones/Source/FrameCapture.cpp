@@ -0,0 +1,294 @@
+///////////////////////////////////////////////////////////////////////////////
+// framecapture.cpp
+// ============
+// save rendered frames to image files without stalling the GPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameCapture.h"
+#include "GLStateCache.h"
+#include "ImageWriter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	// a fence is waited for in slices, flushing the commands
+	// only on the first one so the fence can be reached
+	const GLuint64 FENCE_WAIT_NANOSECONDS = 1000000;
+}
+
+/***********************************************************
+ *  FrameCapture()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameCapture::FrameCapture(const std::string& outputDirectory, const std::string& imageFormat)
+{
+	m_nextReadback = 0;
+	m_pendingReadbacks = 0;
+	m_outputDirectory = outputDirectory;
+	m_imageFormat = imageFormat;
+	m_capturedCount = 0;
+	m_stallCount = 0;
+	m_imageCount = 0;
+	m_bWriteFailed = false;
+
+	for (int i = 0; i < READBACK_BUFFERS; i++)
+	{
+		glGenBuffers(1, &m_readbacks[i].buffer);
+		m_readbacks[i].size = 0;
+		m_readbacks[i].fence = NULL;
+		m_readbacks[i].width = 0;
+		m_readbacks[i].height = 0;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(m_outputDirectory, error);
+
+	// one core is left for the render loop
+	unsigned int threadCount = std::thread::hardware_concurrency();
+	m_pWorkerPool = new WorkerPool(std::max(1u, (threadCount > 1) ? threadCount - 1 : 1u));
+}
+
+/***********************************************************
+ *  ~FrameCapture()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameCapture::~FrameCapture()
+{
+	Finish();
+
+	delete m_pWorkerPool;
+	m_pWorkerPool = NULL;
+
+	for (int i = 0; i < READBACK_BUFFERS; i++)
+	{
+		GLStateCache::DeleteBuffers(1, &m_readbacks[i].buffer);
+		m_readbacks[i].buffer = 0;
+	}
+}
+
+/***********************************************************
+ *  CaptureFrame()
+ *
+ *  This method is used for starting the capture of the
+ *  lower left area of the bound read framebuffer.  The copy
+ *  into the pixel buffer is only queued on the GPU, and the
+ *  pixels are read as RGBA, which drivers copy without a
+ *  conversion, then turned into RGB by the workers.
+ ***********************************************************/
+void FrameCapture::CaptureFrame(const std::string& name, int width, int height)
+{
+	if ((width <= 0) || (height <= 0))
+	{
+		return;
+	}
+
+	// free the oldest buffer when the ring is full, which only
+	// waits if the GPU is more than two frames behind
+	Update();
+	if (m_pendingReadbacks == READBACK_BUFFERS)
+	{
+		m_stallCount++;
+		ReadOldestCapture(true);
+	}
+
+	READBACK& readback = m_readbacks[m_nextReadback];
+	GLsizeiptr size = (GLsizeiptr)width * height * 4;
+
+	GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+	if (readback.size < size)
+	{
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+		readback.size = size;
+	}
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	readback.width = width;
+	readback.height = height;
+	readback.filename = (std::filesystem::path(m_outputDirectory) / (name + "." + m_imageFormat)).string();
+
+	m_nextReadback = (m_nextReadback + 1) % READBACK_BUFFERS;
+	m_pendingReadbacks++;
+	m_capturedCount++;
+}
+
+/***********************************************************
+ *  CaptureNextFrame()
+ *
+ *  This method is used for capturing a frame of a sequence,
+ *  named by its number so the files sort in frame order.
+ ***********************************************************/
+void FrameCapture::CaptureNextFrame(int width, int height)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "frame_%06d", m_capturedCount);
+	CaptureFrame(name, width, height);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for handing every capture that the
+ *  GPU has finished copying to the workers, without waiting.
+ ***********************************************************/
+void FrameCapture::Update()
+{
+	while ((m_pendingReadbacks > 0) && (ReadOldestCapture(false)))
+	{
+	}
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for waiting until every capture has
+ *  been read back and saved.
+ ***********************************************************/
+bool FrameCapture::Finish()
+{
+	while (m_pendingReadbacks > 0)
+	{
+		ReadOldestCapture(true);
+	}
+	m_pWorkerPool->WaitForAll();
+
+	return(m_bWriteFailed == false);
+}
+
+/***********************************************************
+ *  ReadOldestCapture()
+ *
+ *  This method is used for copying the oldest capture out of
+ *  its pixel buffer and queueing it for a worker.  A capture
+ *  whose buffer can not be mapped is dropped and counts as a
+ *  failed write.  False is returned when bWait is false and
+ *  the GPU has not reached the fence after the copy yet.
+ ***********************************************************/
+bool FrameCapture::ReadOldestCapture(bool bWait)
+{
+	int oldest = (m_nextReadback + READBACK_BUFFERS - m_pendingReadbacks) % READBACK_BUFFERS;
+	READBACK& readback = m_readbacks[oldest];
+
+	GLenum result = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	if ((result == GL_TIMEOUT_EXPIRED) && (bWait == false))
+	{
+		return(false);
+	}
+	while (result == GL_TIMEOUT_EXPIRED)
+	{
+		result = glClientWaitSync(readback.fence, 0, FENCE_WAIT_NANOSECONDS);
+	}
+	glDeleteSync(readback.fence);
+	readback.fence = NULL;
+	m_pendingReadbacks--;
+
+	// the mapped pixels are copied out right away, so the
+	// buffer is free for the next capture
+	size_t size = (size_t)readback.width * readback.height * 4;
+	std::vector<uint8_t> pixels = AcquireImage();
+	pixels.resize(size);
+
+	GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+	const void* pMapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+	if (NULL == pMapped)
+	{
+		// the capture is dropped instead of saving an image of
+		// pixels that were never read back
+		GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		std::cout << "Could not map the pixel buffer of capture:" << readback.filename << std::endl;
+		m_bWriteFailed = true;
+
+		std::lock_guard<std::mutex> lock(m_imageMutex);
+		m_freeImages.push_back(std::move(pixels));
+		m_imageReturned.notify_one();
+		return(true);
+	}
+	memcpy(pixels.data(), pMapped, size);
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	int width = readback.width;
+	int height = readback.height;
+	std::string filename = readback.filename;
+	m_pWorkerPool->Submit([this, pixels = std::move(pixels), width, height, filename]() mutable
+		{
+			SaveImage(pixels, width, height, filename);
+		});
+
+	return(true);
+}
+
+/***********************************************************
+ *  AcquireImage()
+ *
+ *  This method is used for getting a buffer for the pixels
+ *  of a capture.  The buffers are reused, and when all of
+ *  them are waiting to be saved, the capture waits for a
+ *  worker to return one, so the memory use stays bounded.
+ ***********************************************************/
+std::vector<uint8_t> FrameCapture::AcquireImage()
+{
+	std::unique_lock<std::mutex> lock(m_imageMutex);
+
+	if ((m_freeImages.empty()) && (m_imageCount >= MAX_QUEUED_IMAGES))
+	{
+		m_stallCount++;
+		m_imageReturned.wait(lock, [this]() { return(m_freeImages.empty() == false); });
+	}
+
+	if (m_freeImages.empty())
+	{
+		m_imageCount++;
+		return(std::vector<uint8_t>());
+	}
+
+	std::vector<uint8_t> pixels = std::move(m_freeImages.back());
+	m_freeImages.pop_back();
+	return(pixels);
+}
+
+/***********************************************************
+ *  SaveImage()
+ *
+ *  This method is used on a worker thread for converting the
+ *  RGBA rows, which OpenGL returns from the bottom up, into
+ *  top down RGB rows and saving them.  The pixel buffer is
+ *  then returned for the next capture.
+ ***********************************************************/
+void FrameCapture::SaveImage(std::vector<uint8_t>& pixels, int width, int height, const std::string& filename)
+{
+	thread_local std::vector<uint8_t> rgbPixels;
+	rgbPixels.resize((size_t)width * height * 3);
+
+	for (int y = 0; y < height; y++)
+	{
+		const uint8_t* pSource = &pixels[(size_t)(height - 1 - y) * width * 4];
+		uint8_t* pTarget = &rgbPixels[(size_t)y * width * 3];
+		for (int x = 0; x < width; x++)
+		{
+			pTarget[x * 3 + 0] = pSource[x * 4 + 0];
+			pTarget[x * 3 + 1] = pSource[x * 4 + 1];
+			pTarget[x * 3 + 2] = pSource[x * 4 + 2];
+		}
+	}
+
+	if (ImageWriter::WriteImage(filename, width, height, rgbPixels) == false)
+	{
+		m_bWriteFailed = true;
+	}
+
+	std::lock_guard<std::mutex> lock(m_imageMutex);
+	m_freeImages.push_back(std::move(pixels));
+	m_imageReturned.notify_one();
+}
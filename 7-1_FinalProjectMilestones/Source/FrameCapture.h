@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////
+// framecapture.h
+// ============
+// save rendered frames to image files without stalling the GPU
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "WorkerPool.h"
+
+#include <GL/glew.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  FrameCapture
+ *
+ *  This class contains the code for capturing frames.  Each
+ *  capture copies the read framebuffer into the next pixel
+ *  buffer of a ring, which the GPU does in the background,
+ *  and places a fence after the copy.  Once the fence has
+ *  passed, a few frames later, the pixels are taken out of
+ *  the buffer and a worker thread encodes and saves them,
+ *  so the render loop never waits for the GPU or the disk.
+ ***********************************************************/
+class FrameCapture
+{
+public:
+	// constructor - images are written to the directory in
+	// the "png" or "ppm" format
+	FrameCapture(const std::string& outputDirectory, const std::string& imageFormat);
+	// destructor - waits for the images still being saved
+	~FrameCapture();
+
+	// capture the lower left area of the read framebuffer
+	void CaptureFrame(const std::string& name, int width, int height);
+	// capture a frame named by its number in the sequence
+	void CaptureNextFrame(int width, int height);
+	// hand the captures that the GPU has finished to the workers
+	void Update();
+	// wait until every captured frame is saved, false if any
+	// image could not be written
+	bool Finish();
+
+	// number of frames captured so far
+	int GetCapturedCount() const { return(m_capturedCount); }
+	// number of times a capture waited for the GPU or for the
+	// workers to catch up
+	int GetStallCount() const { return(m_stallCount); }
+
+private:
+	// three buffers give the GPU two frames to finish a copy
+	// before the render loop needs its buffer again
+	static const int READBACK_BUFFERS = 3;
+	// most images waiting for a worker before captures wait
+	static const int MAX_QUEUED_IMAGES = 8;
+
+	// a pixel buffer of the ring and the capture it holds
+	struct READBACK
+	{
+		GLuint buffer;
+		GLsizeiptr size;
+		GLsync fence;
+		int width;
+		int height;
+		std::string filename;
+	};
+
+	// the buffers cannot be shared between objects
+	FrameCapture(const FrameCapture&) = delete;
+	FrameCapture& operator=(const FrameCapture&) = delete;
+
+	READBACK m_readbacks[READBACK_BUFFERS];
+	// next buffer of the ring and the number of captures that
+	// are still in the buffers before it
+	int m_nextReadback;
+	int m_pendingReadbacks;
+	std::string m_outputDirectory;
+	std::string m_imageFormat;
+	int m_capturedCount;
+	int m_stallCount;
+
+	// encodes and saves the images
+	WorkerPool* m_pWorkerPool;
+	// image buffers that are reused between the captures
+	std::vector<std::vector<uint8_t>> m_freeImages;
+	int m_imageCount;
+	std::mutex m_imageMutex;
+	std::condition_variable m_imageReturned;
+	std::atomic<bool> m_bWriteFailed;
+
+	// copy the oldest capture out of its buffer, waiting for
+	// the GPU when bWait is true, and queue it for saving
+	bool ReadOldestCapture(bool bWait);
+	// get an image buffer, waiting when too many are queued
+	std::vector<uint8_t> AcquireImage();
+	// convert and save one image on a worker thread
+	void SaveImage(std::vector<uint8_t>& pixels, int width, int height, const std::string& filename);
+};
@@ -0,0 +1,153 @@
+///////////////////////////////////////////////////////////////////////////////
+// framelimiter.cpp
+// ============
+// pace the rendered frames to an even target rate
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameLimiter.h"
+
+#include <algorithm>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	// the wait sleeps in short slices, and spins once the time
+	// left is within the usual overshoot of one slice
+	const std::chrono::microseconds SLEEP_SLICE(1000);
+	// a low-latency frame starts this much earlier than the
+	// predicted frame time requires, to absorb small variation
+	const std::chrono::microseconds LOW_LATENCY_MARGIN(1000);
+	// share of the difference that a shorter frame or sleep
+	// takes off the prediction, so one slow frame is remembered
+	// for a while but not forever
+	const int PREDICTION_DECAY_DIVISOR = 32;
+}
+
+/***********************************************************
+ *  FrameLimiter()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameLimiter::FrameLimiter(double targetRateHz, bool bLowLatency)
+{
+	m_period = Clock::duration::zero();
+	if (targetRateHz > 0.0)
+	{
+		m_period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetRateHz));
+	}
+	m_bLowLatency = bLowLatency;
+	m_slotStart = Clock::now();
+	m_frameStart = m_slotStart;
+	m_predictedWork = Clock::duration::zero();
+	m_sleepOvershoot = SLEEP_SLICE;
+}
+
+/***********************************************************
+ *  ~FrameLimiter()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameLimiter::~FrameLimiter()
+{
+}
+
+/***********************************************************
+ *  WaitForFrameStart()
+ *
+ *  This method is used at the top of the render loop, before
+ *  the input is sampled.  The slots follow each other at the
+ *  target period, so the frames are evenly paced even when
+ *  their work varies.  A loop that fell more than a whole
+ *  slot behind starts over from the current time instead of
+ *  rushing frames out to catch up.
+ ***********************************************************/
+void FrameLimiter::WaitForFrameStart()
+{
+	Clock::time_point now = Clock::now();
+
+	if (m_period == Clock::duration::zero())
+	{
+		m_frameStart = now;
+		return;
+	}
+
+	if (now - m_slotStart > m_period)
+	{
+		m_slotStart = now;
+	}
+
+	Clock::time_point target = m_slotStart;
+	if (m_bLowLatency)
+	{
+		Clock::duration delay = m_period - m_predictedWork - LOW_LATENCY_MARGIN;
+		target += std::max(Clock::duration::zero(), delay);
+	}
+
+	WaitUntil(target);
+
+	m_frameStart = Clock::now();
+	m_slotStart += m_period;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used after the buffers are swapped, for
+ *  measuring how long the frame took.  A longer frame raises
+ *  the prediction right away, and shorter frames lower it
+ *  gradually.
+ ***********************************************************/
+void FrameLimiter::EndFrame()
+{
+	Clock::duration work = Clock::now() - m_frameStart;
+
+	if (work > m_predictedWork)
+	{
+		m_predictedWork = work;
+	}
+	else
+	{
+		m_predictedWork -= (m_predictedWork - work) / PREDICTION_DECAY_DIVISOR;
+	}
+}
+
+/***********************************************************
+ *  WaitUntil()
+ *
+ *  This method is used for waiting precisely until the
+ *  passed in time.  Sleeps are only as precise as the system
+ *  timer, which can be a whole millisecond or more, so the
+ *  overshoot of each sleep is measured and the last part of
+ *  the wait spins instead.
+ ***********************************************************/
+void FrameLimiter::WaitUntil(Clock::time_point target)
+{
+	while (true)
+	{
+		Clock::time_point now = Clock::now();
+		if (now >= target)
+		{
+			return;
+		}
+
+		if (target - now > SLEEP_SLICE + m_sleepOvershoot)
+		{
+			std::this_thread::sleep_for(SLEEP_SLICE);
+
+			Clock::duration overshoot = (Clock::now() - now) - SLEEP_SLICE;
+			if (overshoot > m_sleepOvershoot)
+			{
+				m_sleepOvershoot = overshoot;
+			}
+			else
+			{
+				m_sleepOvershoot -= (m_sleepOvershoot - overshoot) / PREDICTION_DECAY_DIVISOR;
+			}
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
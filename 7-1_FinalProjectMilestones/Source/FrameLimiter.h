@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+// framelimiter.h
+// ============
+// pace the rendered frames to an even target rate
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+
+/***********************************************************
+ *  FrameLimiter
+ *
+ *  This class contains the code for holding the frames to a
+ *  target rate.  Each frame has a fixed length slot, and the
+ *  loop waits at the start of a frame until its slot begins,
+ *  first by sleeping and then by spinning for the last part
+ *  that the sleep cannot hit precisely.  In low-latency mode
+ *  the wait lasts until just before the end of the slot, as
+ *  late as the recent frame times allow, so the input is
+ *  sampled as close as possible to when the frame is shown.
+ ***********************************************************/
+class FrameLimiter
+{
+public:
+	// constructor - a rate of zero leaves the frames uncapped
+	FrameLimiter(double targetRateHz, bool bLowLatency);
+	// destructor
+	~FrameLimiter();
+
+	// wait until the next frame should start
+	void WaitForFrameStart();
+	// record the end of a frame, after the buffers are swapped
+	void EndFrame();
+
+	// true when input sampling is delayed to the end of a slot
+	bool IsLowLatency() const { return(m_bLowLatency); }
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	// length of a frame slot, zero when uncapped
+	Clock::duration m_period;
+	bool m_bLowLatency;
+	// start of the slot of the next frame
+	Clock::time_point m_slotStart;
+	Clock::time_point m_frameStart;
+	// longest recent time from frame start to swap
+	Clock::duration m_predictedWork;
+	// how much longer than asked a sleep usually takes
+	Clock::duration m_sleepOvershoot;
+
+	// sleep and spin until the passed in time
+	void WaitUntil(Clock::time_point target);
+};
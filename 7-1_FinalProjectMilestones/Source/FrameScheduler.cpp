@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+// framescheduler.cpp
+// ============
+// schedule fixed timestep updates between the rendered frames
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameScheduler.h"
+
+#include <algorithm>
+
+// declaration of global variables
+namespace
+{
+	const int64_t NANOSECONDS_PER_SECOND = 1000000000;
+
+	// longest frame time that is caught up on, so a stall such
+	// as a window drag does not run a burst of updates
+	const int64_t MAX_FRAME_NANOSECONDS = NANOSECONDS_PER_SECOND / 4;
+	// most updates run for one frame, so a machine that cannot
+	// keep up slows the simulation down instead of falling
+	// further behind with every frame
+	const int MAX_STEPS_PER_FRAME = 8;
+}
+
+/***********************************************************
+ *  FrameScheduler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameScheduler::FrameScheduler(double updateRateHz)
+{
+	m_stepNanoseconds = std::max((int64_t)1, (int64_t)(NANOSECONDS_PER_SECOND / updateRateHz));
+	m_accumulatedNanoseconds = 0;
+	m_stepCount = 0;
+	m_lastFrameTime = Clock::now();
+}
+
+/***********************************************************
+ *  ~FrameScheduler()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameScheduler::~FrameScheduler()
+{
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting a frame.  The elapsed
+ *  time is added to the accumulator, and the number of whole
+ *  update steps that must be run before rendering is
+ *  returned.  Those steps are taken out of the accumulator.
+ ***********************************************************/
+int FrameScheduler::BeginFrame()
+{
+	Clock::time_point currentTime = Clock::now();
+	int64_t frameNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		currentTime - m_lastFrameTime).count();
+	m_lastFrameTime = currentTime;
+
+	m_accumulatedNanoseconds += std::min(frameNanoseconds, MAX_FRAME_NANOSECONDS);
+
+	int steps = (int)std::min(m_accumulatedNanoseconds / m_stepNanoseconds, (int64_t)MAX_STEPS_PER_FRAME);
+	m_accumulatedNanoseconds -= steps * m_stepNanoseconds;
+	// time beyond the step limit is dropped
+	m_accumulatedNanoseconds = std::min(m_accumulatedNanoseconds, m_stepNanoseconds - 1);
+	m_stepCount += steps;
+
+	return(steps);
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for restarting the frame timer after
+ *  the loop was idle, such as while waiting for events, so
+ *  the idle time is not simulated by the next frame.
+ ***********************************************************/
+void FrameScheduler::Reset()
+{
+	m_lastFrameTime = Clock::now();
+}
+
+/***********************************************************
+ *  GetStepSeconds()
+ *
+ *  This method is used for getting the length of one update
+ *  step in seconds.
+ ***********************************************************/
+double FrameScheduler::GetStepSeconds() const
+{
+	return((double)m_stepNanoseconds / (double)NANOSECONDS_PER_SECOND);
+}
+
+/***********************************************************
+ *  GetInterpolation()
+ *
+ *  This method is used for getting how far the rendered
+ *  frame is between the previous and the latest updated
+ *  states, from 0 to just under 1.
+ ***********************************************************/
+double FrameScheduler::GetInterpolation() const
+{
+	return((double)m_accumulatedNanoseconds / (double)m_stepNanoseconds);
+}
+
+/***********************************************************
+ *  GetSimulationSeconds()
+ *
+ *  This method is used for getting the simulated time, as
+ *  the number of steps times the step length.
+ ***********************************************************/
+double FrameScheduler::GetSimulationSeconds() const
+{
+	return(((double)m_stepCount * (double)m_stepNanoseconds) / (double)NANOSECONDS_PER_SECOND);
+}
@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////
+// framescheduler.h
+// ============
+// schedule fixed timestep updates between the rendered frames
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/***********************************************************
+ *  FrameScheduler
+ *
+ *  This class contains the code for a fixed timestep main
+ *  loop.  The time since the last frame is added to an
+ *  accumulator, and the number of whole update steps that
+ *  fit in it are run before the frame is rendered.  The
+ *  remainder is used for interpolating between the last two
+ *  updated states.  Time is kept in integer nanoseconds of
+ *  a monotonic clock, so the steps are exactly the same
+ *  length no matter how long the application has run.
+ ***********************************************************/
+class FrameScheduler
+{
+public:
+	// constructor - the rate is the number of updates per second
+	FrameScheduler(double updateRateHz);
+	// destructor
+	~FrameScheduler();
+
+	// start a frame and get the number of updates to run
+	int BeginFrame();
+	// restart the frame timer, so idle time is not caught up
+	void Reset();
+
+	// length of one update step
+	double GetStepSeconds() const;
+	// fraction of a step between the last two updated states
+	double GetInterpolation() const;
+	// number of update steps run since the start
+	uint64_t GetStepCount() const { return(m_stepCount); }
+	// simulated time, which advances only by whole steps
+	double GetSimulationSeconds() const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	Clock::time_point m_lastFrameTime;
+	// length of a step and the time that is not simulated yet
+	int64_t m_stepNanoseconds;
+	int64_t m_accumulatedNanoseconds;
+	uint64_t m_stepCount;
+};
@@ -0,0 +1,178 @@
+///////////////////////////////////////////////////////////////////////////////
+// framesync.cpp
+// ============
+// overlap the CPU and GPU work of consecutive frames with fences
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameSync.h"
+#include "GLStateCache.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// name and binding point of the uniform block in the shaders
+	const char* g_FrameUniformsName = "FrameUniforms";
+	const GLuint FRAME_UNIFORMS_BINDING = 0;
+
+	/***********************************************************
+	 *  FRAME_UNIFORMS
+	 *
+	 *  The per-frame shader data, laid out by the std140 rules
+	 *  of the FrameUniforms block.
+	 ***********************************************************/
+	struct FRAME_UNIFORMS
+	{
+		float view[16];
+		float projection[16];
+		float viewPosition[3];
+		float padding;
+	};
+
+	// a fence is waited for in slices, flushing the commands
+	// only on the first one so the fence can be reached
+	const GLuint64 FENCE_WAIT_NANOSECONDS = 1000000;
+}
+
+/***********************************************************
+ *  FrameSync()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameSync::FrameSync()
+{
+	m_frameIndex = 0;
+	m_lastWaitMs = 0.0;
+	for (int i = 0; i < FRAMES_IN_FLIGHT; i++)
+	{
+		m_fences[i] = NULL;
+	}
+
+	GLint alignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	m_regionStride = ((sizeof(FRAME_UNIFORMS) + alignment - 1) / alignment) * alignment;
+
+	glGenBuffers(1, &m_uniformBuffer);
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, m_uniformBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, m_regionStride * FRAMES_IN_FLIGHT, NULL, GL_DYNAMIC_DRAW);
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	// connect the block of the program in use to the binding
+	GLint program = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+	GLuint blockIndex = glGetUniformBlockIndex(program, g_FrameUniformsName);
+	if (blockIndex != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(program, blockIndex, FRAME_UNIFORMS_BINDING);
+	}
+}
+
+/***********************************************************
+ *  ~FrameSync()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameSync::~FrameSync()
+{
+	for (int i = 0; i < FRAMES_IN_FLIGHT; i++)
+	{
+		if (NULL != m_fences[i])
+		{
+			glDeleteSync(m_fences[i]);
+			m_fences[i] = NULL;
+		}
+	}
+	GLStateCache::DeleteBuffers(1, &m_uniformBuffer);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting a frame on the next
+ *  region of the uniform buffer.  If the GPU has not yet
+ *  finished the frame that last used the region, the CPU
+ *  waits here, which keeps it a bounded number of frames
+ *  ahead.  The wait should be called as late as possible,
+ *  after the CPU work that does not touch the region.
+ ***********************************************************/
+void FrameSync::BeginFrame()
+{
+	m_frameIndex = (m_frameIndex + 1) % FRAMES_IN_FLIGHT;
+	m_lastWaitMs = 0.0;
+
+	GLsync fence = m_fences[m_frameIndex];
+	if (NULL == fence)
+	{
+		return;
+	}
+
+	auto waitStartTime = std::chrono::steady_clock::now();
+
+	GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	while (result == GL_TIMEOUT_EXPIRED)
+	{
+		result = glClientWaitSync(fence, 0, FENCE_WAIT_NANOSECONDS);
+	}
+
+	glDeleteSync(fence);
+	m_fences[m_frameIndex] = NULL;
+
+	std::chrono::duration<double, std::milli> waitTime = std::chrono::steady_clock::now() - waitStartTime;
+	m_lastWaitMs = waitTime.count();
+}
+
+/***********************************************************
+ *  SetFrameUniforms()
+ *
+ *  This method is used for writing the camera of the frame
+ *  into its region of the uniform buffer, and binding the
+ *  region to the block of the shaders.  The region is free,
+ *  so the buffer is mapped without synchronization and the
+ *  driver does not wait for the earlier frames.  It should
+ *  be called once per frame, after BeginFrame().
+ ***********************************************************/
+void FrameSync::SetFrameUniforms(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& viewPosition)
+{
+	FRAME_UNIFORMS uniforms;
+	memcpy(uniforms.view, glm::value_ptr(view), sizeof(uniforms.view));
+	memcpy(uniforms.projection, glm::value_ptr(projection), sizeof(uniforms.projection));
+	memcpy(uniforms.viewPosition, glm::value_ptr(viewPosition), sizeof(uniforms.viewPosition));
+	uniforms.padding = 0.0f;
+
+	GLintptr offset = m_regionStride * m_frameIndex;
+
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, m_uniformBuffer);
+	void* pRegion = glMapBufferRange(GL_UNIFORM_BUFFER, offset, sizeof(FRAME_UNIFORMS),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (NULL != pRegion)
+	{
+		memcpy(pRegion, &uniforms, sizeof(FRAME_UNIFORMS));
+		glUnmapBuffer(GL_UNIFORM_BUFFER);
+	}
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	GLStateCache::BindBufferRange(GL_UNIFORM_BUFFER, FRAME_UNIFORMS_BINDING, m_uniformBuffer, offset, sizeof(FRAME_UNIFORMS));
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for placing the fence of the frame,
+ *  after all of its draw calls, which signals when the GPU
+ *  is done reading its region.
+ ***********************************************************/
+void FrameSync::EndFrame()
+{
+	if (NULL != m_fences[m_frameIndex])
+	{
+		glDeleteSync(m_fences[m_frameIndex]);
+	}
+	m_fences[m_frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////
+// framesync.h
+// ============
+// overlap the CPU and GPU work of consecutive frames with fences
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  FrameSync
+ *
+ *  This class contains the code for the per-frame shader
+ *  data, which is kept in one uniform buffer with a region
+ *  for each frame in flight.  The CPU writes the region of
+ *  the next frame while the GPU still reads the regions of
+ *  the earlier frames, and a fence placed at the end of each
+ *  frame tells when its region can be written again.  The
+ *  CPU never runs more frames ahead of the GPU than there
+ *  are regions, and never stalls before that.
+ ***********************************************************/
+class FrameSync
+{
+public:
+	// constructor - the scene shader program must be in use
+	FrameSync();
+	// destructor
+	~FrameSync();
+
+	// start a frame, waiting until its region is free
+	void BeginFrame();
+	// write the camera of the frame into its region
+	void SetFrameUniforms(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		const glm::vec3& viewPosition);
+	// end a frame, after all of its draw calls
+	void EndFrame();
+
+	// time the last frame waited for the GPU to free its region
+	double GetLastWaitMs() const { return(m_lastWaitMs); }
+
+private:
+	// three regions let the CPU prepare a frame while the GPU
+	// draws the one before it, with one more as slack for
+	// the frame that is being presented
+	static const int FRAMES_IN_FLIGHT = 3;
+
+	// the buffer cannot be shared between objects
+	FrameSync(const FrameSync&) = delete;
+	FrameSync& operator=(const FrameSync&) = delete;
+
+	GLuint m_uniformBuffer;
+	// distance between the regions, a multiple of the uniform
+	// buffer offset alignment
+	GLintptr m_regionStride;
+	// fence of the last frame that used each region
+	GLsync m_fences[FRAMES_IN_FLIGHT];
+	int m_frameIndex;
+	double m_lastWaitMs;
+};
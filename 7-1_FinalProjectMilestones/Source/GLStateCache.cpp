@@ -0,0 +1,436 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.cpp
+// ============
+// shadow the OpenGL state to skip calls that would not change it
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLStateCache.h"
+
+// declaration of the global variables and defines
+namespace
+{
+	// marks shadowed state that is not known, so the next call
+	// is always passed on
+	const GLuint UNKNOWN_STATE = 0xFFFFFFFF;
+
+	// capabilities that are shadowed, where the others are
+	// passed on without caching
+	const GLenum CACHED_CAPABILITIES[] =
+	{
+		GL_DEPTH_TEST, GL_BLEND, GL_CULL_FACE, GL_SCISSOR_TEST, GL_STENCIL_TEST
+	};
+	const int CACHED_CAPABILITY_COUNT = sizeof(CACHED_CAPABILITIES) / sizeof(CACHED_CAPABILITIES[0]);
+
+	// buffer targets that are shadowed.  The element array
+	// buffer belongs to the bound vertex array, so it is
+	// always passed on.
+	const GLenum CACHED_BUFFER_TARGETS[] =
+	{
+		GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_PIXEL_PACK_BUFFER, GL_PIXEL_UNPACK_BUFFER, GL_DRAW_INDIRECT_BUFFER
+	};
+	const GLenum CACHED_BUFFER_BINDINGS[] =
+	{
+		GL_ARRAY_BUFFER_BINDING, GL_UNIFORM_BUFFER_BINDING, GL_PIXEL_PACK_BUFFER_BINDING,
+		GL_PIXEL_UNPACK_BUFFER_BINDING, GL_DRAW_INDIRECT_BUFFER_BINDING
+	};
+	const int CACHED_BUFFER_TARGET_COUNT = sizeof(CACHED_BUFFER_TARGETS) / sizeof(CACHED_BUFFER_TARGETS[0]);
+
+	// 2D textures are shadowed on this many texture units
+	const int CACHED_TEXTURE_UNITS = 32;
+
+	// the shadowed state
+	GLuint g_capabilities[CACHED_CAPABILITY_COUNT];
+	GLenum g_blendSourceFactor = UNKNOWN_STATE;
+	GLenum g_blendDestinationFactor = UNKNOWN_STATE;
+	GLenum g_activeTextureUnit = UNKNOWN_STATE;
+	GLuint g_textures[CACHED_TEXTURE_UNITS];
+	GLuint g_program = UNKNOWN_STATE;
+	GLuint g_vertexArray = UNKNOWN_STATE;
+	GLuint g_buffers[CACHED_BUFFER_TARGET_COUNT];
+	bool g_bCacheEnabled = true;
+	bool g_bStateRead = false;
+
+	// call counts of the frame in progress and of the earlier ones
+	uint64_t g_frameCalls = 0;
+	uint64_t g_frameRedundantCalls = 0;
+	GL_STATE_STATS g_stats = { 0, 0, 0, 0, 0 };
+
+	/***********************************************************
+	 *  IsRedundant()
+	 *
+	 *  Count a state call and check whether it would leave
+	 *  the shadowed value unchanged, in which case it can be
+	 *  dropped.  The shadowed value is updated either way.
+	 ***********************************************************/
+	bool IsRedundant(GLuint& shadowedValue, GLuint value)
+	{
+		g_frameCalls++;
+		if (shadowedValue == value)
+		{
+			g_frameRedundantCalls++;
+			return(g_bCacheEnabled);
+		}
+
+		shadowedValue = value;
+		return(false);
+	}
+
+	/***********************************************************
+	 *  FindCapability()
+	 *
+	 *  Get the shadowed index of a capability, or -1.
+	 ***********************************************************/
+	int FindCapability(GLenum capability)
+	{
+		for (int i = 0; i < CACHED_CAPABILITY_COUNT; i++)
+		{
+			if (CACHED_CAPABILITIES[i] == capability)
+			{
+				return(i);
+			}
+		}
+		return(-1);
+	}
+
+	/***********************************************************
+	 *  FindBufferTarget()
+	 *
+	 *  Get the shadowed index of a buffer target, or -1.
+	 ***********************************************************/
+	int FindBufferTarget(GLenum target)
+	{
+		for (int i = 0; i < CACHED_BUFFER_TARGET_COUNT; i++)
+		{
+			if (CACHED_BUFFER_TARGETS[i] == target)
+			{
+				return(i);
+			}
+		}
+		return(-1);
+	}
+
+	/***********************************************************
+	 *  InvalidateState()
+	 *
+	 *  Mark all of the shadowed state as not known.
+	 ***********************************************************/
+	void InvalidateState()
+	{
+		for (int i = 0; i < CACHED_CAPABILITY_COUNT; i++)
+		{
+			g_capabilities[i] = UNKNOWN_STATE;
+		}
+		for (int i = 0; i < CACHED_TEXTURE_UNITS; i++)
+		{
+			g_textures[i] = UNKNOWN_STATE;
+		}
+		for (int i = 0; i < CACHED_BUFFER_TARGET_COUNT; i++)
+		{
+			g_buffers[i] = UNKNOWN_STATE;
+		}
+		g_blendSourceFactor = UNKNOWN_STATE;
+		g_blendDestinationFactor = UNKNOWN_STATE;
+		g_activeTextureUnit = UNKNOWN_STATE;
+		g_program = UNKNOWN_STATE;
+		g_vertexArray = UNKNOWN_STATE;
+		g_bStateRead = true;
+	}
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for reading the current state of the
+ *  context into the cache, after a context is created or
+ *  after code outside of the cache has changed the state.
+ *  It queries the driver, so it is not meant for each frame.
+ ***********************************************************/
+void GLStateCache::Reset()
+{
+	InvalidateState();
+
+	for (int i = 0; i < CACHED_CAPABILITY_COUNT; i++)
+	{
+		g_capabilities[i] = glIsEnabled(CACHED_CAPABILITIES[i]);
+	}
+
+	GLint value = 0;
+	glGetIntegerv(GL_BLEND_SRC_RGB, &value);
+	g_blendSourceFactor = (GLenum)value;
+	glGetIntegerv(GL_BLEND_DST_RGB, &value);
+	g_blendDestinationFactor = (GLenum)value;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &value);
+	g_program = (GLuint)value;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &value);
+	g_vertexArray = (GLuint)value;
+
+	for (int i = 0; i < CACHED_BUFFER_TARGET_COUNT; i++)
+	{
+		glGetIntegerv(CACHED_BUFFER_BINDINGS[i], &value);
+		g_buffers[i] = (GLuint)value;
+	}
+
+	// the texture of each unit is read by activating the unit,
+	// and the active unit is restored afterwards
+	GLint activeTextureUnit = GL_TEXTURE0;
+	GLint textureUnitCount = 0;
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTextureUnit);
+	glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &textureUnitCount);
+	for (int i = 0; (i < CACHED_TEXTURE_UNITS) && (i < textureUnitCount); i++)
+	{
+		glActiveTexture(GL_TEXTURE0 + i);
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &value);
+		g_textures[i] = (GLuint)value;
+	}
+	glActiveTexture(activeTextureUnit);
+	g_activeTextureUnit = (GLenum)activeTextureUnit;
+}
+
+/***********************************************************
+ *  SetEnabled()
+ *
+ *  This method is used for turning the dropping of redundant
+ *  calls on or off.  The calls are counted either way, so
+ *  the two can be compared.
+ ***********************************************************/
+void GLStateCache::SetEnabled(bool bEnabled)
+{
+	g_bCacheEnabled = bEnabled;
+}
+
+/***********************************************************
+ *  Enable()
+ *
+ *  This method is used for enabling an OpenGL capability.
+ ***********************************************************/
+void GLStateCache::Enable(GLenum capability)
+{
+	int index = FindCapability(capability);
+	if ((g_bStateRead) && (index != -1) && (IsRedundant(g_capabilities[index], GL_TRUE)))
+	{
+		return;
+	}
+	glEnable(capability);
+}
+
+/***********************************************************
+ *  Disable()
+ *
+ *  This method is used for disabling an OpenGL capability.
+ ***********************************************************/
+void GLStateCache::Disable(GLenum capability)
+{
+	int index = FindCapability(capability);
+	if ((g_bStateRead) && (index != -1) && (IsRedundant(g_capabilities[index], GL_FALSE)))
+	{
+		return;
+	}
+	glDisable(capability);
+}
+
+/***********************************************************
+ *  BlendFunc()
+ *
+ *  This method is used for setting the blending factors of
+ *  the color and alpha channels.
+ ***********************************************************/
+void GLStateCache::BlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+	if (g_bStateRead)
+	{
+		g_frameCalls++;
+		if ((g_blendSourceFactor == sourceFactor) && (g_blendDestinationFactor == destinationFactor))
+		{
+			g_frameRedundantCalls++;
+			if (g_bCacheEnabled)
+			{
+				return;
+			}
+		}
+		g_blendSourceFactor = sourceFactor;
+		g_blendDestinationFactor = destinationFactor;
+	}
+	glBlendFunc(sourceFactor, destinationFactor);
+}
+
+/***********************************************************
+ *  ActiveTexture()
+ *
+ *  This method is used for selecting the texture unit that
+ *  BindTexture() binds to.
+ ***********************************************************/
+void GLStateCache::ActiveTexture(GLenum textureUnit)
+{
+	if ((g_bStateRead) && (IsRedundant(g_activeTextureUnit, textureUnit)))
+	{
+		return;
+	}
+	glActiveTexture(textureUnit);
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method is used for binding a texture to the active
+ *  texture unit.  Only 2D textures are shadowed.
+ ***********************************************************/
+void GLStateCache::BindTexture(GLenum target, GLuint texture)
+{
+	int unit = (int)g_activeTextureUnit - GL_TEXTURE0;
+	if ((g_bStateRead) && (target == GL_TEXTURE_2D) && (unit >= 0) && (unit < CACHED_TEXTURE_UNITS) &&
+		(IsRedundant(g_textures[unit], texture)))
+	{
+		return;
+	}
+	glBindTexture(target, texture);
+}
+
+/***********************************************************
+ *  UseProgram()
+ *
+ *  This method is used for making a shader program current.
+ ***********************************************************/
+void GLStateCache::UseProgram(GLuint program)
+{
+	if ((g_bStateRead) && (IsRedundant(g_program, program)))
+	{
+		return;
+	}
+	glUseProgram(program);
+}
+
+/***********************************************************
+ *  BindVertexArray()
+ *
+ *  This method is used for binding a vertex array object.
+ ***********************************************************/
+void GLStateCache::BindVertexArray(GLuint vertexArray)
+{
+	if ((g_bStateRead) && (IsRedundant(g_vertexArray, vertexArray)))
+	{
+		return;
+	}
+	glBindVertexArray(vertexArray);
+}
+
+/***********************************************************
+ *  BindBuffer()
+ *
+ *  This method is used for binding a buffer to a target.
+ ***********************************************************/
+void GLStateCache::BindBuffer(GLenum target, GLuint buffer)
+{
+	int index = FindBufferTarget(target);
+	if ((g_bStateRead) && (index != -1) && (IsRedundant(g_buffers[index], buffer)))
+	{
+		return;
+	}
+	glBindBuffer(target, buffer);
+}
+
+/***********************************************************
+ *  BindBufferRange()
+ *
+ *  This method is used for binding a range of a buffer to an
+ *  indexed binding point.  The indexed bindings are always
+ *  set, and the call also binds the buffer to the target.
+ ***********************************************************/
+void GLStateCache::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	glBindBufferRange(target, index, buffer, offset, size);
+
+	int targetIndex = FindBufferTarget(target);
+	if (targetIndex != -1)
+	{
+		g_buffers[targetIndex] = buffer;
+	}
+}
+
+/***********************************************************
+ *  DeleteTextures()
+ *
+ *  This method is used for deleting textures.  OpenGL unbinds
+ *  a deleted texture from the units, so it is cleared from
+ *  the shadowed bindings too.
+ ***********************************************************/
+void GLStateCache::DeleteTextures(GLsizei count, const GLuint* pTextures)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		for (int unit = 0; unit < CACHED_TEXTURE_UNITS; unit++)
+		{
+			if (g_textures[unit] == pTextures[i])
+			{
+				g_textures[unit] = 0;
+			}
+		}
+	}
+	glDeleteTextures(count, pTextures);
+}
+
+/***********************************************************
+ *  DeleteBuffers()
+ *
+ *  This method is used for deleting buffers, and clearing
+ *  them from the shadowed bindings.
+ ***********************************************************/
+void GLStateCache::DeleteBuffers(GLsizei count, const GLuint* pBuffers)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		for (int target = 0; target < CACHED_BUFFER_TARGET_COUNT; target++)
+		{
+			if (g_buffers[target] == pBuffers[i])
+			{
+				g_buffers[target] = 0;
+			}
+		}
+	}
+	glDeleteBuffers(count, pBuffers);
+}
+
+/***********************************************************
+ *  DeleteVertexArrays()
+ *
+ *  This method is used for deleting vertex arrays, and
+ *  clearing them from the shadowed binding.
+ ***********************************************************/
+void GLStateCache::DeleteVertexArrays(GLsizei count, const GLuint* pVertexArrays)
+{
+	for (GLsizei i = 0; i < count; i++)
+	{
+		if (g_vertexArray == pVertexArrays[i])
+		{
+			g_vertexArray = 0;
+		}
+	}
+	glDeleteVertexArrays(count, pVertexArrays);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for closing the call counts of the
+ *  frame, and starting those of the next one.
+ ***********************************************************/
+void GLStateCache::EndFrame()
+{
+	g_stats.frameCalls = g_frameCalls;
+	g_stats.frameRedundantCalls = g_frameRedundantCalls;
+	g_stats.totalCalls += g_frameCalls;
+	g_stats.totalRedundantCalls += g_frameRedundantCalls;
+	g_stats.frameCount++;
+
+	g_frameCalls = 0;
+	g_frameRedundantCalls = 0;
+}
+
+/***********************************************************
+ *  GetStats()
+ *
+ *  This method is used for getting the call counts.
+ ***********************************************************/
+const GL_STATE_STATS& GLStateCache::GetStats()
+{
+	return(g_stats);
+}
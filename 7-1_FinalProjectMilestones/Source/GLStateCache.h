@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.h
+// ============
+// shadow the OpenGL state to skip calls that would not change it
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstdint>
+
+/***********************************************************
+ *  GL_STATE_STATS
+ *
+ *  Counts of the state calls that went through the cache.
+ ***********************************************************/
+struct GL_STATE_STATS
+{
+	// state calls made in the last finished frame, and how
+	// many of them would not have changed anything
+	uint64_t frameCalls;
+	uint64_t frameRedundantCalls;
+	// totals over all of the finished frames
+	uint64_t totalCalls;
+	uint64_t totalRedundantCalls;
+	uint64_t frameCount;
+};
+
+/***********************************************************
+ *  GLStateCache
+ *
+ *  This class contains the code for a thin layer over the
+ *  OpenGL calls that change the enabled capabilities, the
+ *  bound textures, program, vertex array and buffers.  The
+ *  last value set is kept, and a call that would set the
+ *  same value again is dropped before it reaches the driver,
+ *  which saves its validation work.
+ *
+ *  The state belongs to the one OpenGL context of the
+ *  process.  Code that changes this state directly must
+ *  call Reset() afterwards, and objects must be deleted
+ *  through the cache so their names are not thought to be
+ *  bound when OpenGL hands them out again.
+ ***********************************************************/
+class GLStateCache
+{
+public:
+	// read the current state of the context into the cache
+	static void Reset();
+	// pass every call to OpenGL, still counting the redundant
+	// ones, for comparing against the cached calls
+	static void SetEnabled(bool bEnabled);
+
+	// enable and disable capabilities
+	static void Enable(GLenum capability);
+	static void Disable(GLenum capability);
+	// set the blending factors
+	static void BlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+
+	// select the active texture unit and bind a texture to it
+	static void ActiveTexture(GLenum textureUnit);
+	static void BindTexture(GLenum target, GLuint texture);
+	// bind a program, vertex array or buffer
+	static void UseProgram(GLuint program);
+	static void BindVertexArray(GLuint vertexArray);
+	static void BindBuffer(GLenum target, GLuint buffer);
+	static void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+	// delete objects and forget where they were bound
+	static void DeleteTextures(GLsizei count, const GLuint* pTextures);
+	static void DeleteBuffers(GLsizei count, const GLuint* pBuffers);
+	static void DeleteVertexArrays(GLsizei count, const GLuint* pVertexArrays);
+
+	// finish counting the calls of a frame
+	static void EndFrame();
+	// get the call counts
+	static const GL_STATE_STATS& GetStats();
+};
@@ -0,0 +1,388 @@
+///////////////////////////////////////////////////////////////////////////////
+// headlesscontext.cpp
+// ============
+// create an OpenGL context without a window or a display server
+///////////////////////////////////////////////////////////////////////////////
+
+#include "HeadlessContext.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <dlfcn.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+#ifdef __linux__
+	// the EGL types and values that are used, so that building
+	// does not need the EGL headers
+	typedef void* EGLDisplay;
+	typedef void* EGLConfig;
+	typedef void* EGLSurface;
+	typedef void* EGLContext;
+	typedef void* EGLDeviceEXT;
+	typedef int EGLint;
+	typedef unsigned int EGLenum;
+	typedef unsigned int EGLBoolean;
+
+	const EGLint EGL_NONE = 0x3038;
+	const EGLint EGL_SURFACE_TYPE = 0x3033;
+	const EGLint EGL_PBUFFER_BIT = 0x0001;
+	const EGLint EGL_RENDERABLE_TYPE = 0x3040;
+	const EGLint EGL_OPENGL_BIT = 0x0008;
+	const EGLint EGL_RED_SIZE = 0x3024;
+	const EGLint EGL_GREEN_SIZE = 0x3023;
+	const EGLint EGL_BLUE_SIZE = 0x3022;
+	const EGLint EGL_DEPTH_SIZE = 0x3025;
+	const EGLint EGL_WIDTH = 0x3057;
+	const EGLint EGL_HEIGHT = 0x3056;
+	const EGLint EGL_EXTENSIONS = 0x3055;
+	const EGLint EGL_CONTEXT_MAJOR_VERSION = 0x3098;
+	const EGLint EGL_CONTEXT_MINOR_VERSION = 0x30FB;
+	const EGLint EGL_CONTEXT_OPENGL_PROFILE_MASK = 0x30FD;
+	const EGLint EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT = 0x0001;
+	const EGLenum EGL_OPENGL_API = 0x30A2;
+	const EGLenum EGL_PLATFORM_DEVICE_EXT = 0x313F;
+	const EGLenum EGL_PLATFORM_SURFACELESS_MESA = 0x31DD;
+
+	/***********************************************************
+	 *  EGL_FUNCTIONS
+	 *
+	 *  The EGL functions that are looked up in the library.
+	 ***********************************************************/
+	struct EGL_FUNCTIONS
+	{
+		void* (*GetProcAddress)(const char*);
+		EGLDisplay (*GetDisplay)(void*);
+		EGLBoolean (*Initialize)(EGLDisplay, EGLint*, EGLint*);
+		EGLBoolean (*Terminate)(EGLDisplay);
+		const char* (*QueryString)(EGLDisplay, EGLint);
+		EGLBoolean (*BindAPI)(EGLenum);
+		EGLBoolean (*ChooseConfig)(EGLDisplay, const EGLint*, EGLConfig*, EGLint, EGLint*);
+		EGLSurface (*CreatePbufferSurface)(EGLDisplay, EGLConfig, const EGLint*);
+		EGLBoolean (*DestroySurface)(EGLDisplay, EGLSurface);
+		EGLContext (*CreateContext)(EGLDisplay, EGLConfig, EGLContext, const EGLint*);
+		EGLBoolean (*DestroyContext)(EGLDisplay, EGLContext);
+		EGLBoolean (*MakeCurrent)(EGLDisplay, EGLSurface, EGLSurface, EGLContext);
+		// extensions, which may be missing
+		EGLDisplay (*GetPlatformDisplayEXT)(EGLenum, void*, const EGLint*);
+		EGLBoolean (*QueryDevicesEXT)(EGLint, EGLDeviceEXT*, EGLint*);
+	};
+	EGL_FUNCTIONS g_egl;
+
+	// the OpenGL versions asked for, from the newest down to the
+	// oldest one that runs the scene shaders
+	const EGLint CONTEXT_VERSIONS[][2] = { { 4, 6 }, { 4, 5 }, { 4, 4 } };
+
+	/***********************************************************
+	 *  HasExtension()
+	 *
+	 *  Check whether a space separated extension string holds
+	 *  the passed in name as a whole word.
+	 ***********************************************************/
+	bool HasExtension(const char* extensions, const char* name)
+	{
+		if (NULL == extensions)
+		{
+			return(false);
+		}
+
+		size_t length = strlen(name);
+		const char* pFound = strstr(extensions, name);
+		while (NULL != pFound)
+		{
+			bool bWordStart = (pFound == extensions) || (pFound[-1] == ' ');
+			bool bWordEnd = (pFound[length] == ' ') || (pFound[length] == '\0');
+			if ((bWordStart) && (bWordEnd))
+			{
+				return(true);
+			}
+			pFound = strstr(pFound + length, name);
+		}
+
+		return(false);
+	}
+
+	/***********************************************************
+	 *  LoadFunction()
+	 *
+	 *  Look up one EGL function, first as a library symbol and
+	 *  then through eglGetProcAddress for extensions.
+	 ***********************************************************/
+	template <typename T>
+	bool LoadFunction(void* pLibrary, const char* name, T& function)
+	{
+		void* pAddress = dlsym(pLibrary, name);
+		if ((NULL == pAddress) && (NULL != g_egl.GetProcAddress))
+		{
+			pAddress = g_egl.GetProcAddress(name);
+		}
+
+		function = reinterpret_cast<T>(pAddress);
+		return(NULL != pAddress);
+	}
+#endif
+}
+
+/***********************************************************
+ *  HeadlessContext()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+HeadlessContext::HeadlessContext()
+{
+	m_pLibrary = NULL;
+	m_display = NULL;
+	m_surface = NULL;
+	m_context = NULL;
+}
+
+/***********************************************************
+ *  ~HeadlessContext()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+HeadlessContext::~HeadlessContext()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the context and making
+ *  it current on the calling thread.  A hardware context is
+ *  tried first, and the software rasterizer is only used
+ *  when no GPU can be reached.
+ ***********************************************************/
+bool HeadlessContext::Create()
+{
+#ifdef __linux__
+	m_pLibrary = dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+	if (NULL == m_pLibrary)
+	{
+		std::cout << "Headless rendering needs libEGL.so.1: " << dlerror() << std::endl;
+		return(false);
+	}
+
+	memset(&g_egl, 0, sizeof(g_egl));
+	bool bLoaded =
+		LoadFunction(m_pLibrary, "eglGetProcAddress", g_egl.GetProcAddress) &&
+		LoadFunction(m_pLibrary, "eglGetDisplay", g_egl.GetDisplay) &&
+		LoadFunction(m_pLibrary, "eglInitialize", g_egl.Initialize) &&
+		LoadFunction(m_pLibrary, "eglTerminate", g_egl.Terminate) &&
+		LoadFunction(m_pLibrary, "eglQueryString", g_egl.QueryString) &&
+		LoadFunction(m_pLibrary, "eglBindAPI", g_egl.BindAPI) &&
+		LoadFunction(m_pLibrary, "eglChooseConfig", g_egl.ChooseConfig) &&
+		LoadFunction(m_pLibrary, "eglCreatePbufferSurface", g_egl.CreatePbufferSurface) &&
+		LoadFunction(m_pLibrary, "eglDestroySurface", g_egl.DestroySurface) &&
+		LoadFunction(m_pLibrary, "eglCreateContext", g_egl.CreateContext) &&
+		LoadFunction(m_pLibrary, "eglDestroyContext", g_egl.DestroyContext) &&
+		LoadFunction(m_pLibrary, "eglMakeCurrent", g_egl.MakeCurrent);
+	if (bLoaded == false)
+	{
+		std::cout << "The EGL library is missing required functions" << std::endl;
+		Destroy();
+		return(false);
+	}
+	LoadFunction(m_pLibrary, "eglGetPlatformDisplayEXT", g_egl.GetPlatformDisplayEXT);
+	LoadFunction(m_pLibrary, "eglQueryDevicesEXT", g_egl.QueryDevicesEXT);
+
+	if ((CreateEGLContext(false)) || (CreateEGLContext(true)))
+	{
+		std::cout << "INFO: Created headless context on " << m_description << std::endl;
+		return(true);
+	}
+
+	std::cout << "Could not create a headless OpenGL context" << std::endl;
+	Destroy();
+	return(false);
+#else
+	std::cout << "Headless rendering is only supported on Linux" << std::endl;
+	return(false);
+#endif
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for releasing the context from the
+ *  calling thread and freeing it.
+ ***********************************************************/
+void HeadlessContext::Destroy()
+{
+#ifdef __linux__
+	if (NULL != m_display)
+	{
+		g_egl.MakeCurrent(m_display, NULL, NULL, NULL);
+		if (NULL != m_context)
+		{
+			g_egl.DestroyContext(m_display, m_context);
+		}
+		if (NULL != m_surface)
+		{
+			g_egl.DestroySurface(m_display, m_surface);
+		}
+		g_egl.Terminate(m_display);
+	}
+	if (NULL != m_pLibrary)
+	{
+		dlclose(m_pLibrary);
+	}
+#endif
+	m_pLibrary = NULL;
+	m_display = NULL;
+	m_surface = NULL;
+	m_context = NULL;
+}
+
+/***********************************************************
+ *  CreateEGLContext()
+ *
+ *  This method is used for trying the EGL displays in order:
+ *  the first GPU device, the surfaceless platform, and the
+ *  default display.  For the software attempt Mesa is told
+ *  to use its software rasterizer, and only the surfaceless
+ *  platform is tried.
+ ***********************************************************/
+bool HeadlessContext::CreateEGLContext(bool bSoftware)
+{
+#ifdef __linux__
+	const char* clientExtensions = g_egl.QueryString(NULL, EGL_EXTENSIONS);
+	bool bPlatformDisplay = (NULL != g_egl.GetPlatformDisplayEXT);
+
+	if (bSoftware)
+	{
+		setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+	}
+	else if ((bPlatformDisplay) && (NULL != g_egl.QueryDevicesEXT) &&
+		(HasExtension(clientExtensions, "EGL_EXT_platform_device")))
+	{
+		EGLDeviceEXT device = NULL;
+		EGLint deviceCount = 0;
+		if ((g_egl.QueryDevicesEXT(1, &device, &deviceCount)) && (deviceCount > 0))
+		{
+			m_description = "EGL device";
+			if (CreateContextOnDisplay(g_egl.GetPlatformDisplayEXT(EGL_PLATFORM_DEVICE_EXT, device, NULL)))
+			{
+				return(true);
+			}
+		}
+	}
+
+	if ((bPlatformDisplay) && (HasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")))
+	{
+		m_description = (bSoftware) ? "EGL surfaceless software rasterizer" : "EGL surfaceless display";
+		if (CreateContextOnDisplay(g_egl.GetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, NULL, NULL)))
+		{
+			return(true);
+		}
+	}
+
+	if (bSoftware == false)
+	{
+		m_description = "EGL default display";
+		if (CreateContextOnDisplay(g_egl.GetDisplay(NULL)))
+		{
+			return(true);
+		}
+	}
+#endif
+	return(false);
+}
+
+/***********************************************************
+ *  CreateContextOnDisplay()
+ *
+ *  This method is used for initializing a display and
+ *  creating a core profile context on it.  A small pbuffer
+ *  is made current with the context where the display has
+ *  one, otherwise the context is made current without a
+ *  surface, as all rendering goes into framebuffer objects.
+ ***********************************************************/
+bool HeadlessContext::CreateContextOnDisplay(void* display)
+{
+#ifdef __linux__
+	if ((NULL == display) || (g_egl.Initialize(display, NULL, NULL) == 0))
+	{
+		return(false);
+	}
+
+	if (g_egl.BindAPI(EGL_OPENGL_API) == 0)
+	{
+		g_egl.Terminate(display);
+		return(false);
+	}
+
+	const EGLint pbufferConfigAttributes[] =
+	{
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_DEPTH_SIZE, 24,
+		EGL_NONE
+	};
+	const EGLint surfacelessConfigAttributes[] =
+	{
+		EGL_SURFACE_TYPE, 0,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+
+	EGLConfig config = NULL;
+	EGLint configCount = 0;
+	bool bPbuffer = (g_egl.ChooseConfig(display, pbufferConfigAttributes, &config, 1, &configCount) != 0) && (configCount > 0);
+	if ((bPbuffer == false) &&
+		((g_egl.ChooseConfig(display, surfacelessConfigAttributes, &config, 1, &configCount) == 0) || (configCount == 0)))
+	{
+		g_egl.Terminate(display);
+		return(false);
+	}
+
+	EGLContext context = NULL;
+	for (size_t i = 0; (NULL == context) && (i < sizeof(CONTEXT_VERSIONS) / sizeof(CONTEXT_VERSIONS[0])); i++)
+	{
+		const EGLint contextAttributes[] =
+		{
+			EGL_CONTEXT_MAJOR_VERSION, CONTEXT_VERSIONS[i][0],
+			EGL_CONTEXT_MINOR_VERSION, CONTEXT_VERSIONS[i][1],
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+		context = g_egl.CreateContext(display, config, NULL, contextAttributes);
+	}
+	if (NULL == context)
+	{
+		g_egl.Terminate(display);
+		return(false);
+	}
+
+	EGLSurface surface = NULL;
+	if (bPbuffer)
+	{
+		const EGLint pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		surface = g_egl.CreatePbufferSurface(display, config, pbufferAttributes);
+	}
+
+	if (g_egl.MakeCurrent(display, surface, surface, context) == 0)
+	{
+		g_egl.DestroyContext(display, context);
+		if (NULL != surface)
+		{
+			g_egl.DestroySurface(display, surface);
+		}
+		g_egl.Terminate(display);
+		return(false);
+	}
+
+	m_display = display;
+	m_surface = surface;
+	m_context = context;
+	return(true);
+#else
+	return(false);
+#endif
+}
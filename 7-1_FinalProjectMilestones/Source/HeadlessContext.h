@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+// headlesscontext.h
+// ============
+// create an OpenGL context without a window or a display server
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+
+/***********************************************************
+ *  HeadlessContext
+ *
+ *  This class contains the code for an OpenGL context that
+ *  needs no window, for rendering on servers without a
+ *  display.  The EGL library is loaded when the context is
+ *  created, so the application does not depend on it when
+ *  rendering into a window.  A GPU device is tried first,
+ *  then the surfaceless and default EGL displays, and last
+ *  the software rasterizer.  Only Linux is supported.
+ ***********************************************************/
+class HeadlessContext
+{
+public:
+	// constructor
+	HeadlessContext();
+	// destructor
+	~HeadlessContext();
+
+	// create the context and make it current on this thread
+	bool Create();
+	// release and free the context
+	void Destroy();
+	// description of the display the context was created on
+	std::string GetDescription() const { return(m_description); }
+
+private:
+	// the context cannot be shared between objects
+	HeadlessContext(const HeadlessContext&) = delete;
+	HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+	// handle of the loaded EGL library
+	void* m_pLibrary;
+	// EGL display, surface and context, kept untyped so that
+	// the EGL headers are only needed by the source file
+	void* m_display;
+	void* m_surface;
+	void* m_context;
+	std::string m_description;
+
+	// try to create a context on every display in turn
+	bool CreateEGLContext(bool bSoftware);
+	// try to create a context on one initialized display
+	bool CreateContextOnDisplay(void* display);
+};
@@ -0,0 +1,511 @@
+///////////////////////////////////////////////////////////////////////////////
+// imagewriter.cpp
+// ============
+// write rendered frames to PNG and PPM image files
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ImageWriter.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// the largest amount of data in one stored deflate block
+	const size_t MAX_STORED_BLOCK = 65535;
+
+	/***********************************************************
+	 *  MakeCrcTable()
+	 *
+	 *  Build the lookup table of the CRC-32 used by PNG.
+	 ***********************************************************/
+	std::array<uint32_t, 256> MakeCrcTable()
+	{
+		std::array<uint32_t, 256> table;
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t value = i;
+			for (int bit = 0; bit < 8; bit++)
+			{
+				value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+			}
+			table[i] = value;
+		}
+		return(table);
+	}
+
+	/***********************************************************
+	 *  Crc32()
+	 *
+	 *  Continue the CRC-32 of the PNG chunks over more bytes.
+	 *  The table is built once, safely across the threads of
+	 *  the worker pool.
+	 ***********************************************************/
+	uint32_t Crc32(uint32_t crc, const uint8_t* pData, size_t size)
+	{
+		static const std::array<uint32_t, 256> table = MakeCrcTable();
+
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+		{
+			crc = table[(crc ^ pData[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return(~crc);
+	}
+
+	/***********************************************************
+	 *  AppendBigEndian()
+	 *
+	 *  Add a 32 bit value with the most significant byte first.
+	 ***********************************************************/
+	void AppendBigEndian(std::vector<uint8_t>& data, uint32_t value)
+	{
+		data.push_back((uint8_t)(value >> 24));
+		data.push_back((uint8_t)(value >> 16));
+		data.push_back((uint8_t)(value >> 8));
+		data.push_back((uint8_t)value);
+	}
+
+	/***********************************************************
+	 *  AppendChunk()
+	 *
+	 *  Add one PNG chunk with its length and CRC.
+	 ***********************************************************/
+	void AppendChunk(std::vector<uint8_t>& encoded, const char* type, const std::vector<uint8_t>& data)
+	{
+		AppendBigEndian(encoded, (uint32_t)data.size());
+		size_t typeOffset = encoded.size();
+		encoded.insert(encoded.end(), type, type + 4);
+		encoded.insert(encoded.end(), data.begin(), data.end());
+		AppendBigEndian(encoded, Crc32(0, encoded.data() + typeOffset, data.size() + 4));
+	}
+
+	/***********************************************************
+	 *  IsValidImage()
+	 *
+	 *  Check that the pixel data matches the image size.
+	 ***********************************************************/
+	bool IsValidImage(int width, int height, const std::vector<uint8_t>& pixels)
+	{
+		return((width > 0) && (height > 0) && (pixels.size() == (size_t)width * (size_t)height * 3));
+	}
+}
+
+/***********************************************************
+ *  WriteImage()
+ *
+ *  This method is used for writing an image as a PPM file
+ *  when the filename ends in .ppm, and as a PNG otherwise.
+ ***********************************************************/
+bool ImageWriter::WriteImage(
+	const std::string& filename,
+	int width,
+	int height,
+	const std::vector<uint8_t>& pixels)
+{
+	size_t length = filename.size();
+	if ((length >= 4) && (filename.compare(length - 4, 4, ".ppm") == 0))
+	{
+		return(WritePPM(filename, width, height, pixels));
+	}
+
+	return(WritePNG(filename, width, height, pixels));
+}
+
+/***********************************************************
+ *  WritePPM()
+ *
+ *  This method is used for writing a binary PPM image, the
+ *  simplest format that image tools read.
+ ***********************************************************/
+bool ImageWriter::WritePPM(
+	const std::string& filename,
+	int width,
+	int height,
+	const std::vector<uint8_t>& pixels)
+{
+	std::vector<uint8_t> encoded;
+	return((EncodePPM(width, height, pixels, encoded)) && (WriteFile(filename, encoded)));
+}
+
+/***********************************************************
+ *  WritePNG()
+ *
+ *  This method is used for writing a PNG image.
+ ***********************************************************/
+bool ImageWriter::WritePNG(
+	const std::string& filename,
+	int width,
+	int height,
+	const std::vector<uint8_t>& pixels)
+{
+	std::vector<uint8_t> encoded;
+	return((EncodePNG(width, height, pixels, encoded)) && (WriteFile(filename, encoded)));
+}
+
+/***********************************************************
+ *  EncodePPM()
+ *
+ *  This method is used for encoding a binary PPM image into
+ *  the passed in byte buffer.
+ ***********************************************************/
+bool ImageWriter::EncodePPM(
+	int width,
+	int height,
+	const std::vector<uint8_t>& pixels,
+	std::vector<uint8_t>& encoded)
+{
+	if (IsValidImage(width, height, pixels) == false)
+	{
+		return(false);
+	}
+
+	char header[64];
+	int headerSize = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", width, height);
+	encoded.clear();
+	encoded.reserve(headerSize + pixels.size());
+	encoded.insert(encoded.end(), header, header + headerSize);
+	encoded.insert(encoded.end(), pixels.begin(), pixels.end());
+
+	return(true);
+}
+
+/***********************************************************
+ *  EncodePNG()
+ *
+ *  This method is used for encoding a PNG image into the
+ *  passed in byte buffer.  The rows use no filter and are
+ *  stored in uncompressed deflate blocks inside one zlib
+ *  stream.
+ ***********************************************************/
+bool ImageWriter::EncodePNG(
+	int width,
+	int height,
+	const std::vector<uint8_t>& pixels,
+	std::vector<uint8_t>& encoded)
+{
+	if (IsValidImage(width, height, pixels) == false)
+	{
+		return(false);
+	}
+
+	// each row is preceded by its filter type, which is none
+	size_t rowSize = (size_t)width * 3;
+	std::vector<uint8_t> rows;
+	rows.reserve((rowSize + 1) * height);
+	for (int y = 0; y < height; y++)
+	{
+		rows.push_back(0);
+		rows.insert(rows.end(), pixels.begin() + y * rowSize, pixels.begin() + (y + 1) * rowSize);
+	}
+
+	// the zlib stream holds the rows in stored blocks, followed
+	// by the Adler-32 checksum of the rows
+	std::vector<uint8_t> stream;
+	stream.reserve(rows.size() + (rows.size() / MAX_STORED_BLOCK + 1) * 5 + 6);
+	stream.push_back(0x78);
+	stream.push_back(0x01);
+
+	uint32_t adlerA = 1;
+	uint32_t adlerB = 0;
+	size_t offset = 0;
+	do
+	{
+		size_t blockSize = std::min(MAX_STORED_BLOCK, rows.size() - offset);
+		bool bLastBlock = (offset + blockSize == rows.size());
+
+		stream.push_back((bLastBlock) ? 1 : 0);
+		stream.push_back((uint8_t)blockSize);
+		stream.push_back((uint8_t)(blockSize >> 8));
+		stream.push_back((uint8_t)~blockSize);
+		stream.push_back((uint8_t)(~blockSize >> 8));
+		stream.insert(stream.end(), rows.begin() + offset, rows.begin() + offset + blockSize);
+
+		for (size_t i = offset; i < offset + blockSize; i++)
+		{
+			adlerA = (adlerA + rows[i]) % 65521;
+			adlerB = (adlerB + adlerA) % 65521;
+		}
+		offset += blockSize;
+	} while (offset < rows.size());
+	AppendBigEndian(stream, (adlerB << 16) | adlerA);
+
+	std::vector<uint8_t> header;
+	AppendBigEndian(header, (uint32_t)width);
+	AppendBigEndian(header, (uint32_t)height);
+	header.push_back(8);	// bits per channel
+	header.push_back(2);	// RGB color
+	header.push_back(0);	// deflate compression
+	header.push_back(0);	// adaptive filtering
+	header.push_back(0);	// no interlacing
+
+	const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	encoded.clear();
+	encoded.reserve(sizeof(signature) + header.size() + stream.size() + 36);
+	encoded.insert(encoded.end(), signature, signature + sizeof(signature));
+	AppendChunk(encoded, "IHDR", header);
+	AppendChunk(encoded, "IDAT", stream);
+	AppendChunk(encoded, "IEND", std::vector<uint8_t>());
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteFile()
+ *
+ *  This method is used for writing encoded image bytes to
+ *  a file.
+ ***********************************************************/
+bool ImageWriter::WriteFile(const std::string& filename, const std::vector<uint8_t>& data)
+{
+	FILE* pFile = fopen(filename.c_str(), "wb");
+	if (NULL == pFile)
+	{
+		std::cout << "Could not write image: " << filename << std::endl;
+		return(false);
+	}
+
+	bool bWritten = (fwrite(data.data(), 1, data.size(), pFile) == data.size());
+	bWritten = (fclose(pFile) == 0) && (bWritten);
+
+	return(bWritten);
+}
+
+/***********************************************************
+ *  ImageFileStream()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ImageFileStream::ImageFileStream()
+{
+	m_pFile = NULL;
+	m_bPNG = true;
+	m_width = 0;
+	m_height = 0;
+	m_rowsWritten = 0;
+	m_bFailed = false;
+	m_adlerA = 1;
+	m_adlerB = 0;
+}
+
+/***********************************************************
+ *  ~ImageFileStream()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ImageFileStream::~ImageFileStream()
+{
+	if (NULL != m_pFile)
+	{
+		fclose(m_pFile);
+		m_pFile = NULL;
+	}
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for creating the image file and
+ *  writing everything that comes before the pixels.
+ ***********************************************************/
+bool ImageFileStream::Open(const std::string& filename, int width, int height)
+{
+	if ((width <= 0) || (height <= 0) || (NULL != m_pFile))
+	{
+		return(false);
+	}
+
+	m_pFile = fopen(filename.c_str(), "wb");
+	if (NULL == m_pFile)
+	{
+		std::cout << "Could not write image: " << filename << std::endl;
+		return(false);
+	}
+
+	size_t length = filename.size();
+	m_bPNG = !((length >= 4) && (filename.compare(length - 4, 4, ".ppm") == 0));
+	m_width = width;
+	m_height = height;
+	m_rowsWritten = 0;
+	m_bFailed = false;
+	m_adlerA = 1;
+	m_adlerB = 0;
+
+	std::vector<uint8_t> header;
+	if (m_bPNG)
+	{
+		const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		header.insert(header.end(), signature, signature + sizeof(signature));
+
+		std::vector<uint8_t> imageHeader;
+		AppendBigEndian(imageHeader, (uint32_t)width);
+		AppendBigEndian(imageHeader, (uint32_t)height);
+		imageHeader.push_back(8);	// bits per channel
+		imageHeader.push_back(2);	// RGB color
+		imageHeader.push_back(0);	// deflate compression
+		imageHeader.push_back(0);	// adaptive filtering
+		imageHeader.push_back(0);	// no interlacing
+		AppendChunk(header, "IHDR", imageHeader);
+
+		// the zlib header starts the data of the first chunk
+		m_chunk.clear();
+		m_chunk.push_back(0x78);
+		m_chunk.push_back(0x01);
+	}
+	else
+	{
+		char text[64];
+		int textSize = snprintf(text, sizeof(text), "P6\n%d %d\n255\n", width, height);
+		header.insert(header.end(), text, text + textSize);
+	}
+
+	m_bFailed = (fwrite(header.data(), 1, header.size(), m_pFile) != header.size());
+	return(m_bFailed == false);
+}
+
+/***********************************************************
+ *  WriteRows()
+ *
+ *  This method is used for writing the next rows of the
+ *  image.  For PNG each row is stored with its filter type,
+ *  and the chunk is written whenever it grows large, so only
+ *  the passed in rows are ever held in memory.
+ ***********************************************************/
+bool ImageFileStream::WriteRows(const uint8_t* pPixels, int rowCount)
+{
+	if ((NULL == m_pFile) || (m_bFailed) || (rowCount < 0) || (m_rowsWritten + rowCount > m_height))
+	{
+		return(false);
+	}
+
+	size_t rowSize = (size_t)m_width * 3;
+	if (m_bPNG == false)
+	{
+		size_t size = rowSize * rowCount;
+		m_bFailed = (fwrite(pPixels, 1, size, m_pFile) != size);
+	}
+	else
+	{
+		// the filter byte is given its own row buffer so each
+		// row can be added as one piece
+		std::vector<uint8_t> row(rowSize + 1, 0);
+		for (int y = 0; y < rowCount; y++)
+		{
+			memcpy(&row[1], pPixels + y * rowSize, rowSize);
+			AppendStoredBlocks(row.data(), row.size());
+		}
+	}
+
+	m_rowsWritten += rowCount;
+	return(m_bFailed == false);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for ending the compressed stream and
+ *  the file.  False is returned if any write failed or not
+ *  every row was written.
+ ***********************************************************/
+bool ImageFileStream::Close()
+{
+	if (NULL == m_pFile)
+	{
+		return(false);
+	}
+
+	bool bComplete = (m_rowsWritten == m_height);
+	if (m_bPNG)
+	{
+		// an empty final block ends the deflate stream
+		const uint8_t lastBlock[5] = { 1, 0, 0, 0xFF, 0xFF };
+		m_chunk.insert(m_chunk.end(), lastBlock, lastBlock + sizeof(lastBlock));
+		AppendBigEndian(m_chunk, (m_adlerB << 16) | m_adlerA);
+		FlushChunk();
+
+		std::vector<uint8_t> end;
+		AppendChunk(end, "IEND", std::vector<uint8_t>());
+		if (fwrite(end.data(), 1, end.size(), m_pFile) != end.size())
+		{
+			m_bFailed = true;
+		}
+	}
+
+	if (fclose(m_pFile) != 0)
+	{
+		m_bFailed = true;
+	}
+	m_pFile = NULL;
+	m_chunk.clear();
+
+	return((bComplete) && (m_bFailed == false));
+}
+
+/***********************************************************
+ *  AppendStoredBlocks()
+ *
+ *  This method is used for adding row data to the current
+ *  chunk as stored deflate blocks that are not the last
+ *  block, and updating the Adler-32 checksum.
+ ***********************************************************/
+void ImageFileStream::AppendStoredBlocks(const uint8_t* pData, size_t size)
+{
+	// a chunk is written once it holds a few megabytes
+	const size_t MAX_CHUNK_SIZE = 4 * 1024 * 1024;
+
+	size_t offset = 0;
+	while (offset < size)
+	{
+		size_t blockSize = std::min(MAX_STORED_BLOCK, size - offset);
+		m_chunk.push_back(0);
+		m_chunk.push_back((uint8_t)blockSize);
+		m_chunk.push_back((uint8_t)(blockSize >> 8));
+		m_chunk.push_back((uint8_t)~blockSize);
+		m_chunk.push_back((uint8_t)(~blockSize >> 8));
+		m_chunk.insert(m_chunk.end(), pData + offset, pData + offset + blockSize);
+
+		for (size_t i = offset; i < offset + blockSize; i++)
+		{
+			m_adlerA = (m_adlerA + pData[i]) % 65521;
+			m_adlerB = (m_adlerB + m_adlerA) % 65521;
+		}
+		offset += blockSize;
+
+		if (m_chunk.size() >= MAX_CHUNK_SIZE)
+		{
+			FlushChunk();
+		}
+	}
+}
+
+/***********************************************************
+ *  FlushChunk()
+ *
+ *  This method is used for writing the collected data as
+ *  an IDAT chunk.  A PNG can hold the compressed stream
+ *  split across any number of these chunks.
+ ***********************************************************/
+void ImageFileStream::FlushChunk()
+{
+	if ((m_chunk.empty()) || (m_bFailed))
+	{
+		return;
+	}
+
+	// the data is written in place, between its length and
+	// type and its CRC
+	std::vector<uint8_t> header;
+	AppendBigEndian(header, (uint32_t)m_chunk.size());
+	header.insert(header.end(), { 'I', 'D', 'A', 'T' });
+	std::vector<uint8_t> footer;
+	AppendBigEndian(footer, Crc32(Crc32(0, header.data() + 4, 4), m_chunk.data(), m_chunk.size()));
+
+	m_bFailed = (fwrite(header.data(), 1, header.size(), m_pFile) != header.size()) ||
+		(fwrite(m_chunk.data(), 1, m_chunk.size(), m_pFile) != m_chunk.size()) ||
+		(fwrite(footer.data(), 1, footer.size(), m_pFile) != footer.size());
+	m_chunk.clear();
+}
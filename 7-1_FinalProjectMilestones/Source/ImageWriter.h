@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+// imagewriter.h
+// ============
+// write rendered frames to PNG and PPM image files
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  ImageWriter
+ *
+ *  This class contains the code for saving 8 bit RGB images,
+ *  with the rows stored from the top down.  PNG files use
+ *  uncompressed deflate blocks, which keeps the writer free
+ *  of a compression library and fast enough to keep up with
+ *  the renderer, at the cost of larger files.
+ ***********************************************************/
+class ImageWriter
+{
+public:
+	// write an image in the format given by the file extension
+	static bool WriteImage(
+		const std::string& filename,
+		int width,
+		int height,
+		const std::vector<uint8_t>& pixels);
+	// write a binary PPM image
+	static bool WritePPM(
+		const std::string& filename,
+		int width,
+		int height,
+		const std::vector<uint8_t>& pixels);
+	// write a PNG image
+	static bool WritePNG(
+		const std::string& filename,
+		int width,
+		int height,
+		const std::vector<uint8_t>& pixels);
+
+	// encode an image into memory in the PPM or PNG format
+	static bool EncodePPM(
+		int width,
+		int height,
+		const std::vector<uint8_t>& pixels,
+		std::vector<uint8_t>& encoded);
+	static bool EncodePNG(
+		int width,
+		int height,
+		const std::vector<uint8_t>& pixels,
+		std::vector<uint8_t>& encoded);
+
+private:
+	// write encoded bytes to a file
+	static bool WriteFile(const std::string& filename, const std::vector<uint8_t>& data);
+};
+
+/***********************************************************
+ *  ImageFileStream
+ *
+ *  This class contains the code for writing an image file
+ *  a band of rows at a time, from the top down, so images
+ *  far larger than memory can be saved.  The format is PPM
+ *  when the filename ends in .ppm, and PNG otherwise.
+ ***********************************************************/
+class ImageFileStream
+{
+public:
+	// constructor
+	ImageFileStream();
+	// destructor - closes an unfinished file
+	~ImageFileStream();
+
+	// create the file and write the header
+	bool Open(const std::string& filename, int width, int height);
+	// write the next rows of 8 bit RGB pixels
+	bool WriteRows(const uint8_t* pPixels, int rowCount);
+	// finish the file after all of the rows are written
+	bool Close();
+
+private:
+	// the file cannot be shared between objects
+	ImageFileStream(const ImageFileStream&) = delete;
+	ImageFileStream& operator=(const ImageFileStream&) = delete;
+
+	FILE* m_pFile;
+	bool m_bPNG;
+	int m_width;
+	int m_height;
+	int m_rowsWritten;
+	bool m_bFailed;
+	// running Adler-32 sums of the compressed stream
+	uint32_t m_adlerA;
+	uint32_t m_adlerB;
+	// data of the PNG chunk being written
+	std::vector<uint8_t> m_chunk;
+
+	// add deflate blocks of row data to the chunk
+	void AppendStoredBlocks(const uint8_t* pData, size_t size);
+	// write the chunk as an IDAT chunk
+	void FlushChunk();
+};
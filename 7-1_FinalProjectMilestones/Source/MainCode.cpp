@@ -9,6 +9,17 @@
 
 #include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -20,8 +31,22 @@
 
 #include "SceneManager.h"
 #include "ViewManager.h"
-#include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "UniformManager.h"
+#include "ProgramCache.h"
+#include "RenderOptions.h"
+#include "ResolutionManager.h"
+#include "QualityManager.h"
+#include "FrameScheduler.h"
+#include "FrameSync.h"
+#include "FrameLimiter.h"
+#include "HeadlessContext.h"
+#include "RenderTarget.h"
+#include "BatchRenderer.h"
+#include "FrameCapture.h"
+#include "SharedFrameOutput.h"
+#include "RenderServer.h"
+#include "GLStateCache.h"
 
 // Namespace for declaring global variables
 namespace
@@ -29,6 +54,13 @@ namespace
 	// Macro for window title
 	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
 
+	// number of fixed length camera and scene updates per second
+	const double UPDATE_RATE_HZ = 120.0;
+
+	// how often the on-demand render loop checks whether the
+	// scene shaders have finished compiling
+	const double PROGRAM_POLL_SECONDS = 0.05;
+
 	// Main GLFW window
 	GLFWwindow* g_Window = nullptr;
 
@@ -36,14 +68,72 @@ namespace
 	SceneManager* g_SceneManager = nullptr;
 	// shader manager object for dynamic interaction with the shader code
 	ShaderManager* g_ShaderManager = nullptr;
+	// uniform manager object for setting the shader uniforms by location
+	UniformManager* g_UniformManager = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+	// resolution manager object for scaling the render resolution
+	// to hold the frame time budget, when one is configured
+	ResolutionManager* g_ResolutionManager = nullptr;
+	// quality manager object for the lighting and detail settings
+	QualityManager* g_QualityManager = nullptr;
+	// frame scheduler object for the fixed timestep updates
+	FrameScheduler* g_FrameScheduler = nullptr;
+	// frame sync object for the per-frame uniform buffer regions
+	FrameSync* g_FrameSync = nullptr;
+	// frame limiter object for pacing the frames to a target rate
+	FrameLimiter* g_FrameLimiter = nullptr;
+	// frame capture object for saving the rendered frames
+	FrameCapture* g_FrameCapture = nullptr;
+	// shared frame output object for local consumer processes
+	SharedFrameOutput* g_SharedFrameOutput = nullptr;
+	// refresh rate of the display, which paces the low-latency
+	// mode when no frame rate is given
+	int g_DisplayRefreshRate = 0;
+
+	// startup options read from the command line
+	RENDER_OPTIONS g_RenderOptions;
+
+	// folder for the linked shader program binaries
+	const char* g_ProgramCacheDirectory = "cache/shaders";
+	// the scene shaders, and the stand-in shaders that compile
+	// quickly and are drawn with until the scene shaders are done
+	const char* g_SceneVertexShader = "shaders/vertexShader.glsl";
+	const char* g_SceneFragmentShader = "shaders/fragmentShader.glsl";
+	const char* g_FallbackVertexShader = "shaders/fallbackVertexShader.glsl";
+	const char* g_FallbackFragmentShader = "shaders/fallbackFragmentShader.glsl";
+
+	// program cache object for building the shader programs
+	ProgramCache* g_ProgramCache = nullptr;
+	// build of the scene program while it is being compiled,
+	// or -1 once it is in use
+	int g_SceneProgramBuild = -1;
+	// stand-in program in use until then
+	GLuint g_FallbackProgram = 0;
+
+	// state of the render thread, when one is used
+	std::atomic<bool> g_bRenderThreadRunning(false);
+	std::atomic<bool> g_bRenderingPrepared(false);
 }
 
 // Function declarations - all functions that are called manually
 // need to be pre-declared at the beginning of the source code.
 bool InitializeGLFW();
 bool InitializeGLEW();
+bool PrepareRendering();
+bool ActivateSceneProgram(bool bWait);
+void SelectQualityTier();
+void DrawFrame(double interpolation);
+void RenderLoop();
+void DestroyRendering();
+void RenderThreadMain();
+int RunHeadless();
+bool RenderHeadlessFrames();
+bool IsJobMode();
+bool RenderOffscreen(const std::function<bool()>& renderJobs);
+int RunBatch();
+bool RenderBatchViews(const std::vector<BATCH_VIEW>& views, size_t firstView, size_t viewStep);
+int RunServer();
 
 
 /***********************************************************
@@ -54,6 +144,33 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	// if the command line cannot be parsed, then show the
+	// supported options and terminate the application
+	if ((ParseRenderOptions(argc, argv, g_RenderOptions) == false) ||
+		((g_RenderOptions.quality != "auto") && (QualityManager::IsTierName(g_RenderOptions.quality) == false)))
+	{
+		PrintRenderOptionsUsage(argv[0]);
+		return(EXIT_FAILURE);
+	}
+
+	// render a list of camera views to image files
+	if (g_RenderOptions.batchFilename.empty() == false)
+	{
+		return(RunBatch());
+	}
+
+	// keep the scene loaded and render the jobs sent by clients
+	if (g_RenderOptions.serverSocketPath.empty() == false)
+	{
+		return(RunServer());
+	}
+
+	// render without a window, for servers with no display
+	if (g_RenderOptions.bHeadless)
+	{
+		return(RunHeadless());
+	}
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
@@ -69,53 +186,624 @@ int main(int argc, char* argv[])
 	// try to create the main display window
 	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
 
+	// the monitor can only be queried from the main thread
+	GLFWmonitor* pMonitor = glfwGetPrimaryMonitor();
+	if (NULL != pMonitor)
+	{
+		const GLFWvidmode* pVideoMode = glfwGetVideoMode(pMonitor);
+		if (NULL != pVideoMode)
+		{
+			g_DisplayRefreshRate = pVideoMode->refreshRate;
+		}
+	}
+
+	bool bRenderingPrepared = false;
+	if (g_RenderOptions.bRenderThread)
+	{
+		// the OpenGL context is handed over to the render thread,
+		// and this thread only processes the window events, so
+		// input stays responsive however long a frame takes
+		g_ViewManager->SetRenderThread(true);
+		glfwMakeContextCurrent(NULL);
+
+		g_bRenderThreadRunning = true;
+		std::thread renderThread(RenderThreadMain);
+
+		while ((glfwWindowShouldClose(g_Window) == 0) && (g_bRenderThreadRunning))
+		{
+			glfwWaitEvents();
+			ViewManager::FlushInputEvents();
+		}
+
+		ViewManager::RequestClose();
+		renderThread.join();
+		bRenderingPrepared = g_bRenderingPrepared;
+
+		// the context is taken back for freeing the shaders
+		glfwMakeContextCurrent(g_Window);
+	}
+	else
+	{
+		bRenderingPrepared = PrepareRendering();
+		if (bRenderingPrepared)
+		{
+			RenderLoop();
+		}
+		DestroyRendering();
+	}
+
+	// clear the allocated manager objects from memory
+	if (NULL != g_ViewManager)
+	{
+		delete g_ViewManager;
+		g_ViewManager = NULL;
+	}
+	if (NULL != g_ShaderManager)
+	{
+		delete g_ShaderManager;
+		g_ShaderManager = NULL;
+	}
+
+	if (bRenderingPrepared == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// Terminates the program successfully
+	exit(EXIT_SUCCESS); 
+}
+
+/***********************************************************
+ *  PrepareRendering()
+ *
+ *  This function is used for loading the shaders and the 3D
+ *  scene, and creating the objects used by the render loop,
+ *  on the thread that renders.
+ ***********************************************************/
+bool PrepareRendering()
+{
 	// if GLEW fails initialization, then terminate the application
 	if (InitializeGLEW() == false)
 	{
-		return(EXIT_FAILURE);
+		return(false);
+	}
+
+	// submit the scene shaders, which load from the binary saved
+	// by an earlier run or compile from the external GLSL files
+	// when the files or the driver have changed since.  While
+	// the driver compiles them, the scene is loaded and drawn
+	// with the stand-in shaders.
+	g_ProgramCache = new ProgramCache(g_ProgramCacheDirectory);
+	g_SceneProgramBuild = g_ProgramCache->BeginProgram(g_SceneVertexShader, g_SceneFragmentShader);
+	if (g_SceneProgramBuild == -1)
+	{
+		return(false);
 	}
 
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"shaders/vertexShader.glsl",
-		"shaders/fragmentShader.glsl");
+	GLuint program = 0;
+	if (g_ProgramCache->IsLoadedFromCache(g_SceneProgramBuild) == false)
+	{
+		g_FallbackProgram = g_ProgramCache->LoadProgram(g_FallbackVertexShader, g_FallbackFragmentShader);
+		program = g_FallbackProgram;
+	}
+	if (program == 0)
+	{
+		program = g_ProgramCache->FinishProgram(g_SceneProgramBuild);
+		g_SceneProgramBuild = -1;
+		if (program == 0)
+		{
+			return(false);
+		}
+	}
+	g_ShaderManager->m_programID = program;
 	g_ShaderManager->use();
 
+	// the state calls are checked against the state of the new
+	// context, so calls that would not change it are dropped
+	GLStateCache::SetEnabled(g_RenderOptions.bStateCache);
+	GLStateCache::Reset();
+
+	// the uniforms of the program are looked up once, so they
+	// can be set by location while rendering, and writes of
+	// the value a uniform already has are skipped
+	g_UniformManager = new UniformManager();
+	g_UniformManager->SetCacheEnabled(g_RenderOptions.bStateCache);
+	g_UniformManager->SetReportUnused(g_SceneProgramBuild == -1);
+
+	// the camera of each frame goes into its own region of a
+	// uniform buffer, so the CPU can write the next frame while
+	// the GPU still draws the previous one
+	g_FrameSync = new FrameSync();
+	g_ViewManager->SetFrameSync(g_FrameSync);
+
 	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
+	g_SceneManager = new SceneManager(g_UniformManager);
+	g_SceneManager->SetPackedVertices(g_RenderOptions.bPackedVertices);
+	g_SceneManager->SetModelFile(g_RenderOptions.modelFilename);
 	g_SceneManager->PrepareScene();
 
+	// the quality tier is applied once the scene shaders are in
+	// use.  Only the window shows the stand-in shaders, since
+	// the other outputs save or publish every frame.
+	g_QualityManager = new QualityManager(g_UniformManager, g_SceneManager);
+	bool bShowFallback = (g_RenderOptions.bHeadless == false) && (IsJobMode() == false) &&
+		(g_RenderOptions.bCapture == false) && (g_RenderOptions.sharedOutputName.empty());
+	if (g_SceneProgramBuild == -1)
+	{
+		SelectQualityTier();
+	}
+	else if ((bShowFallback == false) || (g_ProgramCache->IsProgramReady(g_SceneProgramBuild)))
+	{
+		if (ActivateSceneProgram(true) == false)
+		{
+			return(false);
+		}
+	}
+
+	// render into a scaled offscreen target when a frame time
+	// budget has been given on the command line
+	if ((g_RenderOptions.frameBudgetMs > 0.0f) && (g_RenderOptions.bHeadless == false) &&
+		(IsJobMode() == false))
+	{
+		g_ResolutionManager = new ResolutionManager(g_RenderOptions.frameBudgetMs);
+	}
+
+	g_FrameScheduler = new FrameScheduler(UPDATE_RATE_HZ);
+
+	// batches and server jobs save their images themselves, so
+	// only the frames of the render loop are captured here
+	if ((g_RenderOptions.bCapture) && (IsJobMode() == false))
+	{
+		g_FrameCapture = new FrameCapture(g_RenderOptions.imageOutputDirectory, g_RenderOptions.imageFormat);
+	}
+	if ((g_RenderOptions.sharedOutputName.empty() == false) && (IsJobMode() == false))
+	{
+		int framebufferWidth = 0;
+		int framebufferHeight = 0;
+		g_ViewManager->GetFramebufferSize(framebufferWidth, framebufferHeight);
+
+		g_SharedFrameOutput = new SharedFrameOutput();
+		if (g_SharedFrameOutput->Create(g_RenderOptions.sharedOutputName, framebufferWidth, framebufferHeight) == false)
+		{
+			delete g_SharedFrameOutput;
+			g_SharedFrameOutput = NULL;
+		}
+	}
+
+	// a headless context, a batch or the server has no window
+	// frames to swap or pace
+	if ((g_RenderOptions.bHeadless) || (IsJobMode()))
+	{
+		return(true);
+	}
+
+	// the swap interval applies to the context of this thread,
+	// and adaptive sync falls back to vsync where the tearing
+	// extension is missing
+	if (g_RenderOptions.vsync == "off")
+	{
+		glfwSwapInterval(0);
+	}
+	else if (g_RenderOptions.vsync == "on")
+	{
+		glfwSwapInterval(1);
+	}
+	else if (g_RenderOptions.vsync == "adaptive")
+	{
+		if ((glfwExtensionSupported("WGL_EXT_swap_control_tear")) ||
+			(glfwExtensionSupported("GLX_EXT_swap_control_tear")))
+		{
+			glfwSwapInterval(-1);
+		}
+		else
+		{
+			std::cout << "Adaptive vsync is not supported, using vsync" << std::endl;
+			glfwSwapInterval(1);
+		}
+	}
+
+	// pace the frames when a rate is given, and in low-latency
+	// mode use the display rate when it is not
+	double frameRate = g_RenderOptions.maxFrameRate;
+	if ((frameRate <= 0.0) && (g_RenderOptions.bLowLatency))
+	{
+		frameRate = g_DisplayRefreshRate;
+	}
+	if ((frameRate > 0.0) || (g_RenderOptions.bLowLatency))
+	{
+		g_FrameLimiter = new FrameLimiter(frameRate, g_RenderOptions.bLowLatency);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  ActivateSceneProgram()
+ *
+ *  This function is used for moving from the stand-in shaders
+ *  to the scene shaders once the driver has compiled them,
+ *  or right away when the passed in wait flag is set.  The
+ *  uniform values set so far carry over to the scene shaders,
+ *  and then the quality tier is applied.  False is returned
+ *  when the scene shaders could not be built, and the
+ *  stand-in shaders are kept.
+ ***********************************************************/
+bool ActivateSceneProgram(bool bWait)
+{
+	if (g_SceneProgramBuild == -1)
+	{
+		return(true);
+	}
+	if ((bWait == false) && (g_ProgramCache->IsProgramReady(g_SceneProgramBuild) == false))
+	{
+		return(true);
+	}
+
+	GLuint program = g_ProgramCache->FinishProgram(g_SceneProgramBuild);
+	g_SceneProgramBuild = -1;
+	if (program == 0)
+	{
+		std::cout << "The scene shaders could not be built, drawing with the stand-in shaders" << std::endl;
+		return(false);
+	}
+
+	g_ShaderManager->m_programID = program;
+	GLStateCache::UseProgram(program);
+	g_UniformManager->SetReportUnused(true);
+	g_UniformManager->SetProgram(program);
+
+	glDeleteProgram(g_FallbackProgram);
+	g_FallbackProgram = 0;
+
+	SelectQualityTier();
+	return(true);
+}
+
+/***********************************************************
+ *  SelectQualityTier()
+ *
+ *  This function is used for applying the requested quality
+ *  tier, or picking the highest tier that this machine can
+ *  render at the window size.
+ ***********************************************************/
+void SelectQualityTier()
+{
+	if (g_RenderOptions.quality == "auto")
+	{
+		int framebufferWidth = 0;
+		int framebufferHeight = 0;
+		g_ViewManager->GetFramebufferSize(framebufferWidth, framebufferHeight);
+
+		// the camera goes into a uniform buffer region of its own,
+		// since earlier frames may still be drawing
+		g_FrameSync->BeginFrame();
+		g_ViewManager->PrepareSceneView();
+		g_SceneManager->SetViewProjection(
+			g_ViewManager->GetViewMatrix(),
+			g_ViewManager->GetProjectionMatrix(),
+			g_ViewManager->GetCameraPosition(),
+			g_ViewManager->IsPerspective());
+		g_QualityManager->SelectTierByBenchmark(framebufferWidth, framebufferHeight);
+		g_FrameSync->EndFrame();
+	}
+	else
+	{
+		g_QualityManager->SetTier(g_RenderOptions.quality);
+	}
+}
+
+/***********************************************************
+ *  DrawFrame()
+ *
+ *  This function is used for drawing one frame of the 3D
+ *  scene into the bound framebuffer, with the camera the
+ *  passed in fraction of the way between the last two
+ *  updated states.
+ ***********************************************************/
+void DrawFrame(double interpolation)
+{
+	// Enable z-depth
+	GLStateCache::Enable(GL_DEPTH_TEST);
+
+	// Clear the frame and z buffers
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	// convert from 3D object space to 2D view, once the GPU is
+	// done with the uniform buffer region of this frame
+	g_FrameSync->BeginFrame();
+	g_ViewManager->PrepareSceneView(interpolation);
+	g_SceneManager->SetViewProjection(
+		g_ViewManager->GetViewMatrix(),
+		g_ViewManager->GetProjectionMatrix(),
+		g_ViewManager->GetCameraPosition(),
+		g_ViewManager->IsPerspective());
+
+	// refresh the 3D scene
+	g_SceneManager->RenderScene();
+
+	// the fence after the last draw call frees the region
+	g_FrameSync->EndFrame();
+	GLStateCache::EndFrame();
+	g_UniformManager->EndFrame();
+}
+
+/***********************************************************
+ *  RenderLoop()
+ *
+ *  This function is used for rendering frames until the
+ *  window is closed.
+ ***********************************************************/
+void RenderLoop()
+{
 	// loop will keep running until the application is closed 
 	// or until an error has occurred
-	while (!glfwWindowShouldClose(g_Window))
+	while (g_ViewManager->IsClosing() == false)
 	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
+		// wait for the slot of the next frame, before the input
+		// is sampled so that it is as fresh as possible
+		if (NULL != g_FrameLimiter)
+		{
+			g_FrameLimiter->WaitForFrameStart();
+		}
 
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		// publish the frames whose copies finished meanwhile
+		if (NULL != g_SharedFrameOutput)
+		{
+			g_SharedFrameOutput->Update();
+		}
 
-		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
+		// take the latest input and window events
+		g_ViewManager->ProcessInputEvents();
+
+		// in on-demand mode an unchanged frame is not drawn again,
+		// and the loop sleeps until the next input or window event.
+		// While the scene shaders compile, it wakes up now and then
+		// so the frame that moves to them is drawn without input.
+		bool bSceneProgramReady = (g_SceneProgramBuild != -1) &&
+			(g_ProgramCache->IsProgramReady(g_SceneProgramBuild));
+		if ((g_RenderOptions.bOnDemand) && (g_ViewManager->NeedsRedraw() == false) &&
+			(bSceneProgramReady == false))
+		{
+			g_ViewManager->WaitForEvents((g_SceneProgramBuild != -1) ? PROGRAM_POLL_SECONDS : 0.0);
+			g_FrameScheduler->Reset();
+			continue;
+		}
+
+		// nothing can be drawn while the window is minimized
+		int framebufferWidth = 0;
+		int framebufferHeight = 0;
+		g_ViewManager->GetFramebufferSize(framebufferWidth, framebufferHeight);
+		if ((framebufferWidth <= 0) || (framebufferHeight <= 0))
+		{
+			g_ViewManager->WaitForEvents();
+			g_FrameScheduler->Reset();
+			continue;
+		}
+
+		// move to the scene shaders once the driver has compiled
+		// them, drawing with the stand-in shaders until then
+		if (g_SceneProgramBuild != -1)
+		{
+			ActivateSceneProgram(false);
+		}
+
+		// run the fixed length updates that the elapsed time
+		// covers, independent of the frame rate
+		int updateSteps = g_FrameScheduler->BeginFrame();
+		for (int i = 0; i < updateSteps; i++)
+		{
+			g_ViewManager->UpdateView(g_FrameScheduler->GetStepSeconds());
+		}
+
+		// draw into the offscreen target at the scaled resolution,
+		// or directly into the window at its full size
+		if (NULL != g_ResolutionManager)
+		{
+			g_ResolutionManager->BeginFrame(framebufferWidth, framebufferHeight);
+		}
+		else
+		{
+			glViewport(0, 0, framebufferWidth, framebufferHeight);
+		}
 
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
+		// the camera is placed between the last two updated states
+		DrawFrame(g_FrameScheduler->GetInterpolation());
 
+		// upscale the offscreen frame into the window
+		if (NULL != g_ResolutionManager)
+		{
+			g_ResolutionManager->EndFrame();
+		}
+
+		// the finished frame is copied from the back buffer,
+		// at the window size
+		if (NULL != g_FrameCapture)
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			g_FrameCapture->CaptureNextFrame(framebufferWidth, framebufferHeight);
+		}
+		if (NULL != g_SharedFrameOutput)
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			g_SharedFrameOutput->PublishFrame(framebufferWidth, framebufferHeight);
+		}
 
 		// Flips the the back buffer with the front buffer every frame.
 		glfwSwapBuffers(g_Window);
 
-		// query the latest GLFW events
-		glfwPollEvents();
+		// the swap often waits long enough for the GPU to finish
+		// the copy, so the frame is published without waiting
+		// for the next loop
+		if (NULL != g_SharedFrameOutput)
+		{
+			g_SharedFrameOutput->Update();
+		}
+
+		// in low-latency mode the GPU finishes the frame before
+		// the next one starts, so no frames queue up in the driver
+		// between the input and the display
+		if (NULL != g_FrameLimiter)
+		{
+			if (g_FrameLimiter->IsLowLatency())
+			{
+				glFinish();
+			}
+			g_FrameLimiter->EndFrame();
+		}
+	}
+}
+
+/***********************************************************
+ *  DestroyRendering()
+ *
+ *  This function is used for freeing the objects created by
+ *  PrepareRendering(), while the OpenGL context is current.
+ ***********************************************************/
+void DestroyRendering()
+{
+	// the captured frames that are still in flight are saved
+	// before the context goes away
+	if (NULL != g_FrameCapture)
+	{
+		if (g_FrameCapture->Finish() == false)
+		{
+			std::cout << "Some captured frames could not be saved" << std::endl;
+		}
+		std::cout << "Captured " << g_FrameCapture->GetCapturedCount() << " frames to "
+			<< g_RenderOptions.imageOutputDirectory << " (" << g_FrameCapture->GetStallCount()
+			<< " waits for the GPU or the encoders)" << std::endl;
+		delete g_FrameCapture;
+		g_FrameCapture = NULL;
+	}
+
+	if (NULL != g_SharedFrameOutput)
+	{
+		std::cout << "Published " << g_SharedFrameOutput->GetPublishedCount() << " frames to shared memory, "
+			<< g_SharedFrameOutput->GetAverageLatencyMs() << " ms after the copy was queued ("
+			<< g_SharedFrameOutput->GetAverageHandoffMs() << " ms handoff)" << std::endl;
+		g_SharedFrameOutput->Destroy();
+		delete g_SharedFrameOutput;
+		g_SharedFrameOutput = NULL;
+	}
+
+	const GL_STATE_STATS& stateStats = GLStateCache::GetStats();
+	if (stateStats.frameCount > 0)
+	{
+		std::cout << "State calls per frame: " << (stateStats.totalCalls / stateStats.frameCount) << ", "
+			<< (stateStats.totalRedundantCalls / stateStats.frameCount) << " redundant"
+			<< (g_RenderOptions.bStateCache ? " and dropped" : "") << std::endl;
+	}
+	if ((NULL != g_UniformManager) && (g_UniformManager->GetStats().frameCount > 0))
+	{
+		const UNIFORM_STATS& uniformStats = g_UniformManager->GetStats();
+		std::cout << "Uniform uploads per frame: " << (uniformStats.totalUploads / uniformStats.frameCount) << ", "
+			<< (uniformStats.totalRedundantWrites / uniformStats.frameCount) << " redundant writes"
+			<< (g_RenderOptions.bStateCache ? " skipped" : "") << std::endl;
 	}
 
 	// clear the allocated manager objects from memory
+	if (NULL != g_FrameLimiter)
+	{
+		delete g_FrameLimiter;
+		g_FrameLimiter = NULL;
+	}
+	if (NULL != g_FrameScheduler)
+	{
+		delete g_FrameScheduler;
+		g_FrameScheduler = NULL;
+	}
+	if (NULL != g_ResolutionManager)
+	{
+		delete g_ResolutionManager;
+		g_ResolutionManager = NULL;
+	}
+	if (NULL != g_QualityManager)
+	{
+		delete g_QualityManager;
+		g_QualityManager = NULL;
+	}
 	if (NULL != g_SceneManager)
 	{
 		delete g_SceneManager;
 		g_SceneManager = NULL;
 	}
+	if (NULL != g_UniformManager)
+	{
+		delete g_UniformManager;
+		g_UniformManager = NULL;
+	}
+	if (NULL != g_ProgramCache)
+	{
+		// a scene program that was never finished is deleted here
+		delete g_ProgramCache;
+		g_ProgramCache = NULL;
+		g_SceneProgramBuild = -1;
+	}
+	if (0 != g_FallbackProgram)
+	{
+		glDeleteProgram(g_FallbackProgram);
+		g_FallbackProgram = 0;
+	}
+	if (NULL != g_FrameSync)
+	{
+		g_ViewManager->SetFrameSync(NULL);
+		delete g_FrameSync;
+		g_FrameSync = NULL;
+	}
+}
+
+/***********************************************************
+ *  RenderThreadMain()
+ *
+ *  This function is used as the body of the render thread.
+ *  It makes the OpenGL context current on the thread and
+ *  runs the render loop, then wakes the main thread so it
+ *  stops waiting for window events.
+ ***********************************************************/
+void RenderThreadMain()
+{
+	glfwMakeContextCurrent(g_Window);
+
+	g_bRenderingPrepared = PrepareRendering();
+	if (g_bRenderingPrepared)
+	{
+		RenderLoop();
+	}
+	DestroyRendering();
+
+	glfwMakeContextCurrent(NULL);
+	g_bRenderThreadRunning = false;
+	glfwPostEmptyEvent();
+}
+
+/***********************************************************
+ *  RunHeadless()
+ *
+ *  This function is used for rendering without a window.
+ *  An EGL context is created instead of a GLFW window, the
+ *  configured number of frames is rendered into a framebuffer
+ *  object, and the exit code of the application is returned.
+ ***********************************************************/
+int RunHeadless()
+{
+	HeadlessContext context;
+	if (context.Create() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	g_ShaderManager = new ShaderManager();
+	g_ViewManager = new ViewManager(g_ShaderManager);
+
+	bool bRendered = PrepareRendering();
+	if (bRendered)
+	{
+		bRendered = RenderHeadlessFrames();
+	}
+	DestroyRendering();
+
+	// clear the allocated manager objects from memory
 	if (NULL != g_ViewManager)
 	{
 		delete g_ViewManager;
@@ -126,9 +814,287 @@ int main(int argc, char* argv[])
 		delete g_ShaderManager;
 		g_ShaderManager = NULL;
 	}
+	context.Destroy();
 
-	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
+	return((bRendered) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/***********************************************************
+ *  RenderHeadlessFrames()
+ *
+ *  This function is used for rendering the configured
+ *  number of frames into a framebuffer object at the window
+ *  size.  Each frame runs exactly one update step, so the
+ *  rendered frames do not depend on how fast they render.
+ ***********************************************************/
+bool RenderHeadlessFrames()
+{
+	int width = 0;
+	int height = 0;
+	g_ViewManager->GetFramebufferSize(width, height);
+
+	RenderTarget renderTarget;
+	if (renderTarget.Resize(width, height) == false)
+	{
+		return(false);
+	}
+
+	auto renderStartTime = std::chrono::steady_clock::now();
+
+	for (int frame = 0; frame < g_RenderOptions.headlessFrames; frame++)
+	{
+		g_ViewManager->UpdateView(g_FrameScheduler->GetStepSeconds());
+
+		renderTarget.Bind(width, height);
+		DrawFrame(1.0);
+
+		if (NULL != g_FrameCapture)
+		{
+			g_FrameCapture->CaptureNextFrame(width, height);
+		}
+		if (NULL != g_SharedFrameOutput)
+		{
+			g_SharedFrameOutput->PublishFrame(width, height);
+		}
+	}
+	glFinish();
+	if (NULL != g_SharedFrameOutput)
+	{
+		g_SharedFrameOutput->Update();
+	}
+
+	std::chrono::duration<double, std::milli> renderTime = std::chrono::steady_clock::now() - renderStartTime;
+	std::cout << "Rendered " << g_RenderOptions.headlessFrames << " frames at " << width << "x" << height
+		<< " in " << renderTime.count() << " ms ("
+		<< renderTime.count() / std::max(1, g_RenderOptions.headlessFrames) << " ms per frame)" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  RunBatch()
+ *
+ *  This function is used for rendering the camera views of
+ *  the batch file to images.  With more than one worker, the
+ *  processes are forked before any OpenGL state exists, and
+ *  each one creates its own context, prepares the scene once
+ *  and renders every worker count view from its own index.
+ ***********************************************************/
+int RunBatch()
+{
+	std::vector<BATCH_VIEW> views;
+	if (BatchRenderer::LoadViews(g_RenderOptions.batchFilename, views) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// the images must not depend on how fast this machine is,
+	// so the benchmark is replaced by the highest tier
+	if (g_RenderOptions.quality == "auto")
+	{
+		g_RenderOptions.quality = "high";
+	}
+
+	int workerCount = (int)std::min<size_t>(g_RenderOptions.batchWorkers, views.size());
+	bool bRendered = true;
+	bool bForked = false;
+	auto startTime = std::chrono::steady_clock::now();
+
+#ifdef __linux__
+	if (workerCount > 1)
+	{
+		std::vector<pid_t> workers;
+		for (int worker = 0; worker < workerCount; worker++)
+		{
+			pid_t pid = fork();
+			if (pid == 0)
+			{
+				bool bWorkerRendered = RenderBatchViews(views, worker, workerCount);
+				_exit((bWorkerRendered) ? EXIT_SUCCESS : EXIT_FAILURE);
+			}
+			if (pid < 0)
+			{
+				std::cout << "Could not start a batch worker process" << std::endl;
+				bRendered = false;
+				break;
+			}
+			workers.push_back(pid);
+		}
+
+		for (pid_t pid : workers)
+		{
+			int status = 0;
+			if ((waitpid(pid, &status, 0) != pid) || (WIFEXITED(status) == false) ||
+				(WEXITSTATUS(status) != EXIT_SUCCESS))
+			{
+				bRendered = false;
+			}
+		}
+		bForked = true;
+	}
+#else
+	if (workerCount > 1)
+	{
+		std::cout << "Batch worker processes are only supported on Linux, using one process" << std::endl;
+	}
+#endif
+
+	if (bForked == false)
+	{
+		workerCount = 1;
+		bRendered = RenderBatchViews(views, 0, 1);
+	}
+
+	std::chrono::duration<double> batchTime = std::chrono::steady_clock::now() - startTime;
+	std::cout << "Batch of " << views.size() << " views with " << workerCount << " process(es) took "
+		<< batchTime.count() << " s (" << views.size() / std::max(batchTime.count(), 1e-9)
+		<< " views per second, including startup)" << std::endl;
+
+	return((bRendered) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/***********************************************************
+ *  RenderBatchViews()
+ *
+ *  This function is used for rendering the batch views from
+ *  the first index, every viewStep views, with the scene
+ *  prepared once.
+ ***********************************************************/
+bool RenderBatchViews(const std::vector<BATCH_VIEW>& views, size_t firstView, size_t viewStep)
+{
+	return(RenderOffscreen([&]()
+		{
+			BatchRenderer batchRenderer(g_ViewManager, []() { DrawFrame(1.0); });
+			batchRenderer.SetTileSize(g_RenderOptions.tileSize);
+			bool bRendered = batchRenderer.RenderViews(
+				views,
+				firstView,
+				viewStep,
+				g_RenderOptions.imageOutputDirectory,
+				g_RenderOptions.imageFormat);
+
+			int renderedCount = batchRenderer.GetRenderedCount();
+			double renderSeconds = batchRenderer.GetRenderSeconds();
+			std::cout << "Rendered " << renderedCount << " views in " << renderSeconds << " s ("
+				<< renderedCount / std::max(renderSeconds, 1e-9) << " views per second)" << std::endl;
+
+			return(bRendered);
+		}));
+}
+
+/***********************************************************
+ *  RunServer()
+ *
+ *  This function is used for running the render daemon.
+ *  The scene is prepared once, then the jobs of the clients
+ *  are rendered until a shutdown job or signal arrives.
+ ***********************************************************/
+int RunServer()
+{
+	// the images must not depend on how fast this machine is,
+	// so the benchmark is replaced by the highest tier
+	if (g_RenderOptions.quality == "auto")
+	{
+		g_RenderOptions.quality = "high";
+	}
+
+	std::string sharedOutputName = g_RenderOptions.sharedOutputName;
+	if (sharedOutputName.empty())
+	{
+		sharedOutputName = "render_server_frames";
+	}
+
+	bool bServed = RenderOffscreen([&]()
+		{
+			RenderServer server(g_ViewManager, g_QualityManager, []() { DrawFrame(1.0); });
+			if (server.Start(g_RenderOptions.serverSocketPath, sharedOutputName) == false)
+			{
+				return(false);
+			}
+			server.Run();
+			return(true);
+		});
+
+	return((bServed) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+/***********************************************************
+ *  IsJobMode()
+ *
+ *  This function is used for checking whether the scene is
+ *  rendered for batch views or server jobs, which bring
+ *  their own cameras and targets, instead of the frames of
+ *  the render loop.
+ ***********************************************************/
+bool IsJobMode()
+{
+	return((g_RenderOptions.batchFilename.empty() == false) ||
+		(g_RenderOptions.serverSocketPath.empty() == false));
+}
+
+/***********************************************************
+ *  RenderOffscreen()
+ *
+ *  This function is used for creating an OpenGL context for
+ *  offscreen rendering, preparing the scene, and running the
+ *  passed in jobs while the context is current.  The context
+ *  is made with EGL in headless mode, and with a hidden
+ *  window otherwise.
+ ***********************************************************/
+bool RenderOffscreen(const std::function<bool()>& renderJobs)
+{
+	HeadlessContext headlessContext;
+	if (g_RenderOptions.bHeadless)
+	{
+		if (headlessContext.Create() == false)
+		{
+			return(false);
+		}
+	}
+	else
+	{
+		if (InitializeGLFW() == false)
+		{
+			return(false);
+		}
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
+
+	g_ShaderManager = new ShaderManager();
+	g_ViewManager = new ViewManager(g_ShaderManager);
+
+	bool bRendered = true;
+	if (g_RenderOptions.bHeadless == false)
+	{
+		g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+		bRendered = (NULL != g_Window);
+	}
+	if (bRendered)
+	{
+		bRendered = PrepareRendering();
+	}
+	if (bRendered)
+	{
+		// the jobs free their GL objects before returning, while
+		// the context is still current
+		bRendered = renderJobs();
+	}
+	DestroyRendering();
+
+	// clear the allocated manager objects from memory
+	if (NULL != g_ViewManager)
+	{
+		delete g_ViewManager;
+		g_ViewManager = NULL;
+	}
+	if (NULL != g_ShaderManager)
+	{
+		delete g_ShaderManager;
+		g_ShaderManager = NULL;
+	}
+	headlessContext.Destroy();
+
+	return(bRendered);
 }
 
 /***********************************************************
@@ -169,8 +1135,14 @@ bool InitializeGLEW()
 	// -----------------------------------------
 	GLenum GLEWInitResult = GLEW_OK;
 
-	// try to initialize the GLEW library
+	// try to initialize the GLEW library, where a headless EGL
+	// context has no GLX display, but the OpenGL functions are
+	// still loaded
 	GLEWInitResult = glewInit();
+	if ((GLEW_ERROR_NO_GLX_DISPLAY == GLEWInitResult) && (g_RenderOptions.bHeadless))
+	{
+		GLEWInitResult = GLEW_OK;
+	}
 	if (GLEW_OK != GLEWInitResult)
 	{
 		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
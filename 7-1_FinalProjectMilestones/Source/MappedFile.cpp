@@ -0,0 +1,159 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.cpp
+// ============
+// map a file into memory for read-only access without copying it
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/***********************************************************
+ *  MappedFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MappedFile::MappedFile()
+{
+	m_pData = NULL;
+	m_size = 0;
+#ifdef _WIN32
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_hMapping = NULL;
+#else
+	m_fileDescriptor = -1;
+#endif
+}
+
+/***********************************************************
+ *  ~MappedFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping the whole of the passed
+ *  in file into memory for reading.  Empty files cannot be
+ *  mapped and are reported as a failure.
+ ***********************************************************/
+bool MappedFile::Open(const std::string& filename)
+{
+	Close();
+
+#ifdef _WIN32
+	m_hFile = CreateFileA(
+		filename.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		NULL,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		NULL);
+	if (m_hFile == INVALID_HANDLE_VALUE)
+	{
+		return(false);
+	}
+
+	LARGE_INTEGER fileSize;
+	if ((GetFileSizeEx(m_hFile, &fileSize) == FALSE) || (fileSize.QuadPart <= 0))
+	{
+		Close();
+		return(false);
+	}
+	m_size = (size_t)fileSize.QuadPart;
+
+	m_hMapping = CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_hMapping == NULL)
+	{
+		Close();
+		return(false);
+	}
+
+	m_pData = (const unsigned char*)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	m_fileDescriptor = open(filename.c_str(), O_RDONLY);
+	if (m_fileDescriptor < 0)
+	{
+		return(false);
+	}
+
+	struct stat fileStatus;
+	if ((fstat(m_fileDescriptor, &fileStatus) != 0) || (fileStatus.st_size <= 0))
+	{
+		Close();
+		return(false);
+	}
+	m_size = (size_t)fileStatus.st_size;
+
+	void* pView = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, m_fileDescriptor, 0);
+	if (pView != MAP_FAILED)
+	{
+		m_pData = (const unsigned char*)pView;
+	}
+#endif
+
+	if (m_pData == NULL)
+	{
+		Close();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for releasing the mapped view and
+ *  closing the file handles.
+ ***********************************************************/
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (m_pData != NULL)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+	if (m_hMapping != NULL)
+	{
+		CloseHandle(m_hMapping);
+		m_hMapping = NULL;
+	}
+	if (m_hFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_hFile);
+		m_hFile = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (m_pData != NULL)
+	{
+		munmap((void*)m_pData, m_size);
+	}
+	if (m_fileDescriptor >= 0)
+	{
+		close(m_fileDescriptor);
+		m_fileDescriptor = -1;
+	}
+#endif
+	m_pData = NULL;
+	m_size = 0;
+}
@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// map a file into memory for read-only access without copying it
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/***********************************************************
+ *  MappedFile
+ *
+ *  This class wraps the operating system calls that are
+ *  used for mapping a whole file into the address space of
+ *  the process.  The mapping is released on Close() or
+ *  when the object is destroyed.
+ ***********************************************************/
+class MappedFile
+{
+public:
+	// constructor
+	MappedFile();
+	// destructor
+	~MappedFile();
+
+	// map the passed in file for reading
+	bool Open(const std::string& filename);
+	// release the mapping and the file handles
+	void Close();
+
+	// the mapped bytes and their count
+	const unsigned char* GetData() const { return(m_pData); }
+	size_t GetSize() const { return(m_size); }
+
+private:
+	// the mapping cannot be shared between objects
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// start of the mapped view
+	const unsigned char* m_pData;
+	// size of the mapped view in bytes
+	size_t m_size;
+#ifdef _WIN32
+	// file and mapping object handles
+	void* m_hFile;
+	void* m_hMapping;
+#else
+	// file descriptor of the mapped file
+	int m_fileDescriptor;
+#endif
+};
@@ -0,0 +1,208 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.cpp
+// ============
+// save and load generated mesh data to and from a binary file cache
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshCache.h"
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// "MSHC" in little endian byte order
+	const uint32_t MESH_CACHE_MAGIC = 0x4348534D;
+	// must be increased whenever the file layout or the way
+	// the mesh data is processed before caching changes
+	const uint32_t MESH_CACHE_VERSION = 2;
+
+	/***********************************************************
+	 *  MESH_CACHE_HEADER
+	 *
+	 *  The header at the start of every cache file, followed
+	 *  by the vertex array and then the index array.
+	 ***********************************************************/
+	struct MESH_CACHE_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceKey;
+		uint32_t vertexStride;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t reserved;
+	};
+}
+
+/***********************************************************
+ *  MeshCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshCache::MeshCache(std::string cacheDirectory)
+{
+	m_cacheDirectory = cacheDirectory;
+}
+
+/***********************************************************
+ *  HashKey()
+ *
+ *  This method is used for calculating the 64-bit FNV-1a
+ *  hash of the passed in text.
+ ***********************************************************/
+uint64_t MeshCache::HashKey(const std::string& text)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		hash ^= (unsigned char)text[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return(hash);
+}
+
+/***********************************************************
+ *  GetTempFilename()
+ *
+ *  This method is used for getting the name of the file that
+ *  a cache file is written to before it is renamed.  The
+ *  name holds the process ID, so batch workers that save the
+ *  same entry at once never write into each other's file.
+ ***********************************************************/
+std::string MeshCache::GetTempFilename(const std::string& filename)
+{
+#ifdef _WIN32
+	int processID = _getpid();
+#else
+	int processID = (int)getpid();
+#endif
+
+	return(filename + "." + std::to_string(processID) + ".tmp");
+}
+
+/***********************************************************
+ *  GetCacheFilename()
+ *
+ *  This method is used for getting the path of the cache
+ *  file that holds the mesh with the passed in tag.
+ ***********************************************************/
+std::string MeshCache::GetCacheFilename(std::string tag)
+{
+	return(m_cacheDirectory + "/" + tag + ".mesh");
+}
+
+/***********************************************************
+ *  LoadMesh()
+ *
+ *  This method is used for loading a mesh from the cache.
+ *  The file is mapped into memory and validated against
+ *  the cache version, the vertex layout and the source
+ *  key before the data is copied out of the mapping.
+ ***********************************************************/
+bool MeshCache::LoadMesh(std::string tag, uint64_t sourceKey, MESH_DATA& mesh)
+{
+	MappedFile file;
+	if (file.Open(GetCacheFilename(tag)) == false)
+	{
+		return(false);
+	}
+
+	if (file.GetSize() < sizeof(MESH_CACHE_HEADER))
+	{
+		return(false);
+	}
+
+	MESH_CACHE_HEADER header;
+	memcpy(&header, file.GetData(), sizeof(header));
+	if ((header.magic != MESH_CACHE_MAGIC) ||
+		(header.version != MESH_CACHE_VERSION) ||
+		(header.vertexStride != sizeof(MESH_VERTEX)) ||
+		(header.sourceKey != sourceKey))
+	{
+		return(false);
+	}
+
+	size_t vertexBytes = (size_t)header.vertexCount * sizeof(MESH_VERTEX);
+	size_t indexBytes = (size_t)header.indexCount * sizeof(uint32_t);
+	if (file.GetSize() != sizeof(header) + vertexBytes + indexBytes)
+	{
+		std::cout << "Ignoring truncated mesh cache file for " << tag << std::endl;
+		return(false);
+	}
+
+	const unsigned char* pVertices = file.GetData() + sizeof(header);
+	const unsigned char* pIndices = pVertices + vertexBytes;
+
+	mesh.vertices.resize(header.vertexCount);
+	mesh.indices.resize(header.indexCount);
+	memcpy(mesh.vertices.data(), pVertices, vertexBytes);
+	memcpy(mesh.indices.data(), pIndices, indexBytes);
+
+	return(true);
+}
+
+/***********************************************************
+ *  SaveMesh()
+ *
+ *  This method is used for writing a mesh into the cache.
+ *  The data is written to a temporary file first and then
+ *  renamed, so a partly written file is never loaded.
+ ***********************************************************/
+bool MeshCache::SaveMesh(std::string tag, uint64_t sourceKey, const MESH_DATA& mesh)
+{
+	std::error_code error;
+	std::filesystem::create_directories(m_cacheDirectory, error);
+
+	std::string filename = GetCacheFilename(tag);
+	std::string tempFilename = GetTempFilename(filename);
+
+	MESH_CACHE_HEADER header;
+	header.magic = MESH_CACHE_MAGIC;
+	header.version = MESH_CACHE_VERSION;
+	header.sourceKey = sourceKey;
+	header.vertexStride = sizeof(MESH_VERTEX);
+	header.vertexCount = (uint32_t)mesh.vertices.size();
+	header.indexCount = (uint32_t)mesh.indices.size();
+	header.reserved = 0;
+
+	{
+		std::ofstream output(tempFilename, std::ios::binary | std::ios::trunc);
+		if (!output)
+		{
+			std::cout << "Could not write mesh cache file:" << tempFilename << std::endl;
+			return(false);
+		}
+
+		output.write((const char*)&header, sizeof(header));
+		output.write((const char*)mesh.vertices.data(), mesh.vertices.size() * sizeof(MESH_VERTEX));
+		output.write((const char*)mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+		if (!output)
+		{
+			output.close();
+			std::filesystem::remove(tempFilename, error);
+			return(false);
+		}
+	}
+
+	std::filesystem::rename(tempFilename, filename, error);
+	if (error)
+	{
+		std::filesystem::remove(tempFilename, error);
+		return(false);
+	}
+
+	return(true);
+}
@@ -0,0 +1,44 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshcache.h
+// ============
+// save and load generated mesh data to and from a binary file cache
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+
+#include <string>
+
+/***********************************************************
+ *  MeshCache
+ *
+ *  This class contains the code for storing mesh data in a
+ *  versioned binary file per mesh and for reading it back
+ *  by mapping the file into memory.  Each entry records a
+ *  key of the data it was built from, so that stale entries
+ *  are rejected instead of being drawn.
+ ***********************************************************/
+class MeshCache
+{
+public:
+	// constructor
+	MeshCache(std::string cacheDirectory);
+
+	// load the cached data of a mesh, if it is present and valid
+	bool LoadMesh(std::string tag, uint64_t sourceKey, MESH_DATA& mesh);
+	// save the data of a mesh into the cache
+	bool SaveMesh(std::string tag, uint64_t sourceKey, const MESH_DATA& mesh);
+
+	// calculate a 64-bit key from a string describing the source data
+	static uint64_t HashKey(const std::string& text);
+	// get a temporary filename for writing a cache file in this process
+	static std::string GetTempFilename(const std::string& filename);
+
+private:
+	// folder that holds the cache files
+	std::string m_cacheDirectory;
+
+	// get the cache filename for a mesh tag
+	std::string GetCacheFilename(std::string tag);
+};
@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshdata.h
+// ============
+// CPU side vertex and index data for the meshes in the 3D scene
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  MESH_VERTEX
+ *
+ *  One interleaved vertex, laid out to match the attribute
+ *  locations 0 to 2 in the vertex shader.
+ ***********************************************************/
+struct MESH_VERTEX
+{
+	float position[3];
+	float normal[3];
+	float textureCoordinate[2];
+};
+
+/***********************************************************
+ *  MESHLET
+ *
+ *  A small cluster of neighboring triangles that occupies a
+ *  contiguous range of the index list, with a bounding
+ *  sphere and a cone that contains all of its triangle
+ *  normals.  The cone apex and axis allow the whole cluster
+ *  to be skipped when every triangle faces away.
+ ***********************************************************/
+struct MESHLET
+{
+	uint32_t indexOffset;
+	uint32_t indexCount;
+	float center[3];
+	float radius;
+	float coneApex[3];
+	float coneAxis[3];
+	float coneCutoff;
+};
+
+/***********************************************************
+ *  MESH_DATA
+ *
+ *  The vertices and triangle list indices of one mesh,
+ *  ready to be uploaded into OpenGL buffers.
+ ***********************************************************/
+struct MESH_DATA
+{
+	std::vector<MESH_VERTEX> vertices;
+	std::vector<uint32_t> indices;
+};
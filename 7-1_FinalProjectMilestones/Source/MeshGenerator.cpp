@@ -0,0 +1,439 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.cpp
+// ============
+// generate the vertex and index data for the basic 3D shapes
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	const float PI = 3.14159265358979f;
+
+	// tessellation of the curved shapes
+	const int CYLINDER_SIDES = 36;
+	const int SPHERE_STACKS = 18;
+	const int SPHERE_SECTORS = 36;
+	const int TORUS_MAIN_SEGMENTS = 36;
+	const int TORUS_TUBE_SEGMENTS = 18;
+
+	// each level of detail halves the tessellation of the curved
+	// shapes, down to these minimums
+	const int MESH_LOD_COUNT = 3;
+	const int CYLINDER_MIN_SIDES = 8;
+	const int SPHERE_MIN_STACKS = 6;
+	const int SPHERE_MIN_SECTORS = 12;
+	const int TORUS_MIN_MAIN_SEGMENTS = 12;
+	const int TORUS_MIN_TUBE_SEGMENTS = 6;
+
+	// radius of the torus ring and of the tube around it
+	const float TORUS_MAIN_RADIUS = 1.0f;
+	const float TORUS_TUBE_RADIUS = 0.1f;
+
+	/***********************************************************
+	 *  GetLODSegments()
+	 *
+	 *  Get the segment count of a curved shape at a level of
+	 *  detail, halving the full count for every level.
+	 ***********************************************************/
+	int GetLODSegments(int segments, int lod, int minimumSegments)
+	{
+		return(std::max(segments >> lod, minimumSegments));
+	}
+
+	/***********************************************************
+	 *  AddVertex()
+	 *
+	 *  Append one interleaved vertex to the passed in mesh and
+	 *  return its index.
+	 ***********************************************************/
+	uint32_t AddVertex(
+		MESH_DATA& mesh,
+		float x, float y, float z,
+		float nx, float ny, float nz,
+		float u, float v)
+	{
+		MESH_VERTEX vertex;
+		vertex.position[0] = x;
+		vertex.position[1] = y;
+		vertex.position[2] = z;
+		vertex.normal[0] = nx;
+		vertex.normal[1] = ny;
+		vertex.normal[2] = nz;
+		vertex.textureCoordinate[0] = u;
+		vertex.textureCoordinate[1] = v;
+		mesh.vertices.push_back(vertex);
+
+		return((uint32_t)(mesh.vertices.size() - 1));
+	}
+
+	/***********************************************************
+	 *  AddTriangle()
+	 *
+	 *  Append one counter-clockwise triangle to the index list.
+	 ***********************************************************/
+	void AddTriangle(MESH_DATA& mesh, uint32_t a, uint32_t b, uint32_t c)
+	{
+		mesh.indices.push_back(a);
+		mesh.indices.push_back(b);
+		mesh.indices.push_back(c);
+	}
+}
+
+/***********************************************************
+ *  GenerateMesh()
+ *
+ *  This method is used for generating the basic shape that
+ *  is associated with the passed in tag, at a level of
+ *  detail.  Level 0 has the full tessellation.
+ ***********************************************************/
+bool MeshGenerator::GenerateMesh(std::string tag, int lod, MESH_DATA& mesh)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	if ((lod < 0) || (lod >= GetLODCount(tag)))
+		return(false);
+
+	int sides = GetLODSegments(CYLINDER_SIDES, lod, CYLINDER_MIN_SIDES);
+
+	if (tag == "plane")
+		GeneratePlaneMesh(mesh);
+	else if (tag == "box")
+		GenerateBoxMesh(mesh);
+	else if (tag == "cylinder")
+		GenerateCylinderMesh(mesh, sides);
+	else if (tag == "taperedcylinder")
+		GenerateTaperedCylinderMesh(mesh, sides);
+	else if (tag == "cone")
+		GenerateConeMesh(mesh, sides);
+	else if (tag == "sphere")
+		GenerateSphereMesh(mesh,
+			GetLODSegments(SPHERE_STACKS, lod, SPHERE_MIN_STACKS),
+			GetLODSegments(SPHERE_SECTORS, lod, SPHERE_MIN_SECTORS));
+	else if (tag == "torus")
+		GenerateTorusMesh(mesh,
+			GetLODSegments(TORUS_MAIN_SEGMENTS, lod, TORUS_MIN_MAIN_SEGMENTS),
+			GetLODSegments(TORUS_TUBE_SEGMENTS, lod, TORUS_MIN_TUBE_SEGMENTS));
+	else
+		return(false);
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetLODCount()
+ *
+ *  This method is used for getting the number of levels of
+ *  detail of a basic shape.  Flat shapes only have one, and
+ *  unknown tags have none.
+ ***********************************************************/
+int MeshGenerator::GetLODCount(std::string tag)
+{
+	if ((tag == "plane") || (tag == "box"))
+		return(1);
+	if ((tag == "cylinder") || (tag == "taperedcylinder") || (tag == "cone") ||
+		(tag == "sphere") || (tag == "torus"))
+		return(MESH_LOD_COUNT);
+
+	return(0);
+}
+
+/***********************************************************
+ *  GetMeshDescriptor()
+ *
+ *  This method is used for getting a string that uniquely
+ *  describes the generated data of a basic shape at a level
+ *  of detail, so that cached copies are rebuilt when the
+ *  tessellation changes.  An empty string is returned for
+ *  unknown tags and levels.
+ ***********************************************************/
+std::string MeshGenerator::GetMeshDescriptor(std::string tag, int lod)
+{
+	if ((lod < 0) || (lod >= GetLODCount(tag)))
+		return("");
+
+	if ((tag == "plane") || (tag == "box"))
+		return(tag);
+	if ((tag == "cylinder") || (tag == "taperedcylinder") || (tag == "cone"))
+		return(tag + "/" + std::to_string(GetLODSegments(CYLINDER_SIDES, lod, CYLINDER_MIN_SIDES)));
+	if (tag == "sphere")
+		return(tag + "/" + std::to_string(GetLODSegments(SPHERE_STACKS, lod, SPHERE_MIN_STACKS)) +
+			"/" + std::to_string(GetLODSegments(SPHERE_SECTORS, lod, SPHERE_MIN_SECTORS)));
+	if (tag == "torus")
+		return(tag + "/" + std::to_string(GetLODSegments(TORUS_MAIN_SEGMENTS, lod, TORUS_MIN_MAIN_SEGMENTS)) +
+			"/" + std::to_string(GetLODSegments(TORUS_TUBE_SEGMENTS, lod, TORUS_MIN_TUBE_SEGMENTS)) +
+			"/" + std::to_string(TORUS_MAIN_RADIUS) + "/" + std::to_string(TORUS_TUBE_RADIUS));
+
+	return("");
+}
+
+/***********************************************************
+ *  GeneratePlaneMesh()
+ *
+ *  This method is used for generating a flat plane that
+ *  spans -1 to 1 on the X and Z axes and faces up.
+ ***********************************************************/
+void MeshGenerator::GeneratePlaneMesh(MESH_DATA& mesh)
+{
+	uint32_t v0 = AddVertex(mesh, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f);
+	uint32_t v1 = AddVertex(mesh, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f);
+	uint32_t v2 = AddVertex(mesh, 1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f);
+	uint32_t v3 = AddVertex(mesh, -1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f);
+
+	AddTriangle(mesh, v0, v1, v2);
+	AddTriangle(mesh, v0, v2, v3);
+}
+
+/***********************************************************
+ *  GenerateBoxMesh()
+ *
+ *  This method is used for generating a unit box centered
+ *  on the origin.  Each face has its own four vertices so
+ *  that the normals and texture coordinates stay flat.
+ ***********************************************************/
+void MeshGenerator::GenerateBoxMesh(MESH_DATA& mesh)
+{
+	// face normal, then the U and V axes of the face, chosen
+	// so that U cross V points along the face normal
+	const float faces[6][9] =
+	{
+		{  1.0f,  0.0f,  0.0f,   0.0f, 0.0f, -1.0f,   0.0f, 1.0f,  0.0f },
+		{ -1.0f,  0.0f,  0.0f,   0.0f, 0.0f,  1.0f,   0.0f, 1.0f,  0.0f },
+		{  0.0f,  1.0f,  0.0f,   1.0f, 0.0f,  0.0f,   0.0f, 0.0f, -1.0f },
+		{  0.0f, -1.0f,  0.0f,   1.0f, 0.0f,  0.0f,   0.0f, 0.0f,  1.0f },
+		{  0.0f,  0.0f,  1.0f,   1.0f, 0.0f,  0.0f,   0.0f, 1.0f,  0.0f },
+		{  0.0f,  0.0f, -1.0f,  -1.0f, 0.0f,  0.0f,   0.0f, 1.0f,  0.0f },
+	};
+	const float corners[4][2] = { { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f } };
+
+	for (int face = 0; face < 6; face++)
+	{
+		const float* n = &faces[face][0];
+		const float* u = &faces[face][3];
+		const float* v = &faces[face][6];
+		uint32_t first = (uint32_t)mesh.vertices.size();
+
+		for (int corner = 0; corner < 4; corner++)
+		{
+			float su = corners[corner][0];
+			float sv = corners[corner][1];
+			AddVertex(mesh,
+				0.5f * (n[0] + su * u[0] + sv * v[0]),
+				0.5f * (n[1] + su * u[1] + sv * v[1]),
+				0.5f * (n[2] + su * u[2] + sv * v[2]),
+				n[0], n[1], n[2],
+				0.5f * (su + 1.0f), 0.5f * (sv + 1.0f));
+		}
+
+		AddTriangle(mesh, first, first + 1, first + 2);
+		AddTriangle(mesh, first, first + 2, first + 3);
+	}
+}
+
+/***********************************************************
+ *  GenerateCylinderMesh()
+ *
+ *  This method is used for generating a closed cylinder
+ *  with a radius of 1 that spans 0 to 1 on the Y axis.
+ ***********************************************************/
+void MeshGenerator::GenerateCylinderMesh(MESH_DATA& mesh, int sides)
+{
+	GenerateFrustumMesh(mesh, sides, 1.0f, 1.0f);
+}
+
+/***********************************************************
+ *  GenerateTaperedCylinderMesh()
+ *
+ *  This method is used for generating a closed cylinder
+ *  whose top radius is half of its bottom radius.
+ ***********************************************************/
+void MeshGenerator::GenerateTaperedCylinderMesh(MESH_DATA& mesh, int sides)
+{
+	GenerateFrustumMesh(mesh, sides, 1.0f, 0.5f);
+}
+
+/***********************************************************
+ *  GenerateConeMesh()
+ *
+ *  This method is used for generating a cone with its base
+ *  on the XZ plane and its tip at a height of 1.
+ ***********************************************************/
+void MeshGenerator::GenerateConeMesh(MESH_DATA& mesh, int sides)
+{
+	GenerateFrustumMesh(mesh, sides, 1.0f, 0.0f);
+}
+
+/***********************************************************
+ *  GenerateFrustumMesh()
+ *
+ *  This method is used for generating the side and the
+ *  caps of a cone frustum that spans 0 to 1 on the Y axis.
+ *  The top cap is left out when the top radius is zero.
+ ***********************************************************/
+void MeshGenerator::GenerateFrustumMesh(
+	MESH_DATA& mesh,
+	int sides,
+	float bottomRadius,
+	float topRadius)
+{
+	// the side normals lean outwards by the slope of the side
+	float slope = bottomRadius - topRadius;
+	float normalScale = 1.0f / std::sqrt(1.0f + (slope * slope));
+
+	// side - one column of bottom and top vertices per side,
+	// with the seam duplicated for the texture coordinates
+	uint32_t sideStart = (uint32_t)mesh.vertices.size();
+	for (int i = 0; i <= sides; i++)
+	{
+		float u = (float)i / (float)sides;
+		float angle = 2.0f * PI * u;
+		float c = std::cos(angle);
+		float s = std::sin(angle);
+
+		AddVertex(mesh, bottomRadius * c, 0.0f, bottomRadius * s,
+			c * normalScale, slope * normalScale, s * normalScale, u, 0.0f);
+		AddVertex(mesh, topRadius * c, 1.0f, topRadius * s,
+			c * normalScale, slope * normalScale, s * normalScale, u, 1.0f);
+	}
+	for (int i = 0; i < sides; i++)
+	{
+		uint32_t bottom0 = sideStart + (2 * i);
+		uint32_t top0 = bottom0 + 1;
+		uint32_t bottom1 = bottom0 + 2;
+		uint32_t top1 = bottom0 + 3;
+
+		AddTriangle(mesh, bottom0, top0, bottom1);
+		// the upper triangle collapses to a line at a cone tip
+		if (topRadius > 0.0f)
+			AddTriangle(mesh, bottom1, top0, top1);
+	}
+
+	// caps - a center vertex and a ring facing down or up
+	for (int cap = 0; cap < 2; cap++)
+	{
+		bool bTop = (cap == 1);
+		float radius = bTop ? topRadius : bottomRadius;
+		float y = bTop ? 1.0f : 0.0f;
+		float ny = bTop ? 1.0f : -1.0f;
+
+		if (radius <= 0.0f)
+		{
+			continue;
+		}
+
+		uint32_t center = AddVertex(mesh, 0.0f, y, 0.0f, 0.0f, ny, 0.0f, 0.5f, 0.5f);
+		for (int i = 0; i <= sides; i++)
+		{
+			float angle = 2.0f * PI * (float)i / (float)sides;
+			float c = std::cos(angle);
+			float s = std::sin(angle);
+			AddVertex(mesh, radius * c, y, radius * s, 0.0f, ny, 0.0f, 0.5f + (0.5f * c), 0.5f + (0.5f * s));
+		}
+		for (int i = 0; i < sides; i++)
+		{
+			uint32_t ring0 = center + 1 + i;
+			uint32_t ring1 = ring0 + 1;
+
+			if (bTop)
+				AddTriangle(mesh, center, ring1, ring0);
+			else
+				AddTriangle(mesh, center, ring0, ring1);
+		}
+	}
+}
+
+/***********************************************************
+ *  GenerateSphereMesh()
+ *
+ *  This method is used for generating a UV sphere with a
+ *  radius of 1 centered on the origin.
+ ***********************************************************/
+void MeshGenerator::GenerateSphereMesh(MESH_DATA& mesh, int stacks, int sectors)
+{
+	uint32_t first = (uint32_t)mesh.vertices.size();
+
+	for (int stack = 0; stack <= stacks; stack++)
+	{
+		float v = (float)stack / (float)stacks;
+		float phi = PI * v;
+		float ringRadius = std::sin(phi);
+		float y = std::cos(phi);
+
+		for (int sector = 0; sector <= sectors; sector++)
+		{
+			float u = (float)sector / (float)sectors;
+			float theta = 2.0f * PI * u;
+			float x = ringRadius * std::cos(theta);
+			float z = ringRadius * std::sin(theta);
+
+			AddVertex(mesh, x, y, z, x, y, z, u, 1.0f - v);
+		}
+	}
+
+	uint32_t rowLength = (uint32_t)sectors + 1;
+	for (int stack = 0; stack < stacks; stack++)
+	{
+		for (int sector = 0; sector < sectors; sector++)
+		{
+			uint32_t upper = first + (stack * rowLength) + sector;
+			uint32_t lower = upper + rowLength;
+
+			// the triangles touching the poles collapse to lines
+			if (stack != 0)
+				AddTriangle(mesh, upper, upper + 1, lower);
+			if (stack != (stacks - 1))
+				AddTriangle(mesh, upper + 1, lower + 1, lower);
+		}
+	}
+}
+
+/***********************************************************
+ *  GenerateTorusMesh()
+ *
+ *  This method is used for generating a torus that lies in
+ *  the XY plane and is centered on the origin.
+ ***********************************************************/
+void MeshGenerator::GenerateTorusMesh(MESH_DATA& mesh, int mainSegments, int tubeSegments)
+{
+	uint32_t first = (uint32_t)mesh.vertices.size();
+
+	for (int i = 0; i <= mainSegments; i++)
+	{
+		float u = (float)i / (float)mainSegments;
+		float theta = 2.0f * PI * u;
+		float cosTheta = std::cos(theta);
+		float sinTheta = std::sin(theta);
+
+		for (int j = 0; j <= tubeSegments; j++)
+		{
+			float v = (float)j / (float)tubeSegments;
+			float phi = 2.0f * PI * v;
+			float cosPhi = std::cos(phi);
+			float sinPhi = std::sin(phi);
+			float ringRadius = TORUS_MAIN_RADIUS + (TORUS_TUBE_RADIUS * cosPhi);
+
+			AddVertex(mesh,
+				ringRadius * cosTheta, ringRadius * sinTheta, TORUS_TUBE_RADIUS * sinPhi,
+				cosPhi * cosTheta, cosPhi * sinTheta, sinPhi,
+				u, v);
+		}
+	}
+
+	uint32_t rowLength = (uint32_t)tubeSegments + 1;
+	for (int i = 0; i < mainSegments; i++)
+	{
+		for (int j = 0; j < tubeSegments; j++)
+		{
+			uint32_t a = first + (i * rowLength) + j;
+			uint32_t b = a + rowLength;
+
+			AddTriangle(mesh, a, b, a + 1);
+			AddTriangle(mesh, a + 1, b, b + 1);
+		}
+	}
+}
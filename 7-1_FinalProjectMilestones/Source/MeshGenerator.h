@@ -0,0 +1,49 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.h
+// ============
+// generate the vertex and index data for the basic 3D shapes
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+
+#include <string>
+
+/***********************************************************
+ *  MeshGenerator
+ *
+ *  This class contains the code for generating the CPU side
+ *  data of the basic 3D shapes.  All of the shapes are unit
+ *  sized and use the same dimensions as the shapes in the
+ *  ShapeMeshes class, so existing scene transformations
+ *  can be used without any changes.  The curved shapes
+ *  can also be generated at lower levels of detail.
+ ***********************************************************/
+class MeshGenerator
+{
+public:
+	// generate the basic shape associated with the passed in tag
+	static bool GenerateMesh(std::string tag, int lod, MESH_DATA& mesh);
+	// get the number of levels of detail of a basic shape
+	static int GetLODCount(std::string tag);
+	// get a string describing the shape and its tessellation
+	static std::string GetMeshDescriptor(std::string tag, int lod);
+
+	// generate the individual basic shapes
+	static void GeneratePlaneMesh(MESH_DATA& mesh);
+	static void GenerateBoxMesh(MESH_DATA& mesh);
+	static void GenerateCylinderMesh(MESH_DATA& mesh, int sides);
+	static void GenerateTaperedCylinderMesh(MESH_DATA& mesh, int sides);
+	static void GenerateConeMesh(MESH_DATA& mesh, int sides);
+	static void GenerateSphereMesh(MESH_DATA& mesh, int stacks, int sectors);
+	static void GenerateTorusMesh(MESH_DATA& mesh, int mainSegments, int tubeSegments);
+
+private:
+	// generate a closed or open ended frustum of a cone
+	static void GenerateFrustumMesh(
+		MESH_DATA& mesh,
+		int sides,
+		float bottomRadius,
+		float topRadius);
+};
@@ -0,0 +1,564 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshmanager.cpp
+// ============
+// manage the loading and drawing of the meshes in the 3D scene
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshManager.h"
+#include "GLStateCache.h"
+#include "MeshGenerator.h"
+#include "MeshOptimizer.h"
+#include "ModelLoader.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// folder for the binary mesh cache files
+	const char* g_MeshCacheDirectory = "cache/meshes";
+
+	// meshes with fewer triangles are always drawn whole, since
+	// culling them would cost more than drawing them
+	const size_t MESHLET_CULLING_MIN_TRIANGLES = 4096;
+	// meshlet size limits, matching common mesh shader limits
+	const size_t MESHLET_MAX_VERTICES = 64;
+	const size_t MESHLET_MAX_TRIANGLES = 124;
+
+	// share of the view height that a mesh's bounding sphere
+	// radius has to cover to be drawn at full detail; every
+	// halving of the covered size moves one level coarser
+	const float LOD_FULL_DETAIL_SCREEN_SIZE = 0.1f;
+
+	// shader uniforms for decoding packed vertices
+	const char* g_PackedVerticesName = "bPackedVertices";
+	const char* g_PositionScaleName = "positionScale";
+	const char* g_PositionOffsetName = "positionOffset";
+	const char* g_TextureCoordinateScaleName = "textureCoordinateScale";
+	const char* g_TextureCoordinateOffsetName = "textureCoordinateOffset";
+}
+
+/***********************************************************
+ *  MeshManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshManager::MeshManager(UniformManager* pUniformManager)
+{
+	m_pUniformManager = pUniformManager;
+	m_packedVerticesUniform = -1;
+	m_positionScaleUniform = -1;
+	m_positionOffsetUniform = -1;
+	m_textureCoordinateScaleUniform = -1;
+	m_textureCoordinateOffsetUniform = -1;
+	if (NULL != m_pUniformManager)
+	{
+		m_packedVerticesUniform = m_pUniformManager->GetHandle(g_PackedVerticesName);
+		m_positionScaleUniform = m_pUniformManager->GetHandle(g_PositionScaleName);
+		m_positionOffsetUniform = m_pUniformManager->GetHandle(g_PositionOffsetName);
+		m_textureCoordinateScaleUniform = m_pUniformManager->GetHandle(g_TextureCoordinateScaleName);
+		m_textureCoordinateOffsetUniform = m_pUniformManager->GetHandle(g_TextureCoordinateOffsetName);
+	}
+	m_pMeshCache = new MeshCache(g_MeshCacheDirectory);
+	m_pWorkerPool = new WorkerPool(0);
+	m_bPackedVertices = false;
+	m_bHasPackedMeshes = false;
+	m_viewProjection = glm::mat4(1.0f);
+	m_cameraPosition = glm::vec3(0.0f);
+	m_bPerspective = true;
+	m_bHasView = false;
+	m_projectionScale = 1.0f;
+	m_lodBias = 0.0f;
+	m_modelMatrix = glm::mat4(1.0f);
+}
+
+/***********************************************************
+ *  ~MeshManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshManager::~MeshManager()
+{
+	DestroyMeshes();
+	delete m_pMeshCache;
+	m_pMeshCache = NULL;
+	delete m_pWorkerPool;
+	m_pWorkerPool = NULL;
+	m_pUniformManager = NULL;
+}
+
+/***********************************************************
+ *  LoadMesh()
+ *
+ *  This method is used for loading every level of detail of
+ *  a basic shape into OpenGL buffers.
+ ***********************************************************/
+bool MeshManager::LoadMesh(std::string tag)
+{
+	return(LoadMeshes(std::vector<std::string>(1, tag)));
+}
+
+/***********************************************************
+ *  LoadMeshes()
+ *
+ *  This method is used for loading every level of detail of
+ *  several basic shapes.  Each level is read from the mesh
+ *  cache, or generated and optimized, as an independent task
+ *  on the worker pool.  OpenGL calls can only be made from
+ *  the thread that owns the context, so the buffers of all
+ *  the levels are created together once the tasks finish.
+ ***********************************************************/
+bool MeshManager::LoadMeshes(const std::vector<std::string>& tags)
+{
+	bool bSuccess = true;
+	std::vector<MESH_UPLOAD> uploads;
+
+	for (size_t i = 0; i < tags.size(); i++)
+	{
+		const std::string& tag = tags[i];
+		if ((FindMesh(tag) != -1) || (std::find(tags.begin(), tags.begin() + i, tag) != tags.begin() + i))
+		{
+			continue;
+		}
+
+		int lodCount = MeshGenerator::GetLODCount(tag);
+		if (lodCount == 0)
+		{
+			std::cout << "Unknown mesh:" << tag << std::endl;
+			bSuccess = false;
+			continue;
+		}
+
+		for (int lod = 0; lod < lodCount; lod++)
+		{
+			MESH_UPLOAD upload;
+			upload.tag = tag;
+			upload.lod = lod;
+			upload.lodCount = lodCount;
+			upload.bReady = false;
+			uploads.push_back(upload);
+		}
+	}
+
+	m_pWorkerPool->ParallelFor(uploads.size(), [&](size_t i) { PrepareMeshUpload(uploads[i]); });
+
+	for (size_t i = 0; i < uploads.size(); i++)
+	{
+		if ((uploads[i].bReady == false) || (CreateGLMesh(uploads[i]) == false))
+		{
+			bSuccess = false;
+		}
+	}
+
+	return(bSuccess);
+}
+
+/***********************************************************
+ *  PrepareMeshUpload()
+ *
+ *  This method is used for getting the data of one level
+ *  of a basic shape ready for uploading.  The level is read
+ *  from the mesh cache, or generated, optimized for the GPU
+ *  and written into the cache when no valid entry exists.
+ *  It runs on a worker thread and makes no OpenGL calls.
+ ***********************************************************/
+void MeshManager::PrepareMeshUpload(MESH_UPLOAD& upload)
+{
+	std::string descriptor = MeshGenerator::GetMeshDescriptor(upload.tag, upload.lod);
+	std::string cacheTag = upload.tag;
+	if (upload.lod > 0)
+	{
+		cacheTag += ".lod" + std::to_string(upload.lod);
+	}
+
+	uint64_t sourceKey = MeshCache::HashKey(descriptor);
+	if (m_pMeshCache->LoadMesh(cacheTag, sourceKey, upload.mesh) == false)
+	{
+		if (MeshGenerator::GenerateMesh(upload.tag, upload.lod, upload.mesh) == false)
+		{
+			return;
+		}
+		MeshOptimizer::OptimizeMesh(upload.mesh, cacheTag);
+		if (m_pMeshCache->SaveMesh(cacheTag, sourceKey, upload.mesh) == false)
+		{
+			std::cout << ("Could not cache mesh:" + cacheTag + "\n") << std::flush;
+		}
+	}
+
+	PrepareGPUData(upload);
+	upload.bReady = true;
+}
+
+/***********************************************************
+ *  PrepareGPUData()
+ *
+ *  This method is used for converting the vertices into the
+ *  packed format when it is enabled, and for splitting large
+ *  meshes into meshlets for culling.
+ ***********************************************************/
+void MeshManager::PrepareGPUData(MESH_UPLOAD& upload)
+{
+	if (m_bPackedVertices)
+	{
+		PackMeshVertices(upload.mesh.vertices, upload.packedVertices, upload.dequantize);
+	}
+
+	if (upload.mesh.indices.size() / 3 >= MESHLET_CULLING_MIN_TRIANGLES)
+	{
+		MeshletBuilder::BuildMeshlets(upload.mesh, upload.meshlets, MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+	}
+}
+
+/***********************************************************
+ *  LoadModelMesh()
+ *
+ *  This method is used for loading an OBJ or glTF model file
+ *  into OpenGL buffers.  The optimized model is cached like
+ *  the basic shapes, and the cache entry is keyed by the
+ *  size and modification time of the model file, so it is
+ *  replaced when the file changes.
+ ***********************************************************/
+bool MeshManager::LoadModelMesh(std::string filename, std::string tag)
+{
+	if (FindMesh(tag) != -1)
+	{
+		return(true);
+	}
+
+	std::error_code error;
+	uintmax_t fileSize = std::filesystem::file_size(filename, error);
+	if (error)
+	{
+		std::cout << "Could not find model:" << filename << std::endl;
+		return(false);
+	}
+	long long fileTime = (long long)std::filesystem::last_write_time(filename, error).time_since_epoch().count();
+
+	MESH_UPLOAD upload;
+	upload.tag = tag;
+	upload.lod = 0;
+	upload.lodCount = 1;
+	uint64_t sourceKey = MeshCache::HashKey(
+		"model/" + filename + "/" + std::to_string(fileSize) + "/" + std::to_string(fileTime));
+
+	if (m_pMeshCache->LoadMesh(tag, sourceKey, upload.mesh) == false)
+	{
+		if (ModelLoader::LoadModel(filename, upload.mesh, m_pWorkerPool) == false)
+		{
+			return(false);
+		}
+		MeshOptimizer::OptimizeMesh(upload.mesh, tag);
+		if (m_pMeshCache->SaveMesh(tag, sourceKey, upload.mesh) == false)
+		{
+			std::cout << "Could not cache mesh:" << tag << std::endl;
+		}
+	}
+
+	PrepareGPUData(upload);
+	upload.bReady = true;
+
+	return(CreateGLMesh(upload));
+}
+
+/***********************************************************
+ *  GetMeshBounds()
+ *
+ *  This method is used for getting the object space bounding
+ *  box of a loaded mesh, which is needed for placing models
+ *  of unknown size in the scene.
+ ***********************************************************/
+bool MeshManager::GetMeshBounds(std::string tag, glm::vec3& boundsMin, glm::vec3& boundsMax)
+{
+	int index = FindMesh(tag);
+	if (index == -1)
+	{
+		return(false);
+	}
+
+	boundsMin = m_meshes[index].boundsMin;
+	boundsMax = m_meshes[index].boundsMax;
+	return(true);
+}
+
+/***********************************************************
+ *  CreateGLMesh()
+ *
+ *  This method is used for creating the vertex array and
+ *  buffer objects for a prepared mesh and copying its data
+ *  into them.  The attribute layout matches the vertex
+ *  shader, in either the full precision or the packed format.
+ ***********************************************************/
+bool MeshManager::CreateGLMesh(const MESH_UPLOAD& upload)
+{
+	const MESH_DATA& mesh = upload.mesh;
+	if (mesh.indices.empty())
+	{
+		return(false);
+	}
+
+	GL_MESH glMesh;
+	glMesh.tag = upload.tag;
+	glMesh.lod = upload.lod;
+	glMesh.lodCount = upload.lodCount;
+	glMesh.nIndices = (GLsizei)mesh.indices.size();
+	glMesh.bPacked = (upload.packedVertices.empty() == false);
+	glMesh.dequantize = upload.dequantize;
+	glMesh.meshlets = upload.meshlets;
+	m_bHasPackedMeshes = m_bHasPackedMeshes || glMesh.bPacked;
+
+	glMesh.boundsMin = glm::vec3(FLT_MAX);
+	glMesh.boundsMax = glm::vec3(-FLT_MAX);
+	for (size_t i = 0; i < mesh.vertices.size(); i++)
+	{
+		glm::vec3 position = glm::vec3(mesh.vertices[i].position[0], mesh.vertices[i].position[1], mesh.vertices[i].position[2]);
+		glMesh.boundsMin = glm::min(glMesh.boundsMin, position);
+		glMesh.boundsMax = glm::max(glMesh.boundsMax, position);
+	}
+
+	glGenVertexArrays(1, &glMesh.vao);
+	GLStateCache::BindVertexArray(glMesh.vao);
+
+	glGenBuffers(1, &glMesh.vbo);
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, glMesh.vbo);
+
+	if (glMesh.bPacked)
+	{
+		const std::vector<MESH_VERTEX_PACKED>& packedVertices = upload.packedVertices;
+		glBufferData(GL_ARRAY_BUFFER, packedVertices.size() * sizeof(MESH_VERTEX_PACKED), packedVertices.data(), GL_STATIC_DRAW);
+
+		// normalized 16-bit position, octahedral normal and
+		// texture coordinate attributes
+		GLsizei stride = sizeof(MESH_VERTEX_PACKED);
+		glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, stride, (void*)offsetof(MESH_VERTEX_PACKED, position));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (void*)offsetof(MESH_VERTEX_PACKED, normal));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)offsetof(MESH_VERTEX_PACKED, textureCoordinate));
+		glEnableVertexAttribArray(2);
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(MESH_VERTEX), mesh.vertices.data(), GL_STATIC_DRAW);
+
+		// position, normal and texture coordinate attributes
+		GLsizei stride = sizeof(MESH_VERTEX);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MESH_VERTEX, position));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MESH_VERTEX, normal));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MESH_VERTEX, textureCoordinate));
+		glEnableVertexAttribArray(2);
+	}
+
+	glGenBuffers(1, &glMesh.ebo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, glMesh.ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(uint32_t), mesh.indices.data(), GL_STATIC_DRAW);
+
+	GLStateCache::BindVertexArray(0);
+
+	m_meshes.push_back(glMesh);
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindMesh()
+ *
+ *  This method is used for getting the index of a loaded
+ *  mesh that is associated with the passed in tag and
+ *  level of detail.
+ ***********************************************************/
+int MeshManager::FindMesh(std::string tag, int lod)
+{
+	for (size_t index = 0; index < m_meshes.size(); index++)
+	{
+		if ((m_meshes[index].lod == lod) && (m_meshes[index].tag.compare(tag) == 0))
+		{
+			return((int)index);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing a previously loaded
+ *  mesh with the current shader settings, at the level of
+ *  detail that suits its size on the screen.
+ ***********************************************************/
+void MeshManager::DrawMesh(std::string tag)
+{
+	int index = FindMesh(tag);
+	if (index == -1)
+	{
+		return;
+	}
+
+	if (m_meshes[index].lodCount > 1)
+	{
+		int lodIndex = FindMesh(tag, SelectLOD(m_meshes[index]));
+		if (lodIndex != -1)
+		{
+			index = lodIndex;
+		}
+	}
+
+	const GL_MESH& glMesh = m_meshes[index];
+
+	// packed meshes need their dequantize values in the shader,
+	// and the shader must be switched back for unpacked meshes
+	// whenever both formats have been loaded
+	if ((glMesh.bPacked) && (NULL != m_pUniformManager))
+	{
+		const VERTEX_DEQUANTIZE& dequantize = glMesh.dequantize;
+		m_pUniformManager->SetBoolValue(m_packedVerticesUniform, true);
+		m_pUniformManager->SetVec3Value(m_positionScaleUniform,
+			glm::vec3(dequantize.positionScale[0], dequantize.positionScale[1], dequantize.positionScale[2]));
+		m_pUniformManager->SetVec3Value(m_positionOffsetUniform,
+			glm::vec3(dequantize.positionOffset[0], dequantize.positionOffset[1], dequantize.positionOffset[2]));
+		m_pUniformManager->SetVec2Value(m_textureCoordinateScaleUniform,
+			glm::vec2(dequantize.textureCoordinateScale[0], dequantize.textureCoordinateScale[1]));
+		m_pUniformManager->SetVec2Value(m_textureCoordinateOffsetUniform,
+			glm::vec2(dequantize.textureCoordinateOffset[0], dequantize.textureCoordinateOffset[1]));
+	}
+	else if ((m_bHasPackedMeshes) && (NULL != m_pUniformManager))
+	{
+		m_pUniformManager->SetBoolValue(m_packedVerticesUniform, false);
+	}
+
+	GLStateCache::BindVertexArray(glMesh.vao);
+	if ((glMesh.meshlets.empty() == false) && (m_bHasView))
+	{
+		DrawVisibleMeshlets(glMesh);
+	}
+	else
+	{
+		glDrawElements(GL_TRIANGLES, glMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+	}
+	GLStateCache::BindVertexArray(0);
+}
+
+/***********************************************************
+ *  SetViewProjection()
+ *
+ *  This method is used for setting the camera that the
+ *  meshlets of large meshes are culled against.  It should
+ *  be called once per frame before the scene is drawn.
+ ***********************************************************/
+void MeshManager::SetViewProjection(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& cameraPosition,
+	bool bPerspective)
+{
+	m_viewProjection = projection * view;
+	m_cameraPosition = cameraPosition;
+	m_bPerspective = bPerspective;
+	m_projectionScale = projection[1][1];
+	m_bHasView = true;
+}
+
+/***********************************************************
+ *  SelectLOD()
+ *
+ *  This method is used for choosing the level of detail of
+ *  a mesh from the share of the view height covered by its
+ *  bounding sphere with the current model matrix.  Every
+ *  level halves the tessellation, so a level is used once
+ *  the covered size has halved as well.
+ ***********************************************************/
+int MeshManager::SelectLOD(const GL_MESH& glMesh)
+{
+	if ((m_bHasView == false) || (m_bPerspective == false))
+	{
+		return(0);
+	}
+
+	glm::vec3 center = glm::vec3(m_modelMatrix * glm::vec4((glMesh.boundsMin + glMesh.boundsMax) * 0.5f, 1.0f));
+	float scale = std::max(glm::length(glm::vec3(m_modelMatrix[0])),
+		std::max(glm::length(glm::vec3(m_modelMatrix[1])), glm::length(glm::vec3(m_modelMatrix[2]))));
+	float radius = glm::length(glMesh.boundsMax - glMesh.boundsMin) * 0.5f * scale;
+	float distance = glm::length(center - m_cameraPosition);
+	if (distance <= radius)
+	{
+		return(0);
+	}
+
+	float screenSize = radius * m_projectionScale / distance;
+	float level = std::log2(LOD_FULL_DETAIL_SCREEN_SIZE / std::max(screenSize, 1e-6f)) + m_lodBias;
+	int lod = (int)std::floor(level);
+	return(std::max(0, std::min(lod, glMesh.lodCount - 1)));
+}
+
+/***********************************************************
+ *  DrawVisibleMeshlets()
+ *
+ *  This method is used for drawing the meshlets of a mesh
+ *  that are inside the view frustum and not facing away
+ *  from the camera.  Neighboring visible meshlets occupy
+ *  neighboring index ranges, so they are merged into runs
+ *  and all runs are submitted with one multi-draw call.
+ ***********************************************************/
+void MeshManager::DrawVisibleMeshlets(const GL_MESH& glMesh)
+{
+	MeshletBuilder::CULLING_VIEW view;
+	MeshletBuilder::PrepareCullingView(m_modelMatrix, m_viewProjection, m_cameraPosition, m_bPerspective, view);
+
+	m_drawCounts.clear();
+	m_drawOffsets.clear();
+	uint32_t runEnd = 0xFFFFFFFF;
+
+	for (size_t i = 0; i < glMesh.meshlets.size(); i++)
+	{
+		const MESHLET& meshlet = glMesh.meshlets[i];
+		if (MeshletBuilder::IsMeshletCulled(meshlet, view))
+		{
+			continue;
+		}
+
+		if (meshlet.indexOffset == runEnd)
+		{
+			m_drawCounts.back() += (GLsizei)meshlet.indexCount;
+		}
+		else
+		{
+			m_drawCounts.push_back((GLsizei)meshlet.indexCount);
+			m_drawOffsets.push_back((const void*)(meshlet.indexOffset * sizeof(uint32_t)));
+		}
+		runEnd = meshlet.indexOffset + meshlet.indexCount;
+	}
+
+	if (m_drawCounts.empty() == false)
+	{
+		glMultiDrawElements(
+			GL_TRIANGLES,
+			m_drawCounts.data(),
+			GL_UNSIGNED_INT,
+			m_drawOffsets.data(),
+			(GLsizei)m_drawCounts.size());
+	}
+}
+
+/***********************************************************
+ *  DestroyMeshes()
+ *
+ *  This method is used for freeing the OpenGL buffers of
+ *  all the loaded meshes.
+ ***********************************************************/
+void MeshManager::DestroyMeshes()
+{
+	for (size_t index = 0; index < m_meshes.size(); index++)
+	{
+		GLStateCache::DeleteVertexArrays(1, &m_meshes[index].vao);
+		GLStateCache::DeleteBuffers(1, &m_meshes[index].vbo);
+		GLStateCache::DeleteBuffers(1, &m_meshes[index].ebo);
+	}
+	m_meshes.clear();
+}
@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshmanager.h
+// ============
+// manage the loading and drawing of the meshes in the 3D scene
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+#include "MeshCache.h"
+#include "UniformManager.h"
+#include "VertexPacking.h"
+#include "MeshletBuilder.h"
+#include "WorkerPool.h"
+
+#include <GL/glew.h>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  MeshManager
+ *
+ *  This class contains the code for preparing the meshes
+ *  that are drawn in the 3D scene.  The basic shapes are
+ *  read from the binary mesh cache when possible, and are
+ *  only generated (and then cached) when the cache entry
+ *  is missing or out of date.  Models made in other tools
+ *  can be loaded from OBJ and glTF files.
+ ***********************************************************/
+class MeshManager
+{
+public:
+	// constructor
+	MeshManager(UniformManager* pUniformManager);
+	// destructor
+	~MeshManager();
+
+	struct GL_MESH
+	{
+		std::string tag;
+		GLuint vao;
+		GLuint vbo;
+		GLuint ebo;
+		GLsizei nIndices;
+		bool bPacked;
+		VERTEX_DEQUANTIZE dequantize;
+		std::vector<MESHLET> meshlets;
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+		// level of detail, and the number of levels of the tag
+		int lod;
+		int lodCount;
+	};
+
+	// choose the vertex format for meshes loaded after this call
+	void SetPackedVertices(bool bPacked) { m_bPackedVertices = bPacked; }
+
+	// load the basic shape associated with the passed in tag
+	bool LoadMesh(std::string tag);
+	// load several basic shapes, generating them in parallel
+	bool LoadMeshes(const std::vector<std::string>& tags);
+	// load an OBJ or glTF model file as a mesh with the passed in tag
+	bool LoadModelMesh(std::string filename, std::string tag);
+	// get the object space bounds of a loaded mesh
+	bool GetMeshBounds(std::string tag, glm::vec3& boundsMin, glm::vec3& boundsMax);
+	// set the camera used for culling the meshlets of large meshes
+	void SetViewProjection(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		const glm::vec3& cameraPosition,
+		bool bPerspective);
+	// shift the level of detail selection, positive values
+	// switch to coarser levels closer to the camera
+	void SetLODBias(float bias) { m_lodBias = bias; }
+	// set the model matrix of the next drawn mesh
+	void SetModelMatrix(const glm::mat4& model) { m_modelMatrix = model; }
+	// draw a previously loaded mesh
+	void DrawMesh(std::string tag);
+	// free the OpenGL buffers of all the loaded meshes
+	void DestroyMeshes();
+
+private:
+	// the CPU side data of one mesh level that is prepared on a
+	// worker thread and then copied into OpenGL buffers
+	struct MESH_UPLOAD
+	{
+		std::string tag;
+		int lod;
+		int lodCount;
+		MESH_DATA mesh;
+		std::vector<MESH_VERTEX_PACKED> packedVertices;
+		VERTEX_DEQUANTIZE dequantize;
+		std::vector<MESHLET> meshlets;
+		bool bReady;
+	};
+
+	// pointer to uniform manager object
+	UniformManager* m_pUniformManager;
+	// handles of the uniforms for decoding packed vertices
+	int m_packedVerticesUniform;
+	int m_positionScaleUniform;
+	int m_positionOffsetUniform;
+	int m_textureCoordinateScaleUniform;
+	int m_textureCoordinateOffsetUniform;
+	// cache of the generated mesh data
+	MeshCache* m_pMeshCache;
+	// threads for parsing model files
+	WorkerPool* m_pWorkerPool;
+	// loaded meshes info
+	std::vector<GL_MESH> m_meshes;
+	// upload vertices in the compact packed format
+	bool m_bPackedVertices;
+	// at least one loaded mesh uses the packed format
+	bool m_bHasPackedMeshes;
+
+	// camera and model transform for meshlet culling
+	glm::mat4 m_viewProjection;
+	glm::vec3 m_cameraPosition;
+	bool m_bPerspective;
+	bool m_bHasView;
+	// vertical scale of the projection, for level of detail
+	float m_projectionScale;
+	float m_lodBias;
+	glm::mat4 m_modelMatrix;
+	// visible meshlet ranges gathered for one draw call
+	std::vector<GLsizei> m_drawCounts;
+	std::vector<const void*> m_drawOffsets;
+
+	// find a loaded mesh by tag and level of detail
+	int FindMesh(std::string tag, int lod = 0);
+	// read or generate one level of a basic shape
+	void PrepareMeshUpload(MESH_UPLOAD& upload);
+	// pack the vertices and build the meshlets of a mesh
+	void PrepareGPUData(MESH_UPLOAD& upload);
+	// copy the prepared mesh data into OpenGL buffers
+	bool CreateGLMesh(const MESH_UPLOAD& upload);
+	// choose the level of detail for drawing a mesh
+	int SelectLOD(const GL_MESH& glMesh);
+	// draw only the meshlets of a mesh that can be seen
+	void DrawVisibleMeshlets(const GL_MESH& glMesh);
+};
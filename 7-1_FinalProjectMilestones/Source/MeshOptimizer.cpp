@@ -0,0 +1,466 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.cpp
+// ============
+// reorder mesh indices and vertices for faster drawing on the GPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// size of the simulated post-transform vertex cache
+	const int VERTEX_CACHE_SIZE = 16;
+	// allowed ACMR increase when splitting clusters for overdraw
+	const float OVERDRAW_THRESHOLD = 1.05f;
+
+	/***********************************************************
+	 *  TRIANGLE_ADJACENCY
+	 *
+	 *  The triangles that use each vertex, stored as offsets
+	 *  into one shared triangle list.
+	 ***********************************************************/
+	struct TRIANGLE_ADJACENCY
+	{
+		std::vector<uint32_t> counts;
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> triangles;
+	};
+
+	/***********************************************************
+	 *  BuildAdjacency()
+	 *
+	 *  Build the list of triangles that use each vertex.
+	 ***********************************************************/
+	void BuildAdjacency(
+		const std::vector<uint32_t>& indices,
+		size_t vertexCount,
+		TRIANGLE_ADJACENCY& adjacency)
+	{
+		adjacency.counts.assign(vertexCount, 0);
+		adjacency.offsets.assign(vertexCount, 0);
+		adjacency.triangles.resize(indices.size());
+
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			adjacency.counts[indices[i]]++;
+		}
+
+		uint32_t offset = 0;
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			adjacency.offsets[v] = offset;
+			offset += adjacency.counts[v];
+		}
+
+		std::vector<uint32_t> fill(adjacency.offsets);
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			adjacency.triangles[fill[indices[i]]++] = (uint32_t)(i / 3);
+		}
+	}
+
+	/***********************************************************
+	 *  SimulateTriangle()
+	 *
+	 *  Count the cache misses of one triangle in a cache that
+	 *  is approximated with per vertex time stamps.
+	 ***********************************************************/
+	unsigned int SimulateTriangle(
+		const uint32_t* triangle,
+		std::vector<unsigned int>& timestamps,
+		unsigned int& time)
+	{
+		unsigned int misses = 0;
+
+		for (int corner = 0; corner < 3; corner++)
+		{
+			uint32_t v = triangle[corner];
+			if (time - timestamps[v] > (unsigned int)VERTEX_CACHE_SIZE)
+			{
+				timestamps[v] = time++;
+				misses++;
+			}
+		}
+
+		return(misses);
+	}
+}
+
+/***********************************************************
+ *  OptimizeMesh()
+ *
+ *  This method is used for running the vertex cache,
+ *  overdraw and vertex fetch passes on a mesh, and then
+ *  reporting the ACMR of the mesh before and after.
+ ***********************************************************/
+void MeshOptimizer::OptimizeMesh(MESH_DATA& mesh, std::string name)
+{
+	if (mesh.indices.size() < 3)
+	{
+		return;
+	}
+
+	float acmrBefore = CalculateACMR(mesh.indices, mesh.vertices.size(), VERTEX_CACHE_SIZE);
+
+	std::vector<uint32_t> clusters;
+	OptimizeVertexCache(mesh.indices, mesh.vertices.size(), &clusters);
+	OptimizeOverdraw(mesh.indices, mesh.vertices, clusters, OVERDRAW_THRESHOLD);
+	OptimizeVertexFetch(mesh);
+
+	float acmrAfter = CalculateACMR(mesh.indices, mesh.vertices.size(), VERTEX_CACHE_SIZE);
+
+	// meshes can be optimized on worker threads, so the line is
+	// written with one call to keep it from being interleaved
+	std::ostringstream message;
+	message << "Optimized mesh " << name << ": " << (mesh.indices.size() / 3) << " triangles, ACMR "
+		<< acmrBefore << " -> " << acmrAfter << "\n";
+	std::cout << message.str() << std::flush;
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  This method is used for reordering the triangles with
+ *  the Tipsify algorithm (Sander, Nehab and Barczak 2007).
+ *  Triangles are emitted as fans around a vertex, and the
+ *  next fan is chosen among the vertices that are still in
+ *  the cache.  When no such vertex exists the walk restarts
+ *  elsewhere, and each restart begins a new cluster.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexCache(
+	std::vector<uint32_t>& indices,
+	size_t vertexCount,
+	std::vector<uint32_t>* pClusters)
+{
+	size_t triangleCount = indices.size() / 3;
+	if ((triangleCount == 0) || (vertexCount == 0))
+	{
+		return;
+	}
+
+	TRIANGLE_ADJACENCY adjacency;
+	BuildAdjacency(indices, vertexCount, adjacency);
+
+	// number of triangles not yet emitted per vertex
+	std::vector<uint32_t> liveTriangles(adjacency.counts);
+	// time stamp of when each vertex entered the cache
+	std::vector<unsigned int> cacheTime(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+
+	const unsigned int cacheSize = (unsigned int)VERTEX_CACHE_SIZE;
+	unsigned int time = cacheSize + 1;
+	size_t cursor = 0;
+	int fanVertex = 0;
+
+	if (pClusters != NULL)
+	{
+		pClusters->clear();
+		pClusters->push_back(0);
+	}
+
+	while (fanVertex >= 0)
+	{
+		candidates.clear();
+
+		// emit all remaining triangles around the fan vertex
+		uint32_t begin = adjacency.offsets[fanVertex];
+		uint32_t end = begin + adjacency.counts[fanVertex];
+		for (uint32_t a = begin; a < end; a++)
+		{
+			uint32_t triangle = adjacency.triangles[a];
+			if (emitted[triangle])
+			{
+				continue;
+			}
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+				uint32_t v = indices[(triangle * 3) + corner];
+				output.push_back(v);
+				deadEnds.push_back(v);
+				candidates.push_back(v);
+				liveTriangles[v]--;
+				if (time - cacheTime[v] > cacheSize)
+				{
+					cacheTime[v] = time++;
+				}
+			}
+			emitted[triangle] = true;
+		}
+
+		// pick the candidate that will still be in the cache
+		// after its remaining triangles are emitted
+		int nextVertex = -1;
+		int bestPriority = -1;
+		for (size_t c = 0; c < candidates.size(); c++)
+		{
+			uint32_t v = candidates[c];
+			if (liveTriangles[v] == 0)
+			{
+				continue;
+			}
+
+			int priority = 0;
+			if (time - cacheTime[v] + (2 * liveTriangles[v]) <= cacheSize)
+			{
+				priority = (int)(time - cacheTime[v]);
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				nextVertex = (int)v;
+			}
+		}
+
+		// otherwise restart from a recently used vertex, or
+		// from the next vertex in input order
+		if (nextVertex == -1)
+		{
+			while ((nextVertex == -1) && (deadEnds.empty() == false))
+			{
+				uint32_t v = deadEnds.back();
+				deadEnds.pop_back();
+				if (liveTriangles[v] > 0)
+				{
+					nextVertex = (int)v;
+				}
+			}
+			while ((nextVertex == -1) && (cursor < vertexCount))
+			{
+				if (liveTriangles[cursor] > 0)
+				{
+					nextVertex = (int)cursor;
+				}
+				cursor++;
+			}
+
+			if ((nextVertex != -1) && (pClusters != NULL) && (output.size() / 3 > pClusters->back()))
+			{
+				pClusters->push_back((uint32_t)(output.size() / 3));
+			}
+		}
+
+		fanVertex = nextVertex;
+	}
+
+	indices.swap(output);
+}
+
+/***********************************************************
+ *  OptimizeOverdraw()
+ *
+ *  This method is used for reordering clusters of triangles
+ *  so that triangles that are likely to hide others are
+ *  drawn first, based on the view independent method of
+ *  Sander, Nehab and Barczak.  The hard clusters from the
+ *  vertex cache pass are split further while the ACMR stays
+ *  within the threshold, and the clusters are then sorted
+ *  by how far they face out from the center of the mesh.
+ ***********************************************************/
+void MeshOptimizer::OptimizeOverdraw(
+	std::vector<uint32_t>& indices,
+	const std::vector<MESH_VERTEX>& vertices,
+	const std::vector<uint32_t>& hardClusters,
+	float threshold)
+{
+	size_t triangleCount = indices.size() / 3;
+	if ((triangleCount == 0) || (hardClusters.empty()))
+	{
+		return;
+	}
+
+	// split the hard clusters into smaller soft clusters
+	std::vector<uint32_t> clusters;
+	std::vector<unsigned int> timestamps(vertices.size(), 0);
+	unsigned int time = 0;
+
+	for (size_t h = 0; h < hardClusters.size(); h++)
+	{
+		uint32_t start = hardClusters[h];
+		uint32_t end = (h + 1 < hardClusters.size()) ? hardClusters[h + 1] : (uint32_t)triangleCount;
+
+		// ACMR of the whole hard cluster from a cold cache
+		time += VERTEX_CACHE_SIZE + 1;
+		unsigned int clusterMisses = 0;
+		for (uint32_t t = start; t < end; t++)
+		{
+			clusterMisses += SimulateTriangle(&indices[t * 3], timestamps, time);
+		}
+		float clusterACMR = (float)clusterMisses / (float)(end - start);
+
+		clusters.push_back(start);
+		time += VERTEX_CACHE_SIZE + 1;
+		unsigned int misses = 0;
+		uint32_t count = 0;
+		for (uint32_t t = start; t < end; t++)
+		{
+			misses += SimulateTriangle(&indices[t * 3], timestamps, time);
+			count++;
+
+			if ((t + 1 < end) && ((float)misses / (float)count <= clusterACMR * threshold))
+			{
+				clusters.push_back(t + 1);
+				time += VERTEX_CACHE_SIZE + 1;
+				misses = 0;
+				count = 0;
+			}
+		}
+	}
+
+	// centroid of the whole mesh
+	double meshCenter[3] = { 0.0, 0.0, 0.0 };
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			meshCenter[axis] += vertices[indices[i]].position[axis];
+		}
+	}
+	for (int axis = 0; axis < 3; axis++)
+	{
+		meshCenter[axis] /= (double)indices.size();
+	}
+
+	// sort key - how far each cluster faces away from the center
+	std::vector<float> sortKeys(clusters.size());
+	for (size_t c = 0; c < clusters.size(); c++)
+	{
+		uint32_t start = clusters[c];
+		uint32_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : (uint32_t)triangleCount;
+		float center[3] = { 0.0f, 0.0f, 0.0f };
+		float normal[3] = { 0.0f, 0.0f, 0.0f };
+		float totalArea = 0.0f;
+
+		for (uint32_t t = start; t < end; t++)
+		{
+			const float* p0 = vertices[indices[(t * 3) + 0]].position;
+			const float* p1 = vertices[indices[(t * 3) + 1]].position;
+			const float* p2 = vertices[indices[(t * 3) + 2]].position;
+			float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float n[3] =
+			{
+				(e1[1] * e2[2]) - (e1[2] * e2[1]),
+				(e1[2] * e2[0]) - (e1[0] * e2[2]),
+				(e1[0] * e2[1]) - (e1[1] * e2[0])
+			};
+			float area = std::sqrt((n[0] * n[0]) + (n[1] * n[1]) + (n[2] * n[2]));
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				center[axis] += area * (p0[axis] + p1[axis] + p2[axis]) / 3.0f;
+				normal[axis] += n[axis];
+			}
+			totalArea += area;
+		}
+
+		float key = 0.0f;
+		float normalLength = std::sqrt((normal[0] * normal[0]) + (normal[1] * normal[1]) + (normal[2] * normal[2]));
+		if ((totalArea > 0.0f) && (normalLength > 0.0f))
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				key += ((center[axis] / totalArea) - (float)meshCenter[axis]) * (normal[axis] / normalLength);
+			}
+		}
+		sortKeys[c] = key;
+	}
+
+	std::vector<uint32_t> order(clusters.size());
+	for (size_t c = 0; c < order.size(); c++)
+	{
+		order[c] = (uint32_t)c;
+	}
+	std::stable_sort(order.begin(), order.end(),
+		[&sortKeys](uint32_t a, uint32_t b) { return(sortKeys[a] > sortKeys[b]); });
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	for (size_t o = 0; o < order.size(); o++)
+	{
+		uint32_t c = order[o];
+		uint32_t start = clusters[c];
+		uint32_t end = (c + 1 < clusters.size()) ? clusters[c + 1] : (uint32_t)triangleCount;
+		output.insert(output.end(), indices.begin() + (start * 3), indices.begin() + (end * 3));
+	}
+
+	indices.swap(output);
+}
+
+/***********************************************************
+ *  OptimizeVertexFetch()
+ *
+ *  This method is used for reordering the vertices into
+ *  the order in which the triangles first reference them,
+ *  so that vertex fetches walk through memory in order.
+ *  Vertices that are not used by any triangle are removed.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexFetch(MESH_DATA& mesh)
+{
+	const uint32_t unused = 0xFFFFFFFF;
+	std::vector<uint32_t> remap(mesh.vertices.size(), unused);
+	std::vector<MESH_VERTEX> vertices;
+	vertices.reserve(mesh.vertices.size());
+
+	for (size_t i = 0; i < mesh.indices.size(); i++)
+	{
+		uint32_t v = mesh.indices[i];
+		if (remap[v] == unused)
+		{
+			remap[v] = (uint32_t)vertices.size();
+			vertices.push_back(mesh.vertices[v]);
+		}
+		mesh.indices[i] = remap[v];
+	}
+
+	mesh.vertices.swap(vertices);
+}
+
+/***********************************************************
+ *  CalculateACMR()
+ *
+ *  This method is used for calculating the average cache
+ *  miss ratio - the number of vertex shader invocations
+ *  per triangle - with a FIFO cache of the passed in size.
+ *  Lower is better, with 0.5 as the ideal for large meshes.
+ ***********************************************************/
+float MeshOptimizer::CalculateACMR(
+	const std::vector<uint32_t>& indices,
+	size_t vertexCount,
+	int cacheSize)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return(0.0f);
+	}
+
+	// the FIFO position at which each vertex was last added
+	std::vector<size_t> insertedAt(vertexCount, 0);
+	std::vector<bool> everCached(vertexCount, false);
+	size_t fifoPosition = 0;
+	size_t misses = 0;
+
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		uint32_t v = indices[i];
+		if ((everCached[v] == false) || (fifoPosition - insertedAt[v] >= (size_t)cacheSize))
+		{
+			insertedAt[v] = fifoPosition++;
+			everCached[v] = true;
+			misses++;
+		}
+	}
+
+	return((float)misses / (float)triangleCount);
+}
@@ -0,0 +1,50 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.h
+// ============
+// reorder mesh indices and vertices for faster drawing on the GPU
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  MeshOptimizer
+ *
+ *  This class contains the code for optimizing the order of
+ *  the triangles and vertices in a mesh.  The triangles are
+ *  reordered for the post-transform vertex cache and then
+ *  for less overdraw, and the vertices are reordered into
+ *  the order in which the triangles first use them.  None
+ *  of the passes change how the mesh looks.
+ ***********************************************************/
+class MeshOptimizer
+{
+public:
+	// run all of the passes and report the results
+	static void OptimizeMesh(MESH_DATA& mesh, std::string name);
+
+	// reorder triangles for the post-transform vertex cache,
+	// optionally returning the first triangle of each cluster
+	static void OptimizeVertexCache(
+		std::vector<uint32_t>& indices,
+		size_t vertexCount,
+		std::vector<uint32_t>* pClusters);
+	// reorder clusters of triangles to draw likely occluders first
+	static void OptimizeOverdraw(
+		std::vector<uint32_t>& indices,
+		const std::vector<MESH_VERTEX>& vertices,
+		const std::vector<uint32_t>& hardClusters,
+		float threshold);
+	// reorder vertices into the order they are first used
+	static void OptimizeVertexFetch(MESH_DATA& mesh);
+
+	// average number of vertex cache misses per triangle
+	static float CalculateACMR(
+		const std::vector<uint32_t>& indices,
+		size_t vertexCount,
+		int cacheSize);
+};
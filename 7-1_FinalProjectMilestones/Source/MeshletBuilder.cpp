@@ -0,0 +1,263 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshletbuilder.cpp
+// ============
+// split meshes into meshlets and cull them against the view
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	/***********************************************************
+	 *  ComputeMeshletBounds()
+	 *
+	 *  Calculate the bounding sphere and the normal cone of the
+	 *  triangles in one meshlet.  When the triangle normals
+	 *  spread over more than a half sphere the cone cutoff is
+	 *  left at 1 so that the meshlet is never cone culled.
+	 ***********************************************************/
+	void ComputeMeshletBounds(const MESH_DATA& mesh, MESHLET& meshlet)
+	{
+		glm::vec3 minimum(FLT_MAX);
+		glm::vec3 maximum(-FLT_MAX);
+		glm::vec3 axis(0.0f);
+		std::vector<glm::vec3> normals;
+		normals.reserve(meshlet.indexCount / 3);
+
+		for (uint32_t i = 0; i < meshlet.indexCount; i += 3)
+		{
+			const float* p0 = mesh.vertices[mesh.indices[meshlet.indexOffset + i + 0]].position;
+			const float* p1 = mesh.vertices[mesh.indices[meshlet.indexOffset + i + 1]].position;
+			const float* p2 = mesh.vertices[mesh.indices[meshlet.indexOffset + i + 2]].position;
+			glm::vec3 a(p0[0], p0[1], p0[2]);
+			glm::vec3 b(p1[0], p1[1], p1[2]);
+			glm::vec3 c(p2[0], p2[1], p2[2]);
+
+			minimum = glm::min(minimum, glm::min(a, glm::min(b, c)));
+			maximum = glm::max(maximum, glm::max(a, glm::max(b, c)));
+
+			glm::vec3 normal = glm::cross(b - a, c - a);
+			float area = glm::length(normal);
+			normal = (area > 0.0f) ? (normal / area) : glm::vec3(0.0f);
+			normals.push_back(normal);
+			axis += normal;
+		}
+
+		glm::vec3 center = (minimum + maximum) * 0.5f;
+		float radius = 0.0f;
+		for (uint32_t i = 0; i < meshlet.indexCount; i++)
+		{
+			const float* p = mesh.vertices[mesh.indices[meshlet.indexOffset + i]].position;
+			radius = std::max(radius, glm::length(glm::vec3(p[0], p[1], p[2]) - center));
+		}
+
+		meshlet.center[0] = center.x;
+		meshlet.center[1] = center.y;
+		meshlet.center[2] = center.z;
+		meshlet.radius = radius;
+		meshlet.coneCutoff = 1.0f;
+		meshlet.coneApex[0] = center.x;
+		meshlet.coneApex[1] = center.y;
+		meshlet.coneApex[2] = center.z;
+		meshlet.coneAxis[0] = 0.0f;
+		meshlet.coneAxis[1] = 0.0f;
+		meshlet.coneAxis[2] = 0.0f;
+
+		float axisLength = glm::length(axis);
+		if (axisLength <= 0.0f)
+		{
+			return;
+		}
+		axis /= axisLength;
+
+		// the widest angle between the axis and a triangle normal
+		float minimumDot = 1.0f;
+		for (size_t t = 0; t < normals.size(); t++)
+		{
+			minimumDot = std::min(minimumDot, glm::dot(normals[t], axis));
+		}
+		if (minimumDot <= 0.1f)
+		{
+			return;
+		}
+
+		// move the apex back along the axis until it lies behind
+		// the plane of every triangle in the meshlet
+		float maximumT = 0.0f;
+		for (size_t t = 0; t < normals.size(); t++)
+		{
+			const float* p = mesh.vertices[mesh.indices[meshlet.indexOffset + (t * 3)]].position;
+			float distance = glm::dot(center - glm::vec3(p[0], p[1], p[2]), normals[t]);
+			float alignment = glm::dot(axis, normals[t]);
+			maximumT = std::max(maximumT, distance / alignment);
+		}
+		glm::vec3 apex = center - (axis * maximumT);
+
+		meshlet.coneApex[0] = apex.x;
+		meshlet.coneApex[1] = apex.y;
+		meshlet.coneApex[2] = apex.z;
+		meshlet.coneAxis[0] = axis.x;
+		meshlet.coneAxis[1] = axis.y;
+		meshlet.coneAxis[2] = axis.z;
+		meshlet.coneCutoff = std::sqrt(1.0f - (minimumDot * minimumDot));
+	}
+}
+
+/***********************************************************
+ *  BuildMeshlets()
+ *
+ *  This method is used for splitting the index list into
+ *  meshlets.  Triangles are taken in index order, which the
+ *  mesh optimizer has already arranged for locality, and a
+ *  new meshlet is started whenever the next triangle would
+ *  exceed the vertex or triangle limit.
+ ***********************************************************/
+void MeshletBuilder::BuildMeshlets(
+	const MESH_DATA& mesh,
+	std::vector<MESHLET>& meshlets,
+	size_t maxVertices,
+	size_t maxTriangles)
+{
+	meshlets.clear();
+	if ((mesh.indices.size() < 3) || (maxVertices < 3) || (maxTriangles < 1))
+	{
+		return;
+	}
+
+	// the meshlet number that last used each vertex
+	std::vector<uint32_t> lastMeshlet(mesh.vertices.size(), 0xFFFFFFFF);
+	MESHLET meshlet = {};
+	size_t vertexCount = 0;
+
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+	{
+		uint32_t current = (uint32_t)meshlets.size();
+		size_t newVertices = 0;
+		for (int corner = 0; corner < 3; corner++)
+		{
+			if (lastMeshlet[mesh.indices[i + corner]] != current)
+			{
+				newVertices++;
+			}
+		}
+
+		if ((meshlet.indexCount > 0) &&
+			((vertexCount + newVertices > maxVertices) || ((meshlet.indexCount / 3) + 1 > maxTriangles)))
+		{
+			ComputeMeshletBounds(mesh, meshlet);
+			meshlets.push_back(meshlet);
+
+			meshlet = MESHLET();
+			meshlet.indexOffset = (uint32_t)i;
+			vertexCount = 0;
+			current = (uint32_t)meshlets.size();
+		}
+
+		for (int corner = 0; corner < 3; corner++)
+		{
+			uint32_t v = mesh.indices[i + corner];
+			if (lastMeshlet[v] != current)
+			{
+				lastMeshlet[v] = current;
+				vertexCount++;
+			}
+		}
+		meshlet.indexCount += 3;
+	}
+
+	if (meshlet.indexCount > 0)
+	{
+		ComputeMeshletBounds(mesh, meshlet);
+		meshlets.push_back(meshlet);
+	}
+}
+
+/***********************************************************
+ *  PrepareCullingView()
+ *
+ *  This method is used for moving the camera position and
+ *  the frustum planes into the object space of a mesh.  The
+ *  planes are extracted from the combined model, view and
+ *  projection matrix.  Cone culling is only allowed for
+ *  perspective views with a model matrix that does not
+ *  mirror the mesh, since mirroring flips triangle facing.
+ ***********************************************************/
+void MeshletBuilder::PrepareCullingView(
+	const glm::mat4& model,
+	const glm::mat4& viewProjection,
+	const glm::vec3& cameraPosition,
+	bool bPerspective,
+	CULLING_VIEW& view)
+{
+	glm::mat4 clip = viewProjection * model;
+
+	// rows of the clip matrix, since GLM matrices are column major
+	glm::vec4 rows[4];
+	for (int r = 0; r < 4; r++)
+	{
+		rows[r] = glm::vec4(clip[0][r], clip[1][r], clip[2][r], clip[3][r]);
+	}
+
+	view.frustumPlanes[0] = rows[3] + rows[0];
+	view.frustumPlanes[1] = rows[3] - rows[0];
+	view.frustumPlanes[2] = rows[3] + rows[1];
+	view.frustumPlanes[3] = rows[3] - rows[1];
+	view.frustumPlanes[4] = rows[3] + rows[2];
+	view.frustumPlanes[5] = rows[3] - rows[2];
+
+	// normalize so plane distances are in object space units
+	for (int p = 0; p < 6; p++)
+	{
+		float length = glm::length(glm::vec3(view.frustumPlanes[p]));
+		if (length > 0.0f)
+		{
+			view.frustumPlanes[p] = view.frustumPlanes[p] / length;
+		}
+	}
+
+	view.cameraPosition = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.0f));
+	view.bConeCulling = bPerspective && (glm::determinant(glm::mat3(model)) > 0.0f);
+}
+
+/***********************************************************
+ *  IsMeshletCulled()
+ *
+ *  This method is used for testing a meshlet against the
+ *  frustum planes and, when allowed, against its normal
+ *  cone.  The cone test culls a meshlet when the camera is
+ *  inside the cone behind the apex, where every triangle
+ *  of the meshlet is seen from its back.
+ ***********************************************************/
+bool MeshletBuilder::IsMeshletCulled(const MESHLET& meshlet, const CULLING_VIEW& view)
+{
+	glm::vec3 center(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+
+	for (int p = 0; p < 6; p++)
+	{
+		const glm::vec4& plane = view.frustumPlanes[p];
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -meshlet.radius)
+		{
+			return(true);
+		}
+	}
+
+	if ((view.bConeCulling) && (meshlet.coneCutoff < 1.0f))
+	{
+		glm::vec3 apex(meshlet.coneApex[0], meshlet.coneApex[1], meshlet.coneApex[2]);
+		glm::vec3 axis(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]);
+		glm::vec3 direction = apex - view.cameraPosition;
+		float distance = glm::length(direction);
+
+		if ((distance > 0.0f) && (glm::dot(direction / distance, axis) >= meshlet.coneCutoff))
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
@@ -0,0 +1,52 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshletbuilder.h
+// ============
+// split meshes into meshlets and cull them against the view
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  MeshletBuilder
+ *
+ *  This class contains the code for splitting the index
+ *  list of a mesh into meshlets, and for deciding which
+ *  meshlets can be seen from a camera.  Culling is done in
+ *  the object space of the mesh, so it stays exact for any
+ *  model matrix, including non-uniform scaling.
+ ***********************************************************/
+class MeshletBuilder
+{
+public:
+	// split the triangles of a mesh into meshlets
+	static void BuildMeshlets(
+		const MESH_DATA& mesh,
+		std::vector<MESHLET>& meshlets,
+		size_t maxVertices,
+		size_t maxTriangles);
+
+	// the view of a camera expressed in a mesh's object space
+	struct CULLING_VIEW
+	{
+		glm::vec4 frustumPlanes[6];
+		glm::vec3 cameraPosition;
+		bool bConeCulling;
+	};
+
+	// convert the camera and frustum into object space
+	static void PrepareCullingView(
+		const glm::mat4& model,
+		const glm::mat4& viewProjection,
+		const glm::vec3& cameraPosition,
+		bool bPerspective,
+		CULLING_VIEW& view);
+
+	// true when no part of the meshlet can be seen
+	static bool IsMeshletCulled(const MESHLET& meshlet, const CULLING_VIEW& view);
+};
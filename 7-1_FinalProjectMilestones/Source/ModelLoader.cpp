@@ -0,0 +1,1847 @@
+///////////////////////////////////////////////////////////////////////////////
+// modelloader.cpp
+// ============
+// read external OBJ and glTF model files into mesh data
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ModelLoader.h"
+#include "MappedFile.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+
+// declaration of global variables and helper functions
+namespace
+{
+	// OBJ files are split into chunks of at least this many
+	// bytes, so small files are not spread over every thread
+	const size_t OBJ_MIN_CHUNK_SIZE = 1 << 20;
+	// corners and vertices are processed in blocks of this size
+	const size_t PARALLEL_BLOCK_SIZE = 1 << 16;
+	// index value of a missing texture coordinate or normal
+	const int32_t OBJ_NO_INDEX = -1;
+	// value count of the position, texture coordinate and
+	// normal attributes of an OBJ file
+	const size_t OBJ_COMPONENTS[3] = { 3, 2, 3 };
+	// empty slot of the vertex hash tables
+	const uint32_t EMPTY_SLOT = 0xFFFFFFFF;
+
+	// deepest node hierarchy followed in a glTF scene
+	const int GLTF_MAX_NODE_DEPTH = 64;
+	// the only glTF primitive mode that is loaded
+	const int GLTF_MODE_TRIANGLES = 4;
+	// magic values of the binary glTF container
+	const uint32_t GLB_MAGIC = 0x46546C67;
+	const uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+	const uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+	/***********************************************************
+	 *  OBJ_CORNER
+	 *
+	 *  The indices of one face corner of an OBJ file.  Negative
+	 *  indices in the file count back from the end of the
+	 *  values read so far, so while a chunk is being parsed they
+	 *  are stored relative to the start of the chunk and marked
+	 *  in the relative mask until the chunk offsets are known.
+	 ***********************************************************/
+	struct OBJ_CORNER
+	{
+		int32_t index[3];
+		uint32_t relativeMask;
+	};
+
+	/***********************************************************
+	 *  OBJ_CHUNK
+	 *
+	 *  A range of whole lines of an OBJ file and the values
+	 *  that were parsed from it.
+	 ***********************************************************/
+	struct OBJ_CHUNK
+	{
+		const char* pBegin;
+		const char* pEnd;
+		std::vector<float> attributes[3];
+		std::vector<OBJ_CORNER> corners;
+		size_t badFaces;
+	};
+
+	/***********************************************************
+	 *  JSON_VALUE
+	 *
+	 *  One node of a parsed JSON document.  Arrays keep their
+	 *  values in elements, and objects keep their member values
+	 *  in elements with the member names at the same positions.
+	 ***********************************************************/
+	struct JSON_VALUE
+	{
+		enum TYPE { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+
+		TYPE type = JSON_NULL;
+		double number = 0.0;
+		std::string text;
+		std::vector<JSON_VALUE> elements;
+		std::vector<std::string> names;
+	};
+
+	/***********************************************************
+	 *  GLTF_BUFFER
+	 *
+	 *  The bytes of one glTF buffer, which point into a mapped
+	 *  file or into decoded base64 data.
+	 ***********************************************************/
+	struct GLTF_BUFFER
+	{
+		const unsigned char* pData;
+		size_t size;
+	};
+
+	/***********************************************************
+	 *  GLTF_DOCUMENT
+	 *
+	 *  A parsed glTF file along with its loaded buffers and the
+	 *  storage that keeps the buffer bytes alive.
+	 ***********************************************************/
+	struct GLTF_DOCUMENT
+	{
+		JSON_VALUE root;
+		std::vector<GLTF_BUFFER> buffers;
+		std::vector<std::unique_ptr<MappedFile>> mappedFiles;
+		std::vector<std::vector<unsigned char>> decodedBuffers;
+	};
+
+	/***********************************************************
+	 *  GLTF_PRIMITIVE_INSTANCE
+	 *
+	 *  A triangle primitive of a glTF mesh placed in the scene
+	 *  by the world transform of the node that references it.
+	 ***********************************************************/
+	struct GLTF_PRIMITIVE_INSTANCE
+	{
+		const JSON_VALUE* pPrimitive;
+		glm::mat4 transform;
+	};
+
+	/***********************************************************
+	 *  RunTasks()
+	 *
+	 *  Run the task for every index on the worker pool, or on
+	 *  the calling thread when there is no pool.
+	 ***********************************************************/
+	void RunTasks(WorkerPool* pWorkerPool, size_t count, const std::function<void(size_t)>& task)
+	{
+		if (NULL != pWorkerPool)
+		{
+			pWorkerPool->ParallelFor(count, task);
+		}
+		else
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				task(i);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  MixHash()
+	 *
+	 *  Scramble the bits of a 64-bit value so that nearby keys
+	 *  are spread over the whole hash table.
+	 ***********************************************************/
+	inline uint64_t MixHash(uint64_t value)
+	{
+		value ^= value >> 30;
+		value *= 0xBF58476D1CE4E5B9ULL;
+		value ^= value >> 27;
+		value *= 0x94D049BB133111EBULL;
+		value ^= value >> 31;
+		return(value);
+	}
+
+	/***********************************************************
+	 *  GetTableSize()
+	 *
+	 *  Get a power of two hash table size that stays at most
+	 *  half full for the passed in number of keys.
+	 ***********************************************************/
+	size_t GetTableSize(size_t keyCount)
+	{
+		size_t tableSize = 16;
+		while (tableSize < keyCount * 2)
+		{
+			tableSize *= 2;
+		}
+		return(tableSize);
+	}
+
+	/***********************************************************
+	 *  DeduplicateVertices()
+	 *
+	 *  Merge the vertices of the mesh that have identical
+	 *  values and remap the indices to the merged vertices.
+	 ***********************************************************/
+	void DeduplicateVertices(MESH_DATA& mesh)
+	{
+		size_t tableSize = GetTableSize(mesh.vertices.size());
+		size_t mask = tableSize - 1;
+		std::vector<uint32_t> table(tableSize, EMPTY_SLOT);
+		std::vector<uint32_t> remap(mesh.vertices.size());
+		std::vector<MESH_VERTEX> uniqueVertices;
+		uniqueVertices.reserve(mesh.vertices.size());
+
+		for (size_t i = 0; i < mesh.vertices.size(); i++)
+		{
+			const MESH_VERTEX& vertex = mesh.vertices[i];
+
+			uint32_t words[sizeof(MESH_VERTEX) / sizeof(uint32_t)];
+			memcpy(words, &vertex, sizeof(MESH_VERTEX));
+			uint64_t hash = 0;
+			for (size_t w = 0; w < sizeof(words) / sizeof(words[0]); w++)
+			{
+				hash = MixHash(hash ^ words[w]);
+			}
+
+			size_t slot = hash & mask;
+			for (;;)
+			{
+				uint32_t entry = table[slot];
+				if (entry == EMPTY_SLOT)
+				{
+					table[slot] = (uint32_t)uniqueVertices.size();
+					remap[i] = (uint32_t)uniqueVertices.size();
+					uniqueVertices.push_back(vertex);
+					break;
+				}
+				if (memcmp(&uniqueVertices[entry], &vertex, sizeof(MESH_VERTEX)) == 0)
+				{
+					remap[i] = entry;
+					break;
+				}
+				slot = (slot + 1) & mask;
+			}
+		}
+
+		for (size_t i = 0; i < mesh.indices.size(); i++)
+		{
+			mesh.indices[i] = remap[mesh.indices[i]];
+		}
+		mesh.vertices.swap(uniqueVertices);
+	}
+
+	/***********************************************************
+	 *  GetFileExtension()
+	 *
+	 *  Get the lowercase extension of a file name, including
+	 *  the leading dot.
+	 ***********************************************************/
+	std::string GetFileExtension(const std::string& filename)
+	{
+		std::string extension = std::filesystem::path(filename).extension().string();
+		for (size_t i = 0; i < extension.size(); i++)
+		{
+			extension[i] = (char)tolower((unsigned char)extension[i]);
+		}
+		return(extension);
+	}
+
+	/***********************************************************
+	 *  SkipSpaces()
+	 *
+	 *  Skip the spaces, tabs and carriage returns on a line.
+	 ***********************************************************/
+	inline const char* SkipSpaces(const char* p, const char* pEnd)
+	{
+		while ((p < pEnd) && ((*p == ' ') || (*p == '\t') || (*p == '\r')))
+		{
+			p++;
+		}
+		return(p);
+	}
+
+	/***********************************************************
+	 *  ParseFloat()
+	 *
+	 *  Parse a floating point value after optional spaces.
+	 *  NULL is returned when no number could be read.
+	 ***********************************************************/
+	inline const char* ParseFloat(const char* p, const char* pEnd, float& value)
+	{
+		p = SkipSpaces(p, pEnd);
+		// from_chars() does not accept a leading plus sign
+		if ((p < pEnd) && (*p == '+'))
+		{
+			p++;
+		}
+
+		std::from_chars_result result = std::from_chars(p, pEnd, value);
+		if (result.ec == std::errc::result_out_of_range)
+		{
+			// values too small for a float are read as zero
+			value = 0.0f;
+		}
+		else if (result.ec != std::errc())
+		{
+			return(NULL);
+		}
+		return(result.ptr);
+	}
+
+	/***********************************************************
+	 *  ParseIndex()
+	 *
+	 *  Parse a signed integer index.  NULL is returned when no
+	 *  digits could be read.
+	 ***********************************************************/
+	inline const char* ParseIndex(const char* p, const char* pEnd, int64_t& value)
+	{
+		bool bNegative = false;
+		if ((p < pEnd) && ((*p == '-') || (*p == '+')))
+		{
+			bNegative = (*p == '-');
+			p++;
+		}
+
+		const char* pDigits = p;
+		int64_t result = 0;
+		while ((p < pEnd) && (*p >= '0') && (*p <= '9'))
+		{
+			// stop growing once the value is out of range anyway
+			if (result < 0x100000000LL)
+			{
+				result = result * 10 + (*p - '0');
+			}
+			p++;
+		}
+		if (p == pDigits)
+		{
+			return(NULL);
+		}
+
+		value = bNegative ? -result : result;
+		return(p);
+	}
+
+	/***********************************************************
+	 *  ParseOBJFace()
+	 *
+	 *  Parse the corners of an OBJ face line and add the face
+	 *  to the chunk, split into a fan of triangles.
+	 ***********************************************************/
+	void ParseOBJFace(const char* p, const char* pLineEnd, OBJ_CHUNK& chunk, std::vector<OBJ_CORNER>& polygon)
+	{
+		int64_t counts[3];
+		for (int component = 0; component < 3; component++)
+		{
+			counts[component] = (int64_t)(chunk.attributes[component].size() / OBJ_COMPONENTS[component]);
+		}
+
+		polygon.clear();
+		for (;;)
+		{
+			p = SkipSpaces(p, pLineEnd);
+			if ((p >= pLineEnd) || (*p == '#'))
+			{
+				break;
+			}
+
+			// corners are written as v, v/vt, v//vn or v/vt/vn
+			OBJ_CORNER corner;
+			corner.index[0] = OBJ_NO_INDEX;
+			corner.index[1] = OBJ_NO_INDEX;
+			corner.index[2] = OBJ_NO_INDEX;
+			corner.relativeMask = 0;
+
+			for (int component = 0; component < 3; component++)
+			{
+				if (component > 0)
+				{
+					if ((p >= pLineEnd) || (*p != '/'))
+					{
+						break;
+					}
+					p++;
+					if ((p < pLineEnd) && (*p == '/'))
+					{
+						continue;
+					}
+				}
+
+				int64_t value = 0;
+				const char* pNext = ParseIndex(p, pLineEnd, value);
+				if ((pNext == NULL) || (value == 0))
+				{
+					chunk.badFaces++;
+					return;
+				}
+				p = pNext;
+
+				if (value < 0)
+				{
+					value += counts[component];
+					corner.relativeMask |= 1u << component;
+				}
+				else
+				{
+					value -= 1;
+				}
+				if ((value < INT32_MIN) || (value > INT32_MAX))
+				{
+					chunk.badFaces++;
+					return;
+				}
+				corner.index[component] = (int32_t)value;
+			}
+
+			polygon.push_back(corner);
+			while ((p < pLineEnd) && (*p != ' ') && (*p != '\t') && (*p != '\r'))
+			{
+				p++;
+			}
+		}
+
+		if (polygon.size() < 3)
+		{
+			chunk.badFaces++;
+			return;
+		}
+
+		for (size_t i = 1; i + 1 < polygon.size(); i++)
+		{
+			chunk.corners.push_back(polygon[0]);
+			chunk.corners.push_back(polygon[i]);
+			chunk.corners.push_back(polygon[i + 1]);
+		}
+	}
+
+	/***********************************************************
+	 *  ParseOBJChunk()
+	 *
+	 *  Parse the vertex attribute and face lines of a chunk.
+	 *  Other statements (groups, materials, smoothing) do not
+	 *  change the geometry and are skipped.
+	 ***********************************************************/
+	void ParseOBJChunk(OBJ_CHUNK& chunk)
+	{
+		std::vector<OBJ_CORNER> polygon;
+		const char* p = chunk.pBegin;
+		const char* pEnd = chunk.pEnd;
+
+		// a rough guess that saves most of the reallocations
+		size_t estimatedLines = (size_t)(pEnd - p) / 32;
+		chunk.attributes[0].reserve(estimatedLines);
+		chunk.corners.reserve(estimatedLines);
+
+		while (p < pEnd)
+		{
+			const char* pLineEnd = (const char*)memchr(p, '\n', (size_t)(pEnd - p));
+			if (pLineEnd == NULL)
+			{
+				pLineEnd = pEnd;
+			}
+
+			p = SkipSpaces(p, pLineEnd);
+			if (pLineEnd - p >= 2)
+			{
+				bool bSpaceAfter1 = (p[1] == ' ') || (p[1] == '\t');
+				bool bSpaceAfter2 = (pLineEnd - p >= 3) && ((p[2] == ' ') || (p[2] == '\t'));
+
+				int attribute = -1;
+				if ((p[0] == 'v') && (bSpaceAfter1))
+				{
+					attribute = 0;
+				}
+				else if ((p[0] == 'v') && (p[1] == 't') && (bSpaceAfter2))
+				{
+					attribute = 1;
+				}
+				else if ((p[0] == 'v') && (p[1] == 'n') && (bSpaceAfter2))
+				{
+					attribute = 2;
+				}
+
+				if (attribute != -1)
+				{
+					const char* pValue = p + ((attribute == 0) ? 2 : 3);
+					std::vector<float>& values = chunk.attributes[attribute];
+					for (size_t component = 0; component < OBJ_COMPONENTS[attribute]; component++)
+					{
+						// missing trailing values, like the optional
+						// third texture coordinate, are read as zero
+						float value = 0.0f;
+						if (pValue != NULL)
+						{
+							pValue = ParseFloat(pValue, pLineEnd, value);
+						}
+						values.push_back(value);
+					}
+				}
+				else if ((p[0] == 'f') && (bSpaceAfter1))
+				{
+					ParseOBJFace(p + 2, pLineEnd, chunk, polygon);
+				}
+			}
+
+			p = pLineEnd + 1;
+		}
+	}
+
+	/***********************************************************
+	 *  SkipWhitespace()
+	 *
+	 *  Skip the whitespace between JSON tokens.
+	 ***********************************************************/
+	inline const char* SkipWhitespace(const char* p, const char* pEnd)
+	{
+		while ((p < pEnd) && (isspace((unsigned char)*p)))
+		{
+			p++;
+		}
+		return(p);
+	}
+
+	/***********************************************************
+	 *  ParseJSONString()
+	 *
+	 *  Parse a quoted JSON string, decoding the escapes.
+	 ***********************************************************/
+	bool ParseJSONString(const char*& p, const char* pEnd, std::string& text)
+	{
+		if ((p >= pEnd) || (*p != '"'))
+		{
+			return(false);
+		}
+		p++;
+
+		text.clear();
+		while (p < pEnd)
+		{
+			char c = *p++;
+			if (c == '"')
+			{
+				return(true);
+			}
+			if (c != '\\')
+			{
+				text.push_back(c);
+				continue;
+			}
+			if (p >= pEnd)
+			{
+				return(false);
+			}
+
+			c = *p++;
+			switch (c)
+			{
+			case 'b': text.push_back('\b'); break;
+			case 'f': text.push_back('\f'); break;
+			case 'n': text.push_back('\n'); break;
+			case 'r': text.push_back('\r'); break;
+			case 't': text.push_back('\t'); break;
+			case 'u':
+			{
+				if (pEnd - p < 4)
+				{
+					return(false);
+				}
+				unsigned int codePoint = 0;
+				std::from_chars_result result = std::from_chars(p, p + 4, codePoint, 16);
+				if ((result.ec != std::errc()) || (result.ptr != p + 4))
+				{
+					return(false);
+				}
+				p += 4;
+
+				// names in glTF files are almost always plain
+				// text, so surrogate pairs are not combined
+				if (codePoint < 0x80)
+				{
+					text.push_back((char)codePoint);
+				}
+				else if (codePoint < 0x800)
+				{
+					text.push_back((char)(0xC0 | (codePoint >> 6)));
+					text.push_back((char)(0x80 | (codePoint & 0x3F)));
+				}
+				else
+				{
+					text.push_back((char)(0xE0 | (codePoint >> 12)));
+					text.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+					text.push_back((char)(0x80 | (codePoint & 0x3F)));
+				}
+				break;
+			}
+			default: text.push_back(c); break;
+			}
+		}
+
+		return(false);
+	}
+
+	/***********************************************************
+	 *  ParseJSONValue()
+	 *
+	 *  Parse one JSON value and everything nested inside it.
+	 ***********************************************************/
+	bool ParseJSONValue(const char*& p, const char* pEnd, JSON_VALUE& value, int depth)
+	{
+		const int MAX_DEPTH = 256;
+
+		p = SkipWhitespace(p, pEnd);
+		if ((p >= pEnd) || (depth > MAX_DEPTH))
+		{
+			return(false);
+		}
+
+		if ((*p == '{') || (*p == '['))
+		{
+			bool bObject = (*p == '{');
+			char closing = bObject ? '}' : ']';
+			value.type = bObject ? JSON_VALUE::JSON_OBJECT : JSON_VALUE::JSON_ARRAY;
+			p++;
+
+			for (bool bFirst = true; ; bFirst = false)
+			{
+				p = SkipWhitespace(p, pEnd);
+				if (p >= pEnd)
+				{
+					return(false);
+				}
+				if (*p == closing)
+				{
+					p++;
+					return(true);
+				}
+				if (bFirst == false)
+				{
+					if (*p != ',')
+					{
+						return(false);
+					}
+					p = SkipWhitespace(p + 1, pEnd);
+				}
+
+				if (bObject)
+				{
+					std::string name;
+					if (ParseJSONString(p, pEnd, name) == false)
+					{
+						return(false);
+					}
+					p = SkipWhitespace(p, pEnd);
+					if ((p >= pEnd) || (*p != ':'))
+					{
+						return(false);
+					}
+					p++;
+					value.names.push_back(name);
+				}
+
+				value.elements.push_back(JSON_VALUE());
+				if (ParseJSONValue(p, pEnd, value.elements.back(), depth + 1) == false)
+				{
+					return(false);
+				}
+			}
+		}
+
+		if (*p == '"')
+		{
+			value.type = JSON_VALUE::JSON_STRING;
+			return(ParseJSONString(p, pEnd, value.text));
+		}
+		if ((pEnd - p >= 4) && (strncmp(p, "true", 4) == 0))
+		{
+			value.type = JSON_VALUE::JSON_BOOL;
+			value.number = 1.0;
+			p += 4;
+			return(true);
+		}
+		if ((pEnd - p >= 5) && (strncmp(p, "false", 5) == 0))
+		{
+			value.type = JSON_VALUE::JSON_BOOL;
+			p += 5;
+			return(true);
+		}
+		if ((pEnd - p >= 4) && (strncmp(p, "null", 4) == 0))
+		{
+			p += 4;
+			return(true);
+		}
+
+		value.type = JSON_VALUE::JSON_NUMBER;
+		std::from_chars_result result = std::from_chars(p, pEnd, value.number);
+		if ((result.ec != std::errc()) && (result.ec != std::errc::result_out_of_range))
+		{
+			return(false);
+		}
+		p = result.ptr;
+		return(true);
+	}
+
+	/***********************************************************
+	 *  FindMember()
+	 *
+	 *  Find a named member of a JSON object.
+	 ***********************************************************/
+	const JSON_VALUE* FindMember(const JSON_VALUE* pObject, const char* name)
+	{
+		if ((pObject == NULL) || (pObject->type != JSON_VALUE::JSON_OBJECT))
+		{
+			return(NULL);
+		}
+		for (size_t i = 0; i < pObject->names.size(); i++)
+		{
+			if (pObject->names[i].compare(name) == 0)
+			{
+				return(&pObject->elements[i]);
+			}
+		}
+		return(NULL);
+	}
+
+	/***********************************************************
+	 *  GetElement()
+	 *
+	 *  Get an element of a JSON array, or NULL when the index
+	 *  is out of range.
+	 ***********************************************************/
+	const JSON_VALUE* GetElement(const JSON_VALUE* pArray, int64_t index)
+	{
+		if ((pArray == NULL) || (pArray->type != JSON_VALUE::JSON_ARRAY) ||
+			(index < 0) || (index >= (int64_t)pArray->elements.size()))
+		{
+			return(NULL);
+		}
+		return(&pArray->elements[(size_t)index]);
+	}
+
+	/***********************************************************
+	 *  GetNumber()
+	 *
+	 *  Get a numeric member of a JSON object, or the default
+	 *  value when the member is missing.
+	 ***********************************************************/
+	double GetNumber(const JSON_VALUE* pObject, const char* name, double defaultValue)
+	{
+		const JSON_VALUE* pMember = FindMember(pObject, name);
+		if ((pMember == NULL) || (pMember->type != JSON_VALUE::JSON_NUMBER))
+		{
+			return(defaultValue);
+		}
+		return(pMember->number);
+	}
+
+	/***********************************************************
+	 *  GetString()
+	 *
+	 *  Get a string member of a JSON object, or an empty string
+	 *  when the member is missing.
+	 ***********************************************************/
+	std::string GetString(const JSON_VALUE* pObject, const char* name)
+	{
+		const JSON_VALUE* pMember = FindMember(pObject, name);
+		if ((pMember == NULL) || (pMember->type != JSON_VALUE::JSON_STRING))
+		{
+			return(std::string());
+		}
+		return(pMember->text);
+	}
+
+	/***********************************************************
+	 *  DecodeBase64()
+	 *
+	 *  Decode base64 text, as used by glTF data URIs.
+	 ***********************************************************/
+	bool DecodeBase64(const char* p, const char* pEnd, std::vector<unsigned char>& bytes)
+	{
+		bytes.clear();
+		bytes.reserve((size_t)(pEnd - p) / 4 * 3);
+
+		uint32_t bits = 0;
+		int bitCount = 0;
+		for (; p < pEnd; p++)
+		{
+			char c = *p;
+			uint32_t sextet = 0;
+			if ((c >= 'A') && (c <= 'Z')) sextet = (uint32_t)(c - 'A');
+			else if ((c >= 'a') && (c <= 'z')) sextet = (uint32_t)(c - 'a' + 26);
+			else if ((c >= '0') && (c <= '9')) sextet = (uint32_t)(c - '0' + 52);
+			else if (c == '+') sextet = 62;
+			else if (c == '/') sextet = 63;
+			else if (c == '=') break;
+			else return(false);
+
+			bits = (bits << 6) | sextet;
+			bitCount += 6;
+			if (bitCount >= 8)
+			{
+				bitCount -= 8;
+				bytes.push_back((unsigned char)((bits >> bitCount) & 0xFF));
+			}
+		}
+		return(true);
+	}
+
+	/***********************************************************
+	 *  DecodeURI()
+	 *
+	 *  Replace the percent escapes of a relative URI.
+	 ***********************************************************/
+	std::string DecodeURI(const std::string& uri)
+	{
+		std::string path;
+		for (size_t i = 0; i < uri.size(); i++)
+		{
+			unsigned int value = 0;
+			if ((uri[i] == '%') && (i + 2 < uri.size()) &&
+				(std::from_chars(uri.data() + i + 1, uri.data() + i + 3, value, 16).ec == std::errc()))
+			{
+				path.push_back((char)value);
+				i += 2;
+			}
+			else
+			{
+				path.push_back(uri[i]);
+			}
+		}
+		return(path);
+	}
+
+	/***********************************************************
+	 *  LoadGLTFBuffers()
+	 *
+	 *  Find the bytes of every buffer of a glTF file.  Buffers
+	 *  are either the binary chunk of a .glb file, a base64
+	 *  data URI, or a file next to the model that is mapped.
+	 ***********************************************************/
+	bool LoadGLTFBuffers(const std::string& filename, GLTF_DOCUMENT& document, const unsigned char* pBinaryChunk, size_t binaryChunkSize)
+	{
+		const JSON_VALUE* pBuffers = FindMember(&document.root, "buffers");
+		if (pBuffers == NULL)
+		{
+			return(true);
+		}
+
+		std::filesystem::path directory = std::filesystem::path(filename).parent_path();
+		for (size_t i = 0; i < pBuffers->elements.size(); i++)
+		{
+			const JSON_VALUE* pBuffer = &pBuffers->elements[i];
+			std::string uri = GetString(pBuffer, "uri");
+			size_t byteLength = (size_t)GetNumber(pBuffer, "byteLength", 0.0);
+			GLTF_BUFFER buffer = { NULL, 0 };
+
+			if (uri.empty())
+			{
+				if ((i != 0) || (pBinaryChunk == NULL) || (binaryChunkSize < byteLength))
+				{
+					std::cout << "Missing glTF binary buffer:" << filename << std::endl;
+					return(false);
+				}
+				buffer.pData = pBinaryChunk;
+				buffer.size = binaryChunkSize;
+			}
+			else if (uri.compare(0, 5, "data:") == 0)
+			{
+				size_t dataStart = uri.find(";base64,");
+				document.decodedBuffers.push_back(std::vector<unsigned char>());
+				std::vector<unsigned char>& bytes = document.decodedBuffers.back();
+				if ((dataStart == std::string::npos) ||
+					(DecodeBase64(uri.data() + dataStart + 8, uri.data() + uri.size(), bytes) == false))
+				{
+					std::cout << "Invalid glTF data URI:" << filename << std::endl;
+					return(false);
+				}
+				buffer.pData = bytes.data();
+				buffer.size = bytes.size();
+			}
+			else
+			{
+				std::string bufferFilename = (directory / DecodeURI(uri)).string();
+				document.mappedFiles.push_back(std::unique_ptr<MappedFile>(new MappedFile()));
+				MappedFile& bufferFile = *document.mappedFiles.back();
+				if (bufferFile.Open(bufferFilename) == false)
+				{
+					std::cout << "Could not open glTF buffer:" << bufferFilename << std::endl;
+					return(false);
+				}
+				buffer.pData = bufferFile.GetData();
+				buffer.size = bufferFile.GetSize();
+			}
+
+			if (buffer.size < byteLength)
+			{
+				std::cout << "glTF buffer is too short:" << filename << std::endl;
+				return(false);
+			}
+			document.buffers.push_back(buffer);
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ReadGLTFComponent()
+	 *
+	 *  Read one accessor component as a float, converting
+	 *  normalized integers to the 0..1 or -1..1 range.
+	 ***********************************************************/
+	inline float ReadGLTFComponent(const unsigned char* p, int componentType, bool bNormalized)
+	{
+		switch (componentType)
+		{
+		case 5120:
+		{
+			int8_t value = (int8_t)p[0];
+			return(bNormalized ? std::max(value / 127.0f, -1.0f) : (float)value);
+		}
+		case 5121:
+			return(bNormalized ? p[0] / 255.0f : (float)p[0]);
+		case 5122:
+		{
+			int16_t value;
+			memcpy(&value, p, sizeof(value));
+			return(bNormalized ? std::max(value / 32767.0f, -1.0f) : (float)value);
+		}
+		case 5123:
+		{
+			uint16_t value;
+			memcpy(&value, p, sizeof(value));
+			return(bNormalized ? value / 65535.0f : (float)value);
+		}
+		case 5125:
+		{
+			uint32_t value;
+			memcpy(&value, p, sizeof(value));
+			return((float)value);
+		}
+		default:
+		{
+			float value;
+			memcpy(&value, p, sizeof(value));
+			return(value);
+		}
+		}
+	}
+
+	/***********************************************************
+	 *  GetGLTFComponentSize()
+	 *
+	 *  Get the byte size of a glTF accessor component type, or
+	 *  zero for an unknown type.
+	 ***********************************************************/
+	size_t GetGLTFComponentSize(int componentType)
+	{
+		switch (componentType)
+		{
+		case 5120: case 5121: return(1);
+		case 5122: case 5123: return(2);
+		case 5125: case 5126: return(4);
+		default: return(0);
+		}
+	}
+
+	/***********************************************************
+	 *  GetGLTFAccessorData()
+	 *
+	 *  Find the first element and the stride of an accessor,
+	 *  after checking that every element is inside its buffer.
+	 *  A NULL data pointer is returned for accessors without
+	 *  a buffer view, whose values are all zero.
+	 ***********************************************************/
+	bool GetGLTFAccessorData(
+		const GLTF_DOCUMENT& document,
+		const JSON_VALUE* pAccessor,
+		size_t elementSize,
+		size_t count,
+		const unsigned char*& pData,
+		size_t& stride)
+	{
+		pData = NULL;
+		stride = elementSize;
+
+		if (FindMember(pAccessor, "sparse") != NULL)
+		{
+			std::cout << "Sparse glTF accessors are not supported, using the base values" << std::endl;
+		}
+
+		int viewIndex = (int)GetNumber(pAccessor, "bufferView", -1.0);
+		if (viewIndex == -1)
+		{
+			return(true);
+		}
+
+		const JSON_VALUE* pView = GetElement(FindMember(&document.root, "bufferViews"), viewIndex);
+		int bufferIndex = (int)GetNumber(pView, "buffer", -1.0);
+		if ((pView == NULL) || (bufferIndex < 0) || (bufferIndex >= (int)document.buffers.size()))
+		{
+			return(false);
+		}
+
+		const GLTF_BUFFER& buffer = document.buffers[bufferIndex];
+		size_t viewOffset = (size_t)GetNumber(pView, "byteOffset", 0.0);
+		size_t viewLength = (size_t)GetNumber(pView, "byteLength", 0.0);
+		size_t accessorOffset = (size_t)GetNumber(pAccessor, "byteOffset", 0.0);
+		size_t viewStride = (size_t)GetNumber(pView, "byteStride", 0.0);
+		if (viewStride != 0)
+		{
+			stride = viewStride;
+		}
+
+		if ((viewOffset > buffer.size) || (viewLength > buffer.size - viewOffset) || (accessorOffset > viewLength))
+		{
+			return(false);
+		}
+		size_t available = viewLength - accessorOffset;
+		if ((count > 0) && ((available < elementSize) || (count - 1 > (available - elementSize) / stride)))
+		{
+			return(false);
+		}
+
+		pData = buffer.pData + viewOffset + accessorOffset;
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ReadGLTFAttribute()
+	 *
+	 *  Read a vertex attribute accessor with the passed in
+	 *  number of components into a float array.
+	 ***********************************************************/
+	bool ReadGLTFAttribute(const GLTF_DOCUMENT& document, int accessorIndex, size_t components, std::vector<float>& values)
+	{
+		const JSON_VALUE* pAccessor = GetElement(FindMember(&document.root, "accessors"), accessorIndex);
+		if (pAccessor == NULL)
+		{
+			return(false);
+		}
+
+		std::string type = GetString(pAccessor, "type");
+		size_t typeComponents = (type == "SCALAR") ? 1 : (type == "VEC2") ? 2 : (type == "VEC3") ? 3 : (type == "VEC4") ? 4 : 0;
+		int componentType = (int)GetNumber(pAccessor, "componentType", 0.0);
+		size_t componentSize = GetGLTFComponentSize(componentType);
+		size_t count = (size_t)GetNumber(pAccessor, "count", 0.0);
+		const JSON_VALUE* pNormalized = FindMember(pAccessor, "normalized");
+		bool bNormalized = (pNormalized != NULL) && (pNormalized->number != 0.0);
+		if ((typeComponents < components) || (componentSize == 0))
+		{
+			return(false);
+		}
+
+		const unsigned char* pData = NULL;
+		size_t stride = 0;
+		if (GetGLTFAccessorData(document, pAccessor, typeComponents * componentSize, count, pData, stride) == false)
+		{
+			return(false);
+		}
+
+		values.assign(count * components, 0.0f);
+		if (pData == NULL)
+		{
+			return(true);
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const unsigned char* pElement = pData + i * stride;
+			for (size_t c = 0; c < components; c++)
+			{
+				values[i * components + c] = ReadGLTFComponent(pElement + c * componentSize, componentType, bNormalized);
+			}
+		}
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ReadGLTFIndices()
+	 *
+	 *  Read an index accessor into a 32-bit index array.
+	 ***********************************************************/
+	bool ReadGLTFIndices(const GLTF_DOCUMENT& document, int accessorIndex, std::vector<uint32_t>& indices)
+	{
+		const JSON_VALUE* pAccessor = GetElement(FindMember(&document.root, "accessors"), accessorIndex);
+		int componentType = (int)GetNumber(pAccessor, "componentType", 0.0);
+		if ((pAccessor == NULL) || ((componentType != 5121) && (componentType != 5123) && (componentType != 5125)))
+		{
+			return(false);
+		}
+
+		size_t componentSize = GetGLTFComponentSize(componentType);
+		size_t count = (size_t)GetNumber(pAccessor, "count", 0.0);
+		const unsigned char* pData = NULL;
+		size_t stride = 0;
+		if (GetGLTFAccessorData(document, pAccessor, componentSize, count, pData, stride) == false)
+		{
+			return(false);
+		}
+
+		indices.assign(count, 0);
+		if (pData == NULL)
+		{
+			return(true);
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const unsigned char* pElement = pData + i * stride;
+			if (componentType == 5121)
+			{
+				indices[i] = pElement[0];
+			}
+			else if (componentType == 5123)
+			{
+				uint16_t value;
+				memcpy(&value, pElement, sizeof(value));
+				indices[i] = value;
+			}
+			else
+			{
+				memcpy(&indices[i], pElement, sizeof(uint32_t));
+			}
+		}
+		return(true);
+	}
+
+	/***********************************************************
+	 *  GetGLTFNodeTransform()
+	 *
+	 *  Get the local transform of a glTF node, either from its
+	 *  matrix or from its translation, rotation and scale.
+	 ***********************************************************/
+	glm::mat4 GetGLTFNodeTransform(const JSON_VALUE* pNode)
+	{
+		glm::mat4 transform = glm::mat4(1.0f);
+
+		const JSON_VALUE* pMatrix = FindMember(pNode, "matrix");
+		if ((pMatrix != NULL) && (pMatrix->elements.size() == 16))
+		{
+			// the values are stored column by column
+			for (int column = 0; column < 4; column++)
+			{
+				for (int row = 0; row < 4; row++)
+				{
+					transform[column][row] = (float)pMatrix->elements[column * 4 + row].number;
+				}
+			}
+			return(transform);
+		}
+
+		const JSON_VALUE* pTranslation = FindMember(pNode, "translation");
+		if ((pTranslation != NULL) && (pTranslation->elements.size() == 3))
+		{
+			transform = glm::translate(transform, glm::vec3(
+				(float)pTranslation->elements[0].number,
+				(float)pTranslation->elements[1].number,
+				(float)pTranslation->elements[2].number));
+		}
+
+		const JSON_VALUE* pRotation = FindMember(pNode, "rotation");
+		if ((pRotation != NULL) && (pRotation->elements.size() == 4))
+		{
+			// the quaternion is stored as x, y, z, w
+			glm::quat rotation(
+				(float)pRotation->elements[3].number,
+				(float)pRotation->elements[0].number,
+				(float)pRotation->elements[1].number,
+				(float)pRotation->elements[2].number);
+			transform = transform * glm::mat4_cast(rotation);
+		}
+
+		const JSON_VALUE* pScale = FindMember(pNode, "scale");
+		if ((pScale != NULL) && (pScale->elements.size() == 3))
+		{
+			transform = glm::scale(transform, glm::vec3(
+				(float)pScale->elements[0].number,
+				(float)pScale->elements[1].number,
+				(float)pScale->elements[2].number));
+		}
+
+		return(transform);
+	}
+
+	/***********************************************************
+	 *  CollectGLTFNode()
+	 *
+	 *  Add the primitives of a glTF node and its children to
+	 *  the instance list, with their world transforms.
+	 ***********************************************************/
+	void CollectGLTFNode(
+		const GLTF_DOCUMENT& document,
+		int nodeIndex,
+		const glm::mat4& parentTransform,
+		int depth,
+		std::vector<GLTF_PRIMITIVE_INSTANCE>& instances)
+	{
+		const JSON_VALUE* pNode = GetElement(FindMember(&document.root, "nodes"), nodeIndex);
+		if ((pNode == NULL) || (depth > GLTF_MAX_NODE_DEPTH))
+		{
+			return;
+		}
+
+		glm::mat4 transform = parentTransform * GetGLTFNodeTransform(pNode);
+
+		int meshIndex = (int)GetNumber(pNode, "mesh", -1.0);
+		const JSON_VALUE* pMesh = GetElement(FindMember(&document.root, "meshes"), meshIndex);
+		const JSON_VALUE* pPrimitives = FindMember(pMesh, "primitives");
+		if (pPrimitives != NULL)
+		{
+			for (size_t i = 0; i < pPrimitives->elements.size(); i++)
+			{
+				GLTF_PRIMITIVE_INSTANCE instance;
+				instance.pPrimitive = &pPrimitives->elements[i];
+				instance.transform = transform;
+				instances.push_back(instance);
+			}
+		}
+
+		const JSON_VALUE* pChildren = FindMember(pNode, "children");
+		if (pChildren != NULL)
+		{
+			for (size_t i = 0; i < pChildren->elements.size(); i++)
+			{
+				CollectGLTFNode(document, (int)pChildren->elements[i].number, transform, depth + 1, instances);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  LoadGLTFPrimitive()
+	 *
+	 *  Read one triangle primitive into mesh data, in world
+	 *  space.  Primitives without normals get flat normals, as
+	 *  the glTF specification requires.  Non-triangle modes are
+	 *  skipped and leave the mesh data empty.
+	 ***********************************************************/
+	bool LoadGLTFPrimitive(const GLTF_DOCUMENT& document, const GLTF_PRIMITIVE_INSTANCE& instance, MESH_DATA& mesh)
+	{
+		const JSON_VALUE* pPrimitive = instance.pPrimitive;
+		if ((int)GetNumber(pPrimitive, "mode", GLTF_MODE_TRIANGLES) != GLTF_MODE_TRIANGLES)
+		{
+			return(true);
+		}
+
+		const JSON_VALUE* pAttributes = FindMember(pPrimitive, "attributes");
+		int positionAccessor = (int)GetNumber(pAttributes, "POSITION", -1.0);
+		int normalAccessor = (int)GetNumber(pAttributes, "NORMAL", -1.0);
+		int textureCoordinateAccessor = (int)GetNumber(pAttributes, "TEXCOORD_0", -1.0);
+		int indexAccessor = (int)GetNumber(pPrimitive, "indices", -1.0);
+		if (positionAccessor == -1)
+		{
+			return(true);
+		}
+
+		std::vector<float> positions;
+		std::vector<float> normals;
+		std::vector<float> textureCoordinates;
+		if (ReadGLTFAttribute(document, positionAccessor, 3, positions) == false)
+		{
+			return(false);
+		}
+		size_t vertexCount = positions.size() / 3;
+		bool bHasNormals = (normalAccessor != -1) && (ReadGLTFAttribute(document, normalAccessor, 3, normals)) && (normals.size() == vertexCount * 3);
+		bool bHasTextureCoordinates = (textureCoordinateAccessor != -1) && (ReadGLTFAttribute(document, textureCoordinateAccessor, 2, textureCoordinates)) && (textureCoordinates.size() == vertexCount * 2);
+
+		std::vector<uint32_t> indices;
+		if (indexAccessor != -1)
+		{
+			if (ReadGLTFIndices(document, indexAccessor, indices) == false)
+			{
+				return(false);
+			}
+			for (size_t i = 0; i < indices.size(); i++)
+			{
+				if (indices[i] >= vertexCount)
+				{
+					return(false);
+				}
+			}
+		}
+		else
+		{
+			indices.resize(vertexCount);
+			for (size_t i = 0; i < vertexCount; i++)
+			{
+				indices[i] = (uint32_t)i;
+			}
+		}
+		indices.resize(indices.size() - indices.size() % 3);
+
+		// mirroring transforms turn the triangles inside out
+		glm::mat3 linear = glm::mat3(instance.transform);
+		glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+		if (glm::determinant(linear) < 0.0f)
+		{
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				std::swap(indices[i + 1], indices[i + 2]);
+			}
+		}
+
+		std::vector<MESH_VERTEX> vertices(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			glm::vec4 position = instance.transform * glm::vec4(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2], 1.0f);
+			vertices[i].position[0] = position.x;
+			vertices[i].position[1] = position.y;
+			vertices[i].position[2] = position.z;
+
+			glm::vec3 normal = glm::vec3(0.0f, 1.0f, 0.0f);
+			if (bHasNormals)
+			{
+				normal = normalMatrix * glm::vec3(normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2]);
+				float length = glm::length(normal);
+				normal = (length > 0.0f) ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+			}
+			vertices[i].normal[0] = normal.x;
+			vertices[i].normal[1] = normal.y;
+			vertices[i].normal[2] = normal.z;
+
+			// glTF puts the texture origin at the top left
+			vertices[i].textureCoordinate[0] = bHasTextureCoordinates ? textureCoordinates[i * 2] : 0.0f;
+			vertices[i].textureCoordinate[1] = bHasTextureCoordinates ? 1.0f - textureCoordinates[i * 2 + 1] : 0.0f;
+		}
+
+		if (bHasNormals)
+		{
+			mesh.vertices.swap(vertices);
+			mesh.indices.swap(indices);
+			if (indexAccessor == -1)
+			{
+				DeduplicateVertices(mesh);
+			}
+			return(true);
+		}
+
+		// every triangle gets its own vertices with the face
+		// normal, then the vertices of coplanar faces are merged
+		mesh.vertices.resize(indices.size());
+		mesh.indices.resize(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			glm::vec3 corners[3];
+			for (int c = 0; c < 3; c++)
+			{
+				const float* pPosition = vertices[indices[i + c]].position;
+				corners[c] = glm::vec3(pPosition[0], pPosition[1], pPosition[2]);
+			}
+			glm::vec3 normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+			float length = glm::length(normal);
+			normal = (length > 0.0f) ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+
+			for (int c = 0; c < 3; c++)
+			{
+				MESH_VERTEX& vertex = mesh.vertices[i + c];
+				vertex = vertices[indices[i + c]];
+				vertex.normal[0] = normal.x;
+				vertex.normal[1] = normal.y;
+				vertex.normal[2] = normal.z;
+				mesh.indices[i + c] = (uint32_t)(i + c);
+			}
+		}
+		DeduplicateVertices(mesh);
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  LoadModel()
+ *
+ *  This method is used for loading a model file into mesh
+ *  data.  The file format is chosen from the extension.
+ ***********************************************************/
+bool ModelLoader::LoadModel(const std::string& filename, MESH_DATA& mesh, WorkerPool* pWorkerPool)
+{
+	std::string extension = GetFileExtension(filename);
+	bool bLoaded = false;
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	if (extension == ".obj")
+	{
+		bLoaded = LoadOBJ(filename, mesh, pWorkerPool);
+	}
+	else if ((extension == ".gltf") || (extension == ".glb"))
+	{
+		bLoaded = LoadGLTF(filename, mesh, pWorkerPool);
+	}
+	else
+	{
+		std::cout << "Unsupported model format:" << filename << std::endl;
+		return(false);
+	}
+
+	if (bLoaded)
+	{
+		std::chrono::duration<double, std::milli> loadTime = std::chrono::steady_clock::now() - startTime;
+		std::cout << "Loaded model " << filename << ": " << mesh.indices.size() / 3 << " triangles, "
+			<< mesh.vertices.size() << " vertices in " << loadTime.count() << " ms" << std::endl;
+	}
+	return(bLoaded);
+}
+
+/***********************************************************
+ *  LoadOBJ()
+ *
+ *  This method is used for loading a Wavefront OBJ file.
+ *  The mapped file is split into chunks of whole lines that
+ *  are parsed in parallel.  Once every chunk is parsed, the
+ *  chunk relative indices are fixed up, the unique corners
+ *  are found with hash tables that each own a share of the
+ *  hash values, and the interleaved vertices are written.
+ *  Polygons are split into triangle fans, and vertices
+ *  without a normal get a smooth area weighted normal.
+ ***********************************************************/
+bool ModelLoader::LoadOBJ(const std::string& filename, MESH_DATA& mesh, WorkerPool* pWorkerPool)
+{
+	MappedFile file;
+	if (file.Open(filename) == false)
+	{
+		std::cout << "Could not open model:" << filename << std::endl;
+		return(false);
+	}
+
+	const char* pData = (const char*)file.GetData();
+	size_t size = file.GetSize();
+	size_t threadCount = (NULL != pWorkerPool) ? pWorkerPool->GetThreadCount() : 1;
+
+	// split the file into chunks that end on line breaks
+	size_t chunkCount = std::max<size_t>(1, std::min(size / OBJ_MIN_CHUNK_SIZE, threadCount * 4));
+	std::vector<OBJ_CHUNK> chunks(chunkCount);
+	const char* pChunkBegin = pData;
+	for (size_t i = 0; i < chunkCount; i++)
+	{
+		const char* pChunkEnd = pData + size;
+		if (i + 1 < chunkCount)
+		{
+			pChunkEnd = std::max(pChunkBegin, pData + size * (i + 1) / chunkCount);
+			const char* pLineEnd = (const char*)memchr(pChunkEnd, '\n', (size_t)(pData + size - pChunkEnd));
+			pChunkEnd = (pLineEnd != NULL) ? pLineEnd + 1 : pData + size;
+		}
+		chunks[i].pBegin = pChunkBegin;
+		chunks[i].pEnd = pChunkEnd;
+		chunks[i].badFaces = 0;
+		pChunkBegin = pChunkEnd;
+	}
+
+	RunTasks(pWorkerPool, chunkCount, [&](size_t i) { ParseOBJChunk(chunks[i]); });
+
+	// offsets of every chunk in the combined arrays
+	std::vector<size_t> attributeBase[3];
+	std::vector<size_t> cornerBase(chunkCount);
+	size_t attributeCount[3] = { 0, 0, 0 };
+	size_t cornerCount = 0;
+	size_t badFaces = 0;
+	for (int attribute = 0; attribute < 3; attribute++)
+	{
+		attributeBase[attribute].resize(chunkCount);
+	}
+	for (size_t i = 0; i < chunkCount; i++)
+	{
+		for (int attribute = 0; attribute < 3; attribute++)
+		{
+			attributeBase[attribute][i] = attributeCount[attribute];
+			attributeCount[attribute] += chunks[i].attributes[attribute].size() / OBJ_COMPONENTS[attribute];
+		}
+		cornerBase[i] = cornerCount;
+		cornerCount += chunks[i].corners.size();
+		badFaces += chunks[i].badFaces;
+	}
+
+	if (badFaces > 0)
+	{
+		std::cout << "Skipped " << badFaces << " malformed faces in " << filename << std::endl;
+	}
+	if ((cornerCount == 0) || (cornerCount > EMPTY_SLOT))
+	{
+		std::cout << "Model has no usable triangles:" << filename << std::endl;
+		return(false);
+	}
+
+	// combine the chunks, turning every index into an absolute
+	// one and hashing the corners for the deduplication
+	std::vector<float> attributes[3];
+	for (int attribute = 0; attribute < 3; attribute++)
+	{
+		attributes[attribute].resize(attributeCount[attribute] * OBJ_COMPONENTS[attribute]);
+	}
+	std::vector<OBJ_CORNER> corners(cornerCount);
+	std::vector<uint64_t> cornerHashes(cornerCount);
+	std::atomic<size_t> badIndices(0);
+
+	RunTasks(pWorkerPool, chunkCount, [&](size_t i)
+	{
+		OBJ_CHUNK& chunk = chunks[i];
+		for (int attribute = 0; attribute < 3; attribute++)
+		{
+			std::copy(chunk.attributes[attribute].begin(), chunk.attributes[attribute].end(),
+				attributes[attribute].begin() + attributeBase[attribute][i] * OBJ_COMPONENTS[attribute]);
+			std::vector<float>().swap(chunk.attributes[attribute]);
+		}
+
+		size_t chunkBadIndices = 0;
+		for (size_t c = 0; c < chunk.corners.size(); c++)
+		{
+			OBJ_CORNER corner = chunk.corners[c];
+			for (int component = 0; component < 3; component++)
+			{
+				int64_t index = corner.index[component];
+				if (corner.relativeMask & (1u << component))
+				{
+					index += (int64_t)attributeBase[component][i];
+				}
+				else if (index == OBJ_NO_INDEX)
+				{
+					continue;
+				}
+
+				if ((index < 0) || (index >= (int64_t)attributeCount[component]))
+				{
+					// a bad position cannot be recovered, but a bad
+					// texture coordinate or normal is just dropped
+					chunkBadIndices += (component == 0) ? 1 : 0;
+					index = (component == 0) ? 0 : OBJ_NO_INDEX;
+				}
+				corner.index[component] = (int32_t)index;
+			}
+			corner.relativeMask = 0;
+
+			uint64_t hash = MixHash((uint64_t)(uint32_t)corner.index[0] | ((uint64_t)(uint32_t)corner.index[1] << 32));
+			corners[cornerBase[i] + c] = corner;
+			cornerHashes[cornerBase[i] + c] = MixHash(hash ^ (uint32_t)corner.index[2]);
+		}
+		badIndices += chunkBadIndices;
+		std::vector<OBJ_CORNER>().swap(chunk.corners);
+	});
+
+	if (badIndices > 0)
+	{
+		std::cout << "Model has " << badIndices << " out of range vertex indices:" << filename << std::endl;
+		return(false);
+	}
+
+	// every shard owns the corners whose hash falls into it, so
+	// the shards can be deduplicated at the same time without
+	// sharing a table; a corner gets the shard local number of
+	// the first identical corner
+	size_t shardCount = threadCount;
+	std::vector<std::vector<uint32_t>> shardFirstCorners(shardCount);
+	std::vector<uint32_t> cornerVertex(cornerCount);
+	auto GetShard = [shardCount](uint64_t hash) { return((size_t)(((hash >> 32) * shardCount) >> 32)); };
+
+	RunTasks(pWorkerPool, shardCount, [&](size_t shard)
+	{
+		size_t shardCorners = 0;
+		for (size_t c = 0; c < cornerCount; c++)
+		{
+			shardCorners += (GetShard(cornerHashes[c]) == shard) ? 1 : 0;
+		}
+
+		size_t mask = GetTableSize(shardCorners) - 1;
+		std::vector<uint32_t> table(mask + 1, EMPTY_SLOT);
+		std::vector<uint32_t>& firstCorners = shardFirstCorners[shard];
+		firstCorners.reserve(shardCorners / 2);
+
+		for (size_t c = 0; c < cornerCount; c++)
+		{
+			uint64_t hash = cornerHashes[c];
+			if (GetShard(hash) != shard)
+			{
+				continue;
+			}
+
+			const OBJ_CORNER& corner = corners[c];
+			size_t slot = hash & mask;
+			for (;;)
+			{
+				uint32_t entry = table[slot];
+				if (entry == EMPTY_SLOT)
+				{
+					table[slot] = (uint32_t)firstCorners.size();
+					cornerVertex[c] = (uint32_t)firstCorners.size();
+					firstCorners.push_back((uint32_t)c);
+					break;
+				}
+				const OBJ_CORNER& other = corners[firstCorners[entry]];
+				if ((other.index[0] == corner.index[0]) && (other.index[1] == corner.index[1]) && (other.index[2] == corner.index[2]))
+				{
+					cornerVertex[c] = entry;
+					break;
+				}
+				slot = (slot + 1) & mask;
+			}
+		}
+	});
+
+	std::vector<size_t> shardBase(shardCount);
+	size_t vertexCount = 0;
+	for (size_t shard = 0; shard < shardCount; shard++)
+	{
+		shardBase[shard] = vertexCount;
+		vertexCount += shardFirstCorners[shard].size();
+	}
+
+	// smooth normals from the faces around each position, for
+	// the corners that do not reference a normal
+	const std::vector<float>& positions = attributes[0];
+	std::vector<float> smoothNormals;
+	bool bMissingNormals = false;
+	for (size_t c = 0; (c < cornerCount) && (bMissingNormals == false); c++)
+	{
+		bMissingNormals = (corners[c].index[2] == OBJ_NO_INDEX);
+	}
+	if (bMissingNormals)
+	{
+		smoothNormals.assign(positions.size(), 0.0f);
+		for (size_t c = 0; c < cornerCount; c += 3)
+		{
+			const float* p0 = &positions[corners[c].index[0] * 3];
+			const float* p1 = &positions[corners[c + 1].index[0] * 3];
+			const float* p2 = &positions[corners[c + 2].index[0] * 3];
+			glm::vec3 faceNormal = glm::cross(
+				glm::vec3(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]),
+				glm::vec3(p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]));
+			for (size_t k = 0; k < 3; k++)
+			{
+				float* pNormal = &smoothNormals[corners[c + k].index[0] * 3];
+				pNormal[0] += faceNormal.x;
+				pNormal[1] += faceNormal.y;
+				pNormal[2] += faceNormal.z;
+			}
+		}
+	}
+
+	// write the interleaved vertices and the final indices
+	mesh.vertices.resize(vertexCount);
+	mesh.indices.resize(cornerCount);
+
+	RunTasks(pWorkerPool, shardCount, [&](size_t shard)
+	{
+		const std::vector<uint32_t>& firstCorners = shardFirstCorners[shard];
+		for (size_t v = 0; v < firstCorners.size(); v++)
+		{
+			const OBJ_CORNER& corner = corners[firstCorners[v]];
+			MESH_VERTEX& vertex = mesh.vertices[shardBase[shard] + v];
+
+			memcpy(vertex.position, &positions[corner.index[0] * 3], sizeof(vertex.position));
+
+			const float* pNormal = (corner.index[2] != OBJ_NO_INDEX) ? &attributes[2][corner.index[2] * 3] : &smoothNormals[corner.index[0] * 3];
+			glm::vec3 normal = glm::vec3(pNormal[0], pNormal[1], pNormal[2]);
+			float length = glm::length(normal);
+			normal = (length > 0.0f) ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+			vertex.normal[0] = normal.x;
+			vertex.normal[1] = normal.y;
+			vertex.normal[2] = normal.z;
+
+			if (corner.index[1] != OBJ_NO_INDEX)
+			{
+				memcpy(vertex.textureCoordinate, &attributes[1][corner.index[1] * 2], sizeof(vertex.textureCoordinate));
+			}
+			else
+			{
+				vertex.textureCoordinate[0] = 0.0f;
+				vertex.textureCoordinate[1] = 0.0f;
+			}
+		}
+	});
+
+	size_t blockCount = (cornerCount + PARALLEL_BLOCK_SIZE - 1) / PARALLEL_BLOCK_SIZE;
+	RunTasks(pWorkerPool, blockCount, [&](size_t block)
+	{
+		size_t end = std::min(cornerCount, (block + 1) * PARALLEL_BLOCK_SIZE);
+		for (size_t c = block * PARALLEL_BLOCK_SIZE; c < end; c++)
+		{
+			mesh.indices[c] = (uint32_t)(shardBase[GetShard(cornerHashes[c])] + cornerVertex[c]);
+		}
+	});
+
+	return(true);
+}
+
+/***********************************************************
+ *  LoadGLTF()
+ *
+ *  This method is used for loading a glTF 2.0 file.  The
+ *  triangle primitives of the nodes in the default scene
+ *  are read in parallel, transformed into world space, and
+ *  combined into one mesh.  Materials, skins and animations
+ *  are not read.
+ ***********************************************************/
+bool ModelLoader::LoadGLTF(const std::string& filename, MESH_DATA& mesh, WorkerPool* pWorkerPool)
+{
+	MappedFile file;
+	if (file.Open(filename) == false)
+	{
+		std::cout << "Could not open model:" << filename << std::endl;
+		return(false);
+	}
+
+	const unsigned char* pData = file.GetData();
+	size_t size = file.GetSize();
+	const char* pJSON = (const char*)pData;
+	size_t jsonSize = size;
+	const unsigned char* pBinaryChunk = NULL;
+	size_t binaryChunkSize = 0;
+
+	// the binary container holds a JSON chunk followed by an
+	// optional chunk with the first buffer
+	uint32_t header[3] = { 0, 0, 0 };
+	if (size >= sizeof(header))
+	{
+		memcpy(header, pData, sizeof(header));
+	}
+	if (header[0] == GLB_MAGIC)
+	{
+		pJSON = NULL;
+		size_t offset = sizeof(header);
+		size_t length = std::min<size_t>(header[2], size);
+		while (offset + 8 <= length)
+		{
+			uint32_t chunkHeader[2];
+			memcpy(chunkHeader, pData + offset, sizeof(chunkHeader));
+			offset += 8;
+			if (chunkHeader[0] > length - offset)
+			{
+				break;
+			}
+			if ((chunkHeader[1] == GLB_CHUNK_JSON) && (pJSON == NULL))
+			{
+				pJSON = (const char*)(pData + offset);
+				jsonSize = chunkHeader[0];
+			}
+			else if ((chunkHeader[1] == GLB_CHUNK_BIN) && (pBinaryChunk == NULL))
+			{
+				pBinaryChunk = pData + offset;
+				binaryChunkSize = chunkHeader[0];
+			}
+			offset += chunkHeader[0];
+		}
+		if (pJSON == NULL)
+		{
+			std::cout << "Invalid binary glTF file:" << filename << std::endl;
+			return(false);
+		}
+	}
+
+	GLTF_DOCUMENT document;
+	const char* p = pJSON;
+	if ((ParseJSONValue(p, pJSON + jsonSize, document.root, 0) == false) ||
+		(document.root.type != JSON_VALUE::JSON_OBJECT))
+	{
+		std::cout << "Invalid glTF JSON:" << filename << std::endl;
+		return(false);
+	}
+
+	std::string version = GetString(FindMember(&document.root, "asset"), "version");
+	if (version.compare(0, 2, "2.") != 0)
+	{
+		std::cout << "Unsupported glTF version " << version << ":" << filename << std::endl;
+		return(false);
+	}
+
+	// compressed geometry cannot be read without a decoder
+	const JSON_VALUE* pRequired = FindMember(&document.root, "extensionsRequired");
+	if (pRequired != NULL)
+	{
+		for (size_t i = 0; i < pRequired->elements.size(); i++)
+		{
+			const std::string& extension = pRequired->elements[i].text;
+			if ((extension.compare(0, 14, "KHR_materials_") != 0) &&
+				(extension != "KHR_texture_transform") &&
+				(extension != "KHR_mesh_quantization"))
+			{
+				std::cout << "Unsupported glTF extension " << extension << ":" << filename << std::endl;
+				return(false);
+			}
+		}
+	}
+
+	if (LoadGLTFBuffers(filename, document, pBinaryChunk, binaryChunkSize) == false)
+	{
+		return(false);
+	}
+
+	// gather the primitives of the default scene, or of every
+	// mesh when the file has no scenes
+	std::vector<GLTF_PRIMITIVE_INSTANCE> instances;
+	const JSON_VALUE* pScenes = FindMember(&document.root, "scenes");
+	if (pScenes != NULL)
+	{
+		int sceneIndex = (int)GetNumber(&document.root, "scene", 0.0);
+		const JSON_VALUE* pSceneNodes = FindMember(GetElement(pScenes, sceneIndex), "nodes");
+		for (size_t i = 0; (pSceneNodes != NULL) && (i < pSceneNodes->elements.size()); i++)
+		{
+			CollectGLTFNode(document, (int)pSceneNodes->elements[i].number, glm::mat4(1.0f), 0, instances);
+		}
+	}
+	else
+	{
+		const JSON_VALUE* pMeshes = FindMember(&document.root, "meshes");
+		for (size_t m = 0; (pMeshes != NULL) && (m < pMeshes->elements.size()); m++)
+		{
+			const JSON_VALUE* pPrimitives = FindMember(&pMeshes->elements[m], "primitives");
+			for (size_t i = 0; (pPrimitives != NULL) && (i < pPrimitives->elements.size()); i++)
+			{
+				GLTF_PRIMITIVE_INSTANCE instance;
+				instance.pPrimitive = &pPrimitives->elements[i];
+				instance.transform = glm::mat4(1.0f);
+				instances.push_back(instance);
+			}
+		}
+	}
+
+	std::vector<MESH_DATA> parts(instances.size());
+	std::vector<char> partLoaded(instances.size(), 0);
+	RunTasks(pWorkerPool, instances.size(), [&](size_t i)
+	{
+		partLoaded[i] = LoadGLTFPrimitive(document, instances[i], parts[i]) ? 1 : 0;
+	});
+
+	// combine the primitives into one mesh
+	std::vector<size_t> vertexBase(parts.size());
+	std::vector<size_t> indexBase(parts.size());
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+	for (size_t i = 0; i < parts.size(); i++)
+	{
+		if (partLoaded[i] == 0)
+		{
+			std::cout << "Invalid glTF primitive data:" << filename << std::endl;
+			return(false);
+		}
+		vertexBase[i] = vertexCount;
+		indexBase[i] = indexCount;
+		vertexCount += parts[i].vertices.size();
+		indexCount += parts[i].indices.size();
+	}
+	if ((indexCount == 0) || (vertexCount > EMPTY_SLOT))
+	{
+		std::cout << "Model has no usable triangles:" << filename << std::endl;
+		return(false);
+	}
+
+	mesh.vertices.resize(vertexCount);
+	mesh.indices.resize(indexCount);
+	RunTasks(pWorkerPool, parts.size(), [&](size_t i)
+	{
+		std::copy(parts[i].vertices.begin(), parts[i].vertices.end(), mesh.vertices.begin() + vertexBase[i]);
+		for (size_t k = 0; k < parts[i].indices.size(); k++)
+		{
+			mesh.indices[indexBase[i] + k] = (uint32_t)(parts[i].indices[k] + vertexBase[i]);
+		}
+	});
+
+	return(true);
+}
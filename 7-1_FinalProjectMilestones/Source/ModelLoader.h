@@ -0,0 +1,34 @@
+///////////////////////////////////////////////////////////////////////////////
+// modelloader.h
+// ============
+// read external OBJ and glTF model files into mesh data
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+#include "WorkerPool.h"
+
+#include <string>
+
+/***********************************************************
+ *  ModelLoader
+ *
+ *  This class contains the code for reading model files
+ *  that were made in other tools.  Wavefront OBJ files and
+ *  glTF 2.0 files (.gltf with external or embedded buffers,
+ *  and binary .glb) are supported.  The files are memory
+ *  mapped and parsed on the worker pool, and the result is
+ *  a single indexed triangle list of interleaved vertices
+ *  that can be copied into OpenGL buffers as it is.
+ ***********************************************************/
+class ModelLoader
+{
+public:
+	// load a model file, choosing the format from its extension
+	static bool LoadModel(const std::string& filename, MESH_DATA& mesh, WorkerPool* pWorkerPool);
+	// load a Wavefront OBJ file
+	static bool LoadOBJ(const std::string& filename, MESH_DATA& mesh, WorkerPool* pWorkerPool);
+	// load a glTF 2.0 text or binary file
+	static bool LoadGLTF(const std::string& filename, MESH_DATA& mesh, WorkerPool* pWorkerPool);
+};
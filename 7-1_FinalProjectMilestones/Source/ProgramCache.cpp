@@ -0,0 +1,466 @@
+///////////////////////////////////////////////////////////////////////////////
+// programcache.cpp
+// ============
+// save and load linked shader program binaries to and from a file cache
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ProgramCache.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// "PRGC" in little endian byte order
+	const uint32_t PROGRAM_CACHE_MAGIC = 0x43475250;
+	// must be increased whenever the file layout changes
+	const uint32_t PROGRAM_CACHE_VERSION = 1;
+
+	/***********************************************************
+	 *  PROGRAM_CACHE_HEADER
+	 *
+	 *  The header at the start of every cache file, followed
+	 *  by the program binary.
+	 ***********************************************************/
+	struct PROGRAM_CACHE_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceKey;
+		uint64_t driverKey;
+		uint32_t binaryFormat;
+		uint32_t binaryLength;
+	};
+
+	/***********************************************************
+	 *  ReadSourceFile()
+	 *
+	 *  Read the whole of a shader source file into a string.
+	 ***********************************************************/
+	bool ReadSourceFile(const char* filename, std::string& source)
+	{
+		std::ifstream input(filename, std::ios::binary);
+		if (!input)
+		{
+			std::cout << "Could not open shader source file:" << filename << std::endl;
+			return(false);
+		}
+
+		std::stringstream contents;
+		contents << input.rdbuf();
+		source = contents.str();
+		return(true);
+	}
+
+	/***********************************************************
+	 *  GetDriverString()
+	 *
+	 *  Get the text that identifies the driver, since program
+	 *  binaries are only valid for the driver that made them.
+	 ***********************************************************/
+	std::string GetDriverString()
+	{
+		const char* pVendor = (const char*)glGetString(GL_VENDOR);
+		const char* pRenderer = (const char*)glGetString(GL_RENDERER);
+		const char* pVersion = (const char*)glGetString(GL_VERSION);
+
+		std::string driver;
+		driver += (NULL != pVendor) ? pVendor : "";
+		driver += "|";
+		driver += (NULL != pRenderer) ? pRenderer : "";
+		driver += "|";
+		driver += (NULL != pVersion) ? pVersion : "";
+		return(driver);
+	}
+
+	/***********************************************************
+	 *  SubmitShader()
+	 *
+	 *  Start compiling one shader stage, without waiting for
+	 *  the result.
+	 ***********************************************************/
+	GLuint SubmitShader(GLenum stage, const std::string& source)
+	{
+		GLuint shader = glCreateShader(stage);
+		const char* pSource = source.c_str();
+		glShaderSource(shader, 1, &pSource, NULL);
+		glCompileShader(shader);
+		return(shader);
+	}
+
+	/***********************************************************
+	 *  CheckShader()
+	 *
+	 *  Check that a shader compiled, printing the log if not.
+	 ***********************************************************/
+	bool CheckShader(GLuint shader, const char* stageName)
+	{
+		GLint status = GL_FALSE;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+		if (status == GL_TRUE)
+		{
+			return(true);
+		}
+
+		GLint logLength = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+		std::vector<char> log(logLength + 1, '\0');
+		glGetShaderInfoLog(shader, (GLsizei)log.size(), NULL, log.data());
+		std::cout << stageName << " shader failed to compile:" << std::endl << log.data() << std::endl;
+		return(false);
+	}
+}
+
+/***********************************************************
+ *  ProgramCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ProgramCache::ProgramCache(std::string cacheDirectory)
+{
+	m_cacheDirectory = cacheDirectory;
+
+	// binaries can only be used when the driver supports at
+	// least one binary format
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	m_bCacheSupported = (formatCount > 0);
+
+	// let the driver use as many compiler threads as it likes
+	m_bParallelCompile = (GLEW_KHR_parallel_shader_compile == GL_TRUE);
+	if (m_bParallelCompile)
+	{
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	}
+}
+
+/***********************************************************
+ *  ~ProgramCache()
+ *
+ *  The destructor for the class, which finishes the builds
+ *  that were never waited for and deletes their programs.
+ ***********************************************************/
+ProgramCache::~ProgramCache()
+{
+	for (int i = 0; i < (int)m_builds.size(); i++)
+	{
+		if (m_builds[i].bFinished == false)
+		{
+			glDeleteProgram(FinishProgram(i));
+		}
+	}
+}
+
+/***********************************************************
+ *  GetCacheFilename()
+ *
+ *  This method is used for getting the path of the cache
+ *  file of a pair of shader source files.  One file is kept
+ *  per pair, and it is replaced when the sources change.
+ ***********************************************************/
+std::string ProgramCache::GetCacheFilename(const std::string& vertexFilename, const std::string& fragmentFilename)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx",
+		(unsigned long long)MeshCache::HashKey(vertexFilename + "|" + fragmentFilename));
+	return(m_cacheDirectory + "/" + name + ".program");
+}
+
+/***********************************************************
+ *  BeginProgram()
+ *
+ *  This method is used for submitting a program.  A binary
+ *  in the cache whose keys match the sources and driver is
+ *  handed to the driver, and otherwise both stages are
+ *  compiled and the program is linked without checking the
+ *  results, which is left to FinishProgram().
+ ***********************************************************/
+int ProgramCache::BeginProgram(const char* vertexFilename, const char* fragmentFilename)
+{
+	PROGRAM_BUILD build;
+	build.startTime = std::chrono::steady_clock::now();
+	build.program = 0;
+	build.vertexShader = 0;
+	build.fragmentShader = 0;
+	build.bFromCache = false;
+	build.bFinished = false;
+
+	std::string vertexSource;
+	std::string fragmentSource;
+	if ((ReadSourceFile(vertexFilename, vertexSource) == false) ||
+		(ReadSourceFile(fragmentFilename, fragmentSource) == false))
+	{
+		return(-1);
+	}
+
+	build.sourceKey = MeshCache::HashKey(vertexSource + '\0' + fragmentSource);
+	build.driverKey = MeshCache::HashKey(GetDriverString());
+	build.filename = GetCacheFilename(vertexFilename, fragmentFilename);
+
+	if (m_bCacheSupported)
+	{
+		build.program = LoadBinary(build.filename, build.sourceKey, build.driverKey);
+		build.bFromCache = (build.program != 0);
+	}
+
+	if (build.program == 0)
+	{
+		build.vertexShader = SubmitShader(GL_VERTEX_SHADER, vertexSource);
+		build.fragmentShader = SubmitShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+		build.program = glCreateProgram();
+		glAttachShader(build.program, build.vertexShader);
+		glAttachShader(build.program, build.fragmentShader);
+		if (m_bCacheSupported)
+		{
+			// the driver is told before linking that the binary
+			// will be read back for the cache
+			glProgramParameteri(build.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+		glLinkProgram(build.program);
+	}
+
+	m_builds.push_back(build);
+	return((int)m_builds.size() - 1);
+}
+
+/***********************************************************
+ *  IsProgramReady()
+ *
+ *  This method is used for checking whether a build has
+ *  finished.  Without KHR_parallel_shader_compile the check
+ *  would wait for the driver, so the build is reported as
+ *  ready and FinishProgram() does the waiting.
+ ***********************************************************/
+bool ProgramCache::IsProgramReady(int build)
+{
+	if ((build < 0) || (build >= (int)m_builds.size()))
+	{
+		return(true);
+	}
+
+	const PROGRAM_BUILD& programBuild = m_builds[build];
+	if ((programBuild.bFinished) || (programBuild.bFromCache) || (m_bParallelCompile == false))
+	{
+		return(true);
+	}
+
+	GLint status = GL_FALSE;
+	glGetProgramiv(programBuild.program, GL_COMPLETION_STATUS_KHR, &status);
+	return(status == GL_TRUE);
+}
+
+/***********************************************************
+ *  IsLoadedFromCache()
+ *
+ *  This method is used for checking whether a build was
+ *  loaded from the cache, so there is nothing to compile.
+ ***********************************************************/
+bool ProgramCache::IsLoadedFromCache(int build) const
+{
+	if ((build < 0) || (build >= (int)m_builds.size()))
+	{
+		return(false);
+	}
+
+	return(m_builds[build].bFromCache);
+}
+
+/***********************************************************
+ *  FinishProgram()
+ *
+ *  This method is used for waiting for a build and checking
+ *  its results.  A newly compiled program has its binary
+ *  written to the cache.  The program belongs to the caller
+ *  once it is returned.
+ ***********************************************************/
+GLuint ProgramCache::FinishProgram(int build)
+{
+	if ((build < 0) || (build >= (int)m_builds.size()) || (m_builds[build].bFinished))
+	{
+		return(0);
+	}
+
+	PROGRAM_BUILD& programBuild = m_builds[build];
+	programBuild.bFinished = true;
+	GLuint program = programBuild.program;
+
+	if (programBuild.bFromCache == false)
+	{
+		bool bCompiled = CheckShader(programBuild.vertexShader, "Vertex");
+		bCompiled = CheckShader(programBuild.fragmentShader, "Fragment") && bCompiled;
+
+		GLint status = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+		if ((bCompiled) && (status != GL_TRUE))
+		{
+			GLint logLength = 0;
+			glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+			std::vector<char> log(logLength + 1, '\0');
+			glGetProgramInfoLog(program, (GLsizei)log.size(), NULL, log.data());
+			std::cout << "Shader program failed to link:" << std::endl << log.data() << std::endl;
+		}
+
+		// the shaders are no longer needed once the program is linked
+		glDetachShader(program, programBuild.vertexShader);
+		glDetachShader(program, programBuild.fragmentShader);
+		glDeleteShader(programBuild.vertexShader);
+		glDeleteShader(programBuild.fragmentShader);
+
+		if ((bCompiled == false) || (status != GL_TRUE))
+		{
+			glDeleteProgram(program);
+			return(0);
+		}
+
+		if (m_bCacheSupported)
+		{
+			SaveBinary(programBuild.filename, programBuild.sourceKey, programBuild.driverKey, program);
+		}
+	}
+
+	double buildMs = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - programBuild.startTime).count();
+	std::cout << (programBuild.bFromCache ? "Loaded shader program from the cache in " : "Compiled shader program in ")
+		<< buildMs << " ms" << std::endl;
+
+	return(program);
+}
+
+/***********************************************************
+ *  LoadProgram()
+ *
+ *  This method is used for building a program and waiting
+ *  for it, when there is nothing else to do meanwhile.
+ ***********************************************************/
+GLuint ProgramCache::LoadProgram(const char* vertexFilename, const char* fragmentFilename)
+{
+	return(FinishProgram(BeginProgram(vertexFilename, fragmentFilename)));
+}
+
+/***********************************************************
+ *  LoadBinary()
+ *
+ *  This method is used for creating a program from the
+ *  binary in a cache file.  The driver can still reject a
+ *  binary whose keys match, such as after an update that
+ *  kept the version string, so the link status is checked.
+ ***********************************************************/
+GLuint ProgramCache::LoadBinary(const std::string& filename, uint64_t sourceKey, uint64_t driverKey)
+{
+	MappedFile file;
+	if (file.Open(filename) == false)
+	{
+		return(0);
+	}
+
+	if (file.GetSize() < sizeof(PROGRAM_CACHE_HEADER))
+	{
+		return(0);
+	}
+
+	PROGRAM_CACHE_HEADER header;
+	memcpy(&header, file.GetData(), sizeof(header));
+	if ((header.magic != PROGRAM_CACHE_MAGIC) ||
+		(header.version != PROGRAM_CACHE_VERSION) ||
+		(header.sourceKey != sourceKey) ||
+		(header.driverKey != driverKey))
+	{
+		return(0);
+	}
+
+	if (file.GetSize() != sizeof(header) + header.binaryLength)
+	{
+		std::cout << "Ignoring truncated shader program cache file" << std::endl;
+		return(0);
+	}
+
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, (GLenum)header.binaryFormat, file.GetData() + sizeof(header), (GLsizei)header.binaryLength);
+
+	GLint status = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		std::cout << "The driver rejected the cached shader program, compiling it again" << std::endl;
+		glDeleteProgram(program);
+		return(0);
+	}
+
+	return(program);
+}
+
+/***********************************************************
+ *  SaveBinary()
+ *
+ *  This method is used for writing the binary of a linked
+ *  program into the cache.  The data is written to a
+ *  temporary file first and then renamed, so a partly
+ *  written file is never loaded.
+ ***********************************************************/
+bool ProgramCache::SaveBinary(const std::string& filename, uint64_t sourceKey, uint64_t driverKey, GLuint program)
+{
+	GLint binaryLength = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if (binaryLength <= 0)
+	{
+		return(false);
+	}
+
+	std::vector<unsigned char> binary(binaryLength);
+	GLenum binaryFormat = 0;
+	GLsizei writtenLength = 0;
+	glGetProgramBinary(program, binaryLength, &writtenLength, &binaryFormat, binary.data());
+	if (writtenLength <= 0)
+	{
+		return(false);
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(m_cacheDirectory, error);
+	std::string tempFilename = MeshCache::GetTempFilename(filename);
+
+	PROGRAM_CACHE_HEADER header;
+	header.magic = PROGRAM_CACHE_MAGIC;
+	header.version = PROGRAM_CACHE_VERSION;
+	header.sourceKey = sourceKey;
+	header.driverKey = driverKey;
+	header.binaryFormat = (uint32_t)binaryFormat;
+	header.binaryLength = (uint32_t)writtenLength;
+
+	{
+		std::ofstream output(tempFilename, std::ios::binary | std::ios::trunc);
+		if (!output)
+		{
+			std::cout << "Could not write shader program cache file:" << tempFilename << std::endl;
+			return(false);
+		}
+
+		output.write((const char*)&header, sizeof(header));
+		output.write((const char*)binary.data(), writtenLength);
+		if (!output)
+		{
+			output.close();
+			std::filesystem::remove(tempFilename, error);
+			return(false);
+		}
+	}
+
+	std::filesystem::rename(tempFilename, filename, error);
+	if (error)
+	{
+		std::filesystem::remove(tempFilename, error);
+		return(false);
+	}
+
+	return(true);
+}
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// programcache.h
+// ============
+// save and load linked shader program binaries to and from a file cache
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  ProgramCache
+ *
+ *  This class contains the code for building shader programs
+ *  from their vertex and fragment source files, and for
+ *  storing the linked binary of each program in a file.
+ *  Later runs load the binary instead of compiling the
+ *  sources again.  Each entry records a key of the sources
+ *  and of the driver that produced it, and the program is
+ *  compiled again whenever either has changed or the driver
+ *  rejects the binary.
+ *
+ *  Programs are built in two steps, so that every program
+ *  can be submitted to the driver before waiting for any of
+ *  them.  Where KHR_parallel_shader_compile is supported the
+ *  driver compiles them on its own threads, and a build can
+ *  be checked for completion without blocking.
+ ***********************************************************/
+class ProgramCache
+{
+public:
+	// constructor
+	ProgramCache(std::string cacheDirectory);
+	// destructor
+	~ProgramCache();
+
+	// submit a program for building, returning the build
+	// number or -1 when the sources could not be read
+	int BeginProgram(const char* vertexFilename, const char* fragmentFilename);
+	// check without blocking whether a build has finished
+	bool IsProgramReady(int build);
+	// check whether a build was loaded from the cache
+	bool IsLoadedFromCache(int build) const;
+	// wait for a build, returning the program or 0 when it
+	// could not be built
+	GLuint FinishProgram(int build);
+
+	// build a program and wait for it
+	GLuint LoadProgram(const char* vertexFilename, const char* fragmentFilename);
+
+private:
+	/***********************************************************
+	 *  PROGRAM_BUILD
+	 *
+	 *  A submitted program, with the shaders that are being
+	 *  compiled when it did not come from the cache.
+	 ***********************************************************/
+	struct PROGRAM_BUILD
+	{
+		std::string filename;
+		uint64_t sourceKey;
+		uint64_t driverKey;
+		GLuint program;
+		GLuint vertexShader;
+		GLuint fragmentShader;
+		bool bFromCache;
+		bool bFinished;
+		std::chrono::steady_clock::time_point startTime;
+	};
+
+	// folder that holds the cache files
+	std::string m_cacheDirectory;
+	// the submitted builds, by build number
+	std::vector<PROGRAM_BUILD> m_builds;
+	// whether binaries can be cached, and completion checked
+	bool m_bCacheSupported;
+	bool m_bParallelCompile;
+
+	// get the cache filename for a pair of source files
+	std::string GetCacheFilename(const std::string& vertexFilename, const std::string& fragmentFilename);
+	// create a program from a cached binary
+	GLuint LoadBinary(const std::string& filename, uint64_t sourceKey, uint64_t driverKey);
+	// write the binary of a linked program into the cache
+	bool SaveBinary(const std::string& filename, uint64_t sourceKey, uint64_t driverKey, GLuint program);
+};
@@ -0,0 +1,220 @@
+///////////////////////////////////////////////////////////////////////////////
+// qualitymanager.cpp
+// ============
+// select the rendering quality tier that the machine can sustain
+///////////////////////////////////////////////////////////////////////////////
+
+#include "QualityManager.h"
+#include "GLStateCache.h"
+#include "RenderTarget.h"
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+// declaration of global variables
+namespace
+{
+	// the tiers from the lowest to the highest quality
+	const QUALITY_TIER QUALITY_TIERS[] =
+	{
+		{ "low", false, 1, 1.0f, 1.0f },
+		{ "medium", true, 2, 0.5f, 0.5f },
+		{ "high", true, 4, 0.0f, 0.0f },
+	};
+	const int QUALITY_TIER_COUNT = sizeof(QUALITY_TIERS) / sizeof(QUALITY_TIERS[0]);
+
+	// the benchmark renders a still view of the scene, so a
+	// tier must fit in this share of a 60 Hz frame to leave
+	// room for camera movement and the rest of the frame
+	const double BENCHMARK_FRAME_BUDGET_MS = (1000.0 / 60.0) * 0.5;
+	// frames rendered before and during each measurement
+	const int BENCHMARK_WARMUP_FRAMES = 2;
+	const int BENCHMARK_MEASURED_FRAMES = 8;
+
+	const char* g_PerVertexLightingName = "bPerVertexLighting";
+	const char* g_LightCountName = "activeLightCount";
+}
+
+/***********************************************************
+ *  QualityManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+QualityManager::QualityManager(UniformManager* pUniformManager, SceneManager* pSceneManager)
+{
+	m_pUniformManager = pUniformManager;
+	m_pSceneManager = pSceneManager;
+	m_tierIndex = QUALITY_TIER_COUNT - 1;
+}
+
+/***********************************************************
+ *  ~QualityManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+QualityManager::~QualityManager()
+{
+	m_pUniformManager = NULL;
+	m_pSceneManager = NULL;
+}
+
+/***********************************************************
+ *  IsTierName()
+ *
+ *  This method is used for checking a tier name from the
+ *  command line before anything is loaded.
+ ***********************************************************/
+bool QualityManager::IsTierName(std::string name)
+{
+	for (int i = 0; i < QUALITY_TIER_COUNT; i++)
+	{
+		if (QUALITY_TIERS[i].name == name)
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  SetTier()
+ *
+ *  This method is used for applying the quality tier with
+ *  the passed in name.  False is returned for an unknown
+ *  name, and the applied tier is not changed.
+ ***********************************************************/
+bool QualityManager::SetTier(std::string name)
+{
+	for (int i = 0; i < QUALITY_TIER_COUNT; i++)
+	{
+		if (QUALITY_TIERS[i].name == name)
+		{
+			ApplyTier(i);
+			return(true);
+		}
+	}
+
+	std::cout << "Unknown quality tier: " << name << std::endl;
+	return(false);
+}
+
+/***********************************************************
+ *  SelectTierByBenchmark()
+ *
+ *  This method is used for picking the quality tier at
+ *  startup.  The scene is rendered offscreen at the passed
+ *  in size with each tier, from the highest down, and the
+ *  first tier whose frame time fits the budget is kept.  The
+ *  lowest tier is kept when none of them fit.  The view and
+ *  projection must be set before this is called.
+ ***********************************************************/
+void QualityManager::SelectTierByBenchmark(int width, int height)
+{
+	auto benchmarkStartTime = std::chrono::steady_clock::now();
+
+	int selectedTier = 0;
+	for (int i = QUALITY_TIER_COUNT - 1; i >= 0; i--)
+	{
+		ApplyTier(i);
+		double frameTime = MeasureFrameTime(width, height);
+		std::cout << "Quality tier " << QUALITY_TIERS[i].name << " renders in " << frameTime << " ms" << std::endl;
+
+		if (frameTime <= BENCHMARK_FRAME_BUDGET_MS)
+		{
+			selectedTier = i;
+			break;
+		}
+	}
+
+	ApplyTier(selectedTier);
+
+	std::chrono::duration<double, std::milli> benchmarkTime = std::chrono::steady_clock::now() - benchmarkStartTime;
+	std::cout << "Selected quality tier " << QUALITY_TIERS[selectedTier].name
+		<< " in " << benchmarkTime.count() << " ms" << std::endl;
+}
+
+/***********************************************************
+ *  GetTier()
+ *
+ *  This method is used for getting the applied quality tier.
+ ***********************************************************/
+const QUALITY_TIER& QualityManager::GetTier() const
+{
+	return(QUALITY_TIERS[m_tierIndex]);
+}
+
+/***********************************************************
+ *  ApplyTier()
+ *
+ *  This method is used for setting the lighting, texture and
+ *  mesh detail settings of a tier into the shader and the
+ *  scene.
+ ***********************************************************/
+void QualityManager::ApplyTier(int tierIndex)
+{
+	const QUALITY_TIER& tier = QUALITY_TIERS[tierIndex];
+	m_tierIndex = tierIndex;
+
+	if (NULL != m_pUniformManager)
+	{
+		m_pUniformManager->SetBoolValue(g_PerVertexLightingName, !tier.bPerPixelLighting);
+		m_pUniformManager->SetIntValue(g_LightCountName, tier.maxLights);
+	}
+
+	if (NULL != m_pSceneManager)
+	{
+		m_pSceneManager->SetTextureLODBias(tier.textureLODBias);
+		m_pSceneManager->SetMeshLODBias(tier.meshLODBias);
+	}
+}
+
+/***********************************************************
+ *  MeasureFrameTime()
+ *
+ *  This method is used for measuring the average time of
+ *  rendering the scene into an offscreen target.  Every
+ *  frame is finished before the next one starts, so the time
+ *  includes both the CPU work of issuing the draw calls and
+ *  the GPU work of drawing them.
+ ***********************************************************/
+double QualityManager::MeasureFrameTime(int width, int height)
+{
+	// a target that cannot be created counts as over budget,
+	// so the lower tiers are tried instead of the highest one
+	RenderTarget renderTarget;
+	if (renderTarget.Resize(width, height) == false)
+	{
+		std::cout << "Could not create the benchmark target, treating the tier as too slow" << std::endl;
+		return(std::numeric_limits<double>::infinity());
+	}
+	renderTarget.Bind(width, height);
+
+	GLStateCache::Enable(GL_DEPTH_TEST);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+	double totalTime = 0.0;
+	for (int i = 0; i < BENCHMARK_WARMUP_FRAMES + BENCHMARK_MEASURED_FRAMES; i++)
+	{
+		auto frameStartTime = std::chrono::steady_clock::now();
+
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		m_pSceneManager->RenderScene();
+		glFinish();
+
+		std::chrono::duration<double, std::milli> frameTime = std::chrono::steady_clock::now() - frameStartTime;
+		if (i >= BENCHMARK_WARMUP_FRAMES)
+		{
+			totalTime += frameTime.count();
+		}
+	}
+
+	// go back to drawing into the window
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, width, height);
+
+	return(totalTime / BENCHMARK_MEASURED_FRAMES);
+}
@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// qualitymanager.h
+// ============
+// select the rendering quality tier that the machine can sustain
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "UniformManager.h"
+#include "SceneManager.h"
+
+#include <string>
+
+/***********************************************************
+ *  QUALITY_TIER
+ *
+ *  The rendering settings that are changed together when the
+ *  quality is raised or lowered.
+ ***********************************************************/
+struct QUALITY_TIER
+{
+	std::string name;
+	// light each fragment instead of each vertex
+	bool bPerPixelLighting;
+	// number of the scene lights that are used, in the order
+	// they are set up by the scene
+	int maxLights;
+	// mipmap level bias of the scene textures
+	float textureLODBias;
+	// level of detail bias of the scene meshes
+	float meshLODBias;
+};
+
+/***********************************************************
+ *  QualityManager
+ *
+ *  This class contains the code for the quality tiers.  A
+ *  tier can be chosen by name, or picked at startup by a
+ *  short benchmark that renders the scene offscreen at each
+ *  tier, from the highest down, and keeps the first one that
+ *  fits the frame time budget.
+ ***********************************************************/
+class QualityManager
+{
+public:
+	// constructor
+	QualityManager(UniformManager* pUniformManager, SceneManager* pSceneManager);
+	// destructor
+	~QualityManager();
+
+	// true when a tier has the passed in name
+	static bool IsTierName(std::string name);
+	// apply the tier with the passed in name
+	bool SetTier(std::string name);
+	// apply the highest tier that renders within the budget
+	void SelectTierByBenchmark(int width, int height);
+	// get the applied tier
+	const QUALITY_TIER& GetTier() const;
+
+private:
+	// pointer to uniform manager object
+	UniformManager* m_pUniformManager;
+	// pointer to scene manager object
+	SceneManager* m_pSceneManager;
+	// index of the applied tier
+	int m_tierIndex;
+
+	// set the settings of a tier into the shader and scene
+	void ApplyTier(int tierIndex);
+	// measure the average time of rendering the scene
+	double MeasureFrameTime(int width, int height);
+};
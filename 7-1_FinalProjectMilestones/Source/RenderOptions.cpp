@@ -0,0 +1,289 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderoptions.cpp
+// ============
+// startup options that are read from the command line
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderOptions.h"
+
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+
+// declaration of helper functions
+namespace
+{
+	/***********************************************************
+	 *  ReadOptionValue()
+	 *
+	 *  Get the value of an option that was passed either as
+	 *  "--name=value" or as "--name value".
+	 ***********************************************************/
+	bool ReadOptionValue(int argc, char* argv[], int& index, const std::string& name, bool bHasValue, std::string& value)
+	{
+		if (bHasValue)
+		{
+			return(true);
+		}
+		if (index + 1 < argc)
+		{
+			value = argv[++index];
+			return(true);
+		}
+
+		std::cerr << "Missing value for option: " << name << std::endl;
+		return(false);
+	}
+
+	/***********************************************************
+	 *  ParseIntValue()
+	 *
+	 *  Convert an option value to a whole number that must be
+	 *  at least one.
+	 ***********************************************************/
+	bool ParseIntValue(const std::string& name, const std::string& value, int& number)
+	{
+		char* pEnd = NULL;
+		long parsed = strtol(value.c_str(), &pEnd, 10);
+		if ((value.empty()) || (*pEnd != '\0') || (parsed < 1) || (parsed > INT_MAX))
+		{
+			std::cerr << "Invalid value for option " << name << ": " << value << std::endl;
+			return(false);
+		}
+
+		number = (int)parsed;
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ParseFloatValue()
+	 *
+	 *  Convert an option value to a number that must not be
+	 *  negative.
+	 ***********************************************************/
+	bool ParseFloatValue(const std::string& name, const std::string& value, float& number)
+	{
+		char* pEnd = NULL;
+		double parsed = strtod(value.c_str(), &pEnd);
+		if ((value.empty()) || (*pEnd != '\0') || (parsed < 0.0))
+		{
+			std::cerr << "Invalid value for option " << name << ": " << value << std::endl;
+			return(false);
+		}
+
+		number = (float)parsed;
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  ParseRenderOptions()
+ *
+ *  This function is used for reading the command line
+ *  arguments into the passed in options.  False is returned
+ *  for unknown or malformed arguments.
+ ***********************************************************/
+bool ParseRenderOptions(int argc, char* argv[], RENDER_OPTIONS& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string name = argv[i];
+		std::string value;
+		bool bHasValue = false;
+
+		size_t equals = name.find('=');
+		if (equals != std::string::npos)
+		{
+			value = name.substr(equals + 1);
+			name = name.substr(0, equals);
+			bHasValue = true;
+		}
+
+		if ((name == "--packed-vertices") && (bHasValue == false))
+		{
+			options.bPackedVertices = true;
+		}
+		else if ((name == "--on-demand") && (bHasValue == false))
+		{
+			options.bOnDemand = true;
+		}
+		else if ((name == "--render-thread") && (bHasValue == false))
+		{
+			options.bRenderThread = true;
+		}
+		else if ((name == "--no-state-cache") && (bHasValue == false))
+		{
+			options.bStateCache = false;
+		}
+		else if (name == "--vsync")
+		{
+			if (ReadOptionValue(argc, argv, i, name, bHasValue, value) == false)
+			{
+				return(false);
+			}
+			if ((value != "on") && (value != "off") && (value != "adaptive"))
+			{
+				std::cerr << "Invalid value for option " << name << ": " << value << std::endl;
+				return(false);
+			}
+			options.vsync = value;
+		}
+		else if (name == "--max-fps")
+		{
+			if ((ReadOptionValue(argc, argv, i, name, bHasValue, value) == false) ||
+				(ParseFloatValue(name, value, options.maxFrameRate) == false))
+			{
+				return(false);
+			}
+		}
+		else if ((name == "--low-latency") && (bHasValue == false))
+		{
+			options.bLowLatency = true;
+		}
+		else if ((name == "--headless") && (bHasValue == false))
+		{
+			options.bHeadless = true;
+		}
+		else if (name == "--frames")
+		{
+			if ((ReadOptionValue(argc, argv, i, name, bHasValue, value) == false) ||
+				(ParseIntValue(name, value, options.headlessFrames) == false))
+			{
+				return(false);
+			}
+		}
+		else if (name == "--batch")
+		{
+			if (ReadOptionValue(argc, argv, i, name, bHasValue, value) == false)
+			{
+				return(false);
+			}
+			options.batchFilename = value;
+		}
+		else if (name == "--output-dir")
+		{
+			if (ReadOptionValue(argc, argv, i, name, bHasValue, value) == false)
+			{
+				return(false);
+			}
+			options.imageOutputDirectory = value;
+		}
+		else if (name == "--image-format")
+		{
+			if (ReadOptionValue(argc, argv, i, name, bHasValue, value) == false)
+			{
+				return(false);
+			}
+			if ((value != "png") && (value != "ppm"))
+			{
+				std::cerr << "Invalid value for option " << name << ": " << value << std::endl;
+				return(false);
+			}
+			options.imageFormat = value;
+		}
+		else if (name == "--tile-size")
+		{
+			if ((ReadOptionValue(argc, argv, i, name, bHasValue, value) == false) ||
+				(ParseIntValue(name, value, options.tileSize) == false))
+			{
+				return(false);
+			}
+		}
+		else if (name == "--server")
+		{
+			if (ReadOptionValue(argc, argv, i, name, bHasValue, value) == false)
+			{
+				return(false);
+			}
+			options.serverSocketPath = value;
+		}
+		else if ((name == "--capture") && (bHasValue == false))
+		{
+			options.bCapture = true;
+		}
+		else if (name == "--shared-output")
+		{
+			if (ReadOptionValue(argc, argv, i, name, bHasValue, value) == false)
+			{
+				return(false);
+			}
+			if ((value.empty()) || (value.find('/') != std::string::npos))
+			{
+				std::cerr << "Invalid value for option " << name << ": " << value << std::endl;
+				return(false);
+			}
+			options.sharedOutputName = value;
+		}
+		else if (name == "--workers")
+		{
+			if ((ReadOptionValue(argc, argv, i, name, bHasValue, value) == false) ||
+				(ParseIntValue(name, value, options.batchWorkers) == false))
+			{
+				return(false);
+			}
+		}
+		else if (name == "--frame-budget-ms")
+		{
+			if ((ReadOptionValue(argc, argv, i, name, bHasValue, value) == false) ||
+				(ParseFloatValue(name, value, options.frameBudgetMs) == false))
+			{
+				return(false);
+			}
+		}
+		else if (name == "--quality")
+		{
+			if (ReadOptionValue(argc, argv, i, name, bHasValue, value) == false)
+			{
+				return(false);
+			}
+			options.quality = value;
+		}
+		else if (name == "--model")
+		{
+			if (ReadOptionValue(argc, argv, i, name, bHasValue, value) == false)
+			{
+				return(false);
+			}
+			options.modelFilename = value;
+		}
+		else
+		{
+			std::cerr << "Unknown option: " << name << std::endl;
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  PrintRenderOptionsUsage()
+ *
+ *  This function is used for printing the supported command
+ *  line arguments.
+ ***********************************************************/
+void PrintRenderOptionsUsage(const char* programName)
+{
+	std::cout << "Usage: " << programName << " [options]\n"
+		<< "  --packed-vertices        upload meshes in the compact 16 byte vertex format\n"
+		<< "  --on-demand              only redraw when the view or the scene changes\n"
+		<< "  --render-thread          render on a separate thread from the window events\n"
+		<< "  --no-state-cache         pass every GL state and uniform call on, for comparing\n"
+		<< "  --vsync <mode>           on, off, or adaptive to tear only when a frame is late\n"
+		<< "  --max-fps <rate>         pace the frames evenly at this rate, 0 for uncapped\n"
+		<< "  --low-latency            sample the input just before each frame is due\n"
+		<< "  --headless               render without a window, using EGL on Linux\n"
+		<< "  --frames <count>         number of frames rendered in headless mode\n"
+		<< "  --batch <file>           render the camera views listed in a file to images\n"
+		<< "  --workers <count>        split the batch views across this many processes\n"
+		<< "  --tile-size <pixels>     render larger batch views in tiles of this size\n"
+		<< "  --server <socket>        keep the scene loaded and render jobs sent to a socket\n"
+		<< "  --capture                save every rendered frame as an image\n"
+		<< "  --output-dir <dir>       directory the batch and captured images are written to\n"
+		<< "  --image-format <format>  png, or ppm for raw uncompressed images\n"
+		<< "  --shared-output <name>   publish every frame into a shared memory ring\n"
+		<< "  --frame-budget-ms <ms>   lower the render resolution to hold this GPU frame time\n"
+		<< "  --quality <tier>         low, medium, high, or auto to benchmark at startup\n"
+		<< "  --model <file>           add an OBJ, glTF or GLB model to the middle of the desk\n"
+		<< std::endl;
+}
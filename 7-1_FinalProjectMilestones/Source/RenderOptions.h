@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderoptions.h
+// ============
+// startup options that are read from the command line
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+
+/***********************************************************
+ *  RENDER_OPTIONS
+ *
+ *  The startup options of the application.  The defaults
+ *  give the same behavior as running without arguments.
+ ***********************************************************/
+struct RENDER_OPTIONS
+{
+	// upload meshes in the compact 16 bytes per vertex format
+	bool bPackedVertices = false;
+	// only draw a new frame when the view or the scene changed
+	bool bOnDemand = false;
+	// render on a thread other than the window event thread
+	bool bRenderThread = false;
+	// drop OpenGL state calls and uniform writes that would not
+	// change the state
+	bool bStateCache = true;
+	// swap interval of "on", "off" or "adaptive", or empty to
+	// keep the driver default
+	std::string vsync;
+	// most frames per second, which is uncapped when zero
+	float maxFrameRate = 0.0f;
+	// sample the input as late as possible before each frame
+	bool bLowLatency = false;
+	// render without a window into a framebuffer object, and
+	// exit after the passed in number of frames
+	bool bHeadless = false;
+	int headlessFrames = 1;
+	// text file of camera views that are rendered to image
+	// files, instead of showing the scene interactively
+	std::string batchFilename;
+	// directory and format of the batch and captured images
+	std::string imageOutputDirectory = "output";
+	std::string imageFormat = "png";
+	// number of processes that the batch views are split across
+	int batchWorkers = 1;
+	// size of the tiles that larger batch views are rendered
+	// in, where zero uses the largest size up to 4096
+	int tileSize = 0;
+	// Unix socket that the render server takes jobs on, or
+	// empty to show the scene interactively
+	std::string serverSocketPath;
+	// save every rendered frame to the image directory
+	bool bCapture = false;
+	// name of the shared memory that every rendered frame is
+	// published into, or empty for none
+	std::string sharedOutputName;
+	// GPU time target of a frame for dynamic resolution, which
+	// is turned off when zero
+	float frameBudgetMs = 0.0f;
+	// quality tier name, or "auto" to pick the tier with a
+	// benchmark at startup
+	std::string quality = "auto";
+	// OBJ or glTF model file that is added to the scene
+	std::string modelFilename;
+};
+
+// parse the command line arguments into the options structure
+bool ParseRenderOptions(int argc, char* argv[], RENDER_OPTIONS& options);
+// print the supported command line arguments
+void PrintRenderOptionsUsage(const char* programName);
@@ -0,0 +1,482 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderserver.cpp
+// ============
+// serve render jobs over a local socket with the scene kept loaded
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderServer.h"
+#include "ImageWriter.h"
+
+#ifndef _WIN32
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// largest image size that a job can ask for
+	const int MAX_IMAGE_SIZE = 16384;
+	// longest request line that a client can send
+	const size_t MAX_REQUEST_LENGTH = 4096;
+	// most clients that can be connected at once
+	const size_t MAX_CLIENTS = 64;
+
+#ifndef _WIN32
+	// set by SIGINT and SIGTERM to stop the server cleanly
+	volatile sig_atomic_t g_bStopSignaled = 0;
+
+	/***********************************************************
+	 *  StopSignalHandler()
+	 *
+	 *  Ask the server loop to stop at its next wakeup.
+	 ***********************************************************/
+	void StopSignalHandler(int)
+	{
+		g_bStopSignaled = 1;
+	}
+#endif
+}
+
+/***********************************************************
+ *  RenderServer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderServer::RenderServer(
+	ViewManager* pViewManager,
+	QualityManager* pQualityManager,
+	std::function<void()> drawFrame)
+{
+	m_pViewManager = pViewManager;
+	m_pQualityManager = pQualityManager;
+	m_drawFrame = drawFrame;
+	m_defaultTier = pQualityManager->GetTier().name;
+	m_listenSocket = -1;
+	m_bShutdown = false;
+	m_jobCount = 0;
+	m_totalJobMs = 0.0;
+	m_totalRenderMs = 0.0;
+}
+
+/***********************************************************
+ *  ~RenderServer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RenderServer::~RenderServer()
+{
+	Stop();
+	m_sharedOutput.Destroy();
+	m_renderTarget.Destroy();
+	m_pViewManager = NULL;
+	m_pQualityManager = NULL;
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for creating the listening socket.
+ *  A socket file left by a server that did not stop cleanly
+ *  is replaced, and the new one is only accessible to the
+ *  user that runs the server.
+ ***********************************************************/
+bool RenderServer::Start(const std::string& socketPath, const std::string& sharedOutputName)
+{
+	m_sharedOutputName = sharedOutputName;
+
+#ifdef _WIN32
+	std::cout << "The render server is not supported on this platform" << std::endl;
+	return(false);
+#else
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socketPath.size() >= sizeof(address.sun_path))
+	{
+		std::cout << "The socket path is too long: " << socketPath << std::endl;
+		return(false);
+	}
+	memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+	m_listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (m_listenSocket < 0)
+	{
+		std::cout << "Could not create the server socket: " << strerror(errno) << std::endl;
+		return(false);
+	}
+
+	unlink(socketPath.c_str());
+	if ((bind(m_listenSocket, (sockaddr*)&address, sizeof(address)) != 0) ||
+		(chmod(socketPath.c_str(), S_IRUSR | S_IWUSR) != 0) ||
+		(listen(m_listenSocket, 16) != 0))
+	{
+		std::cout << "Could not listen on " << socketPath << ": " << strerror(errno) << std::endl;
+		close(m_listenSocket);
+		m_listenSocket = -1;
+		return(false);
+	}
+	m_socketPath = socketPath;
+
+	// a client that disconnects mid-answer must not end the
+	// server, so the answers are sent with MSG_NOSIGNAL, and
+	// the stop signals only interrupt the wait for requests
+	g_bStopSignaled = 0;
+	signal(SIGINT, StopSignalHandler);
+	signal(SIGTERM, StopSignalHandler);
+
+	std::cout << "Render server listening on " << socketPath << std::endl;
+	return(true);
+#endif
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for waiting for requests and serving
+ *  them until a shutdown job arrives or the process is
+ *  signaled to stop.
+ ***********************************************************/
+void RenderServer::Run()
+{
+#ifndef _WIN32
+	std::vector<pollfd> pollSockets;
+
+	while ((m_bShutdown == false) && (g_bStopSignaled == 0) && (m_listenSocket >= 0))
+	{
+		pollSockets.clear();
+		pollSockets.push_back({ m_listenSocket, POLLIN, 0 });
+		for (const CLIENT& client : m_clients)
+		{
+			pollSockets.push_back({ client.socket, POLLIN, 0 });
+		}
+
+		if (poll(pollSockets.data(), pollSockets.size(), -1) < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			std::cout << "Render server wait failed: " << strerror(errno) << std::endl;
+			break;
+		}
+
+		// the clients are served before new ones are accepted,
+		// so the indexes still match the poll list
+		for (size_t i = m_clients.size(); i > 0; i--)
+		{
+			CLIENT& client = m_clients[i - 1];
+			short events = pollSockets[i].revents;
+			if (events == 0)
+			{
+				continue;
+			}
+
+			bool bKeepOpen = false;
+			char buffer[4096];
+			ssize_t received = recv(client.socket, buffer, sizeof(buffer), 0);
+			if (received > 0)
+			{
+				client.input.append(buffer, received);
+				bKeepOpen = true;
+
+				size_t lineEnd = std::string::npos;
+				while ((bKeepOpen) && (m_bShutdown == false) &&
+					((lineEnd = client.input.find('\n')) != std::string::npos))
+				{
+					std::string line = client.input.substr(0, lineEnd);
+					client.input.erase(0, lineEnd + 1);
+					bKeepOpen = HandleRequest(client, line);
+				}
+				if ((bKeepOpen) && (client.input.size() > MAX_REQUEST_LENGTH))
+				{
+					SendLine(client.socket, "ERROR request too long");
+					bKeepOpen = false;
+				}
+			}
+
+			if (bKeepOpen == false)
+			{
+				close(client.socket);
+				m_clients.erase(m_clients.begin() + (i - 1));
+			}
+		}
+
+		if (pollSockets[0].revents & POLLIN)
+		{
+			int clientSocket = accept(m_listenSocket, NULL, NULL);
+			if (clientSocket >= 0)
+			{
+				if (m_clients.size() < MAX_CLIENTS)
+				{
+					m_clients.push_back({ clientSocket, std::string() });
+				}
+				else
+				{
+					SendLine(clientSocket, "ERROR too many clients");
+					close(clientSocket);
+				}
+			}
+		}
+	}
+
+	if (m_jobCount > 0)
+	{
+		std::cout << "Render server served " << m_jobCount << " jobs, " << m_totalJobMs / m_jobCount
+			<< " ms per job with " << m_totalRenderMs / m_jobCount << " ms of rendering" << std::endl;
+	}
+#endif
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for closing the client connections
+ *  and the listening socket, and removing the socket file.
+ ***********************************************************/
+void RenderServer::Stop()
+{
+#ifndef _WIN32
+	for (const CLIENT& client : m_clients)
+	{
+		close(client.socket);
+	}
+	m_clients.clear();
+
+	if (m_listenSocket >= 0)
+	{
+		close(m_listenSocket);
+		m_listenSocket = -1;
+		unlink(m_socketPath.c_str());
+		signal(SIGINT, SIG_DFL);
+		signal(SIGTERM, SIG_DFL);
+	}
+#endif
+}
+
+/***********************************************************
+ *  HandleRequest()
+ *
+ *  This method is used for answering one request line.
+ *  False is returned when the connection must be closed.
+ ***********************************************************/
+bool RenderServer::HandleRequest(CLIENT& client, const std::string& line)
+{
+	std::string command = line.substr(0, line.find(' '));
+	if ((command.empty() == false) && (command.back() == '\r'))
+	{
+		command.pop_back();
+	}
+
+	if (command == "render")
+	{
+		std::string arguments = (command.size() < line.size()) ? line.substr(command.size() + 1) : std::string();
+		return(RenderJob(client, arguments));
+	}
+	if (command == "shutdown")
+	{
+		m_bShutdown = true;
+		return(SendLine(client.socket, "OK shutdown"));
+	}
+	if (command.empty())
+	{
+		return(true);
+	}
+
+	return(SendLine(client.socket, "ERROR unknown command: " + command));
+}
+
+/***********************************************************
+ *  RenderJob()
+ *
+ *  This method is used for rendering one job and sending
+ *  the answer.  The quality override only lasts for the job.
+ *  The frame is finished before it is read back, because
+ *  the answer needs it, so the time of a job is the render
+ *  time plus the readback and the encoding.
+ ***********************************************************/
+bool RenderServer::RenderJob(CLIENT& client, const std::string& arguments)
+{
+	auto jobStartTime = std::chrono::steady_clock::now();
+
+	std::istringstream fields(arguments);
+	int width = 0;
+	int height = 0;
+	glm::vec3 position;
+	glm::vec3 target;
+	fields >> width >> height >> position.x >> position.y >> position.z >> target.x >> target.y >> target.z;
+	if ((!fields) || (width < 1) || (height < 1) || (width > MAX_IMAGE_SIZE) || (height > MAX_IMAGE_SIZE))
+	{
+		return(SendLine(client.socket, "ERROR expected render <width> <height> <position> <target>"));
+	}
+
+	float fieldOfView = 45.0f;
+	std::string quality = m_defaultTier;
+	std::string format = "png";
+	std::string option;
+	while (fields >> option)
+	{
+		size_t equals = option.find('=');
+		std::string name = option.substr(0, equals);
+		std::string value = (equals != std::string::npos) ? option.substr(equals + 1) : std::string();
+
+		if (name == "fov")
+		{
+			char* pEnd = NULL;
+			fieldOfView = strtof(value.c_str(), &pEnd);
+			if ((value.empty()) || (*pEnd != '\0') || (fieldOfView <= 0.0f) || (fieldOfView >= 180.0f))
+			{
+				return(SendLine(client.socket, "ERROR invalid field of view: " + value));
+			}
+		}
+		else if ((name == "quality") && (QualityManager::IsTierName(value)))
+		{
+			quality = value;
+		}
+		else if ((name == "format") && ((value == "png") || (value == "ppm") || (value == "shm")))
+		{
+			format = value;
+		}
+		else
+		{
+			return(SendLine(client.socket, "ERROR invalid option: " + option));
+		}
+	}
+
+	if ((format == "shm") && (m_sharedOutput.GetName().empty()) &&
+		(m_sharedOutput.Create(m_sharedOutputName, width, height) == false))
+	{
+		return(SendLine(client.socket, "ERROR shared memory is not available"));
+	}
+
+	// render the job into the offscreen target, which only
+	// grows, and wait for the GPU to finish it
+	if (m_renderTarget.Resize(std::max(width, m_renderTarget.GetWidth()), std::max(height, m_renderTarget.GetHeight())) == false)
+	{
+		return(SendLine(client.socket, "ERROR could not allocate the render target"));
+	}
+	if (quality != m_pQualityManager->GetTier().name)
+	{
+		m_pQualityManager->SetTier(quality);
+	}
+
+	auto renderStartTime = std::chrono::steady_clock::now();
+	m_pViewManager->SetFramebufferSize(width, height);
+	m_pViewManager->SetCameraPose(position, target, fieldOfView);
+	m_renderTarget.Bind(width, height);
+	m_drawFrame();
+	glFinish();
+	std::chrono::duration<double, std::milli> renderTime = std::chrono::steady_clock::now() - renderStartTime;
+
+	if (quality != m_defaultTier)
+	{
+		m_pQualityManager->SetTier(m_defaultTier);
+	}
+
+	bool bSent = false;
+	if (format == "shm")
+	{
+		// the slots only fit frames up to the size of the first
+		// shared memory job, and clients may still map them
+		uint64_t publishedCount = m_sharedOutput.GetPublishedCount();
+		if (m_sharedOutput.PublishFrame(width, height) == false)
+		{
+			return(SendLine(client.socket, "ERROR frame is larger than the shared memory"));
+		}
+		m_sharedOutput.Finish();
+		if (m_sharedOutput.GetPublishedCount() == publishedCount)
+		{
+			return(SendLine(client.socket, "ERROR frame could not be published"));
+		}
+
+		std::ostringstream answer;
+		answer << "OK shm " << m_sharedOutput.GetName() << " " << m_sharedOutput.GetPublishedCount()
+			<< " " << width << " " << height;
+		bSent = SendLine(client.socket, answer.str());
+	}
+	else
+	{
+		// OpenGL returns the rows from the bottom up
+		size_t rowSize = (size_t)width * 3;
+		m_pixels.resize(rowSize * height);
+		m_flippedPixels.resize(rowSize * height);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, m_pixels.data());
+		for (int y = 0; y < height; y++)
+		{
+			memcpy(&m_flippedPixels[y * rowSize], &m_pixels[(height - 1 - y) * rowSize], rowSize);
+		}
+
+		if (format == "ppm")
+		{
+			ImageWriter::EncodePPM(width, height, m_flippedPixels, m_encoded);
+		}
+		else
+		{
+			ImageWriter::EncodePNG(width, height, m_flippedPixels, m_encoded);
+		}
+
+		std::ostringstream answer;
+		answer << "OK " << format << " " << width << " " << height << " " << m_encoded.size();
+		bSent = (SendLine(client.socket, answer.str())) && (SendAll(client.socket, m_encoded.data(), m_encoded.size()));
+	}
+
+	std::chrono::duration<double, std::milli> jobTime = std::chrono::steady_clock::now() - jobStartTime;
+	m_jobCount++;
+	m_totalJobMs += jobTime.count();
+	m_totalRenderMs += renderTime.count();
+
+	return(bSent);
+}
+
+/***********************************************************
+ *  SendAll()
+ *
+ *  This method is used for sending a whole buffer to a
+ *  client.  False is returned if the client went away.
+ ***********************************************************/
+bool RenderServer::SendAll(int socket, const void* pData, size_t size)
+{
+#ifdef _WIN32
+	return(false);
+#else
+	const char* pBytes = (const char*)pData;
+	while (size > 0)
+	{
+		ssize_t sent = send(socket, pBytes, size, MSG_NOSIGNAL);
+		if (sent < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			return(false);
+		}
+		pBytes += sent;
+		size -= (size_t)sent;
+	}
+	return(true);
+#endif
+}
+
+/***********************************************************
+ *  SendLine()
+ *
+ *  This method is used for sending one answer line.
+ ***********************************************************/
+bool RenderServer::SendLine(int socket, const std::string& line)
+{
+	std::string message = line + "\n";
+	return(SendAll(socket, message.data(), message.size()));
+}
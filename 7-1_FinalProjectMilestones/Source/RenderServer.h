@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderserver.h
+// ============
+// serve render jobs over a local socket with the scene kept loaded
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ViewManager.h"
+#include "QualityManager.h"
+#include "RenderTarget.h"
+#include "SharedFrameOutput.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  RenderServer
+ *
+ *  This class contains the code for a render daemon.  The
+ *  OpenGL context, shaders, meshes and textures stay loaded,
+ *  and clients connect to a Unix socket and send one job
+ *  per line:
+ *
+ *    render <width> <height> <px> <py> <pz> <tx> <ty> <tz>
+ *           [fov=<degrees>] [quality=<tier>] [format=<format>]
+ *    shutdown
+ *
+ *  The format is png (the default), ppm or shm, and the
+ *  answer is one line, followed by the image for png and
+ *  ppm:
+ *
+ *    OK png <width> <height> <byte count>
+ *    OK shm <memory name> <frame number> <width> <height>
+ *    ERROR <message>
+ *
+ *  A shm frame is published into the shared frame ring,
+ *  with the rows from the bottom up.  Jobs are rendered one
+ *  at a time, in the order that they arrive.
+ ***********************************************************/
+class RenderServer
+{
+public:
+	// constructor
+	RenderServer(
+		ViewManager* pViewManager,
+		QualityManager* pQualityManager,
+		std::function<void()> drawFrame);
+	// destructor
+	~RenderServer();
+
+	// listen on the socket, and publish shm frames to the
+	// shared memory of the passed in name
+	bool Start(const std::string& socketPath, const std::string& sharedOutputName);
+	// serve the clients until a shutdown job or signal
+	void Run();
+	// close the socket and the client connections
+	void Stop();
+
+private:
+	// a connected client and its unfinished request line
+	struct CLIENT
+	{
+		int socket;
+		std::string input;
+	};
+
+	// the server cannot be copied
+	RenderServer(const RenderServer&) = delete;
+	RenderServer& operator=(const RenderServer&) = delete;
+
+	// answer one request line, false to close the connection
+	bool HandleRequest(CLIENT& client, const std::string& line);
+	// render a job and answer with the image
+	bool RenderJob(CLIENT& client, const std::string& arguments);
+	// send the whole buffer, false if the client went away
+	bool SendAll(int socket, const void* pData, size_t size);
+	bool SendLine(int socket, const std::string& line);
+
+	// pointer to view manager object
+	ViewManager* m_pViewManager;
+	// pointer to quality manager object
+	QualityManager* m_pQualityManager;
+	// draws the scene into the bound framebuffer
+	std::function<void()> m_drawFrame;
+	// tier that jobs without a quality override use
+	std::string m_defaultTier;
+
+	std::string m_socketPath;
+	int m_listenSocket;
+	std::vector<CLIENT> m_clients;
+	bool m_bShutdown;
+
+	// offscreen target that every job is drawn into
+	RenderTarget m_renderTarget;
+	// shared frame ring, created by the first shm job
+	SharedFrameOutput m_sharedOutput;
+	std::string m_sharedOutputName;
+	// pixels of the job being answered
+	std::vector<uint8_t> m_pixels;
+	std::vector<uint8_t> m_flippedPixels;
+	std::vector<uint8_t> m_encoded;
+
+	// totals for the summary printed at shutdown
+	int m_jobCount;
+	double m_totalJobMs;
+	double m_totalRenderMs;
+};
@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////
+// rendertarget.cpp
+// ============
+// an offscreen framebuffer that the 3D scene can be rendered into
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderTarget.h"
+#include "GLStateCache.h"
+
+#include <iostream>
+
+/***********************************************************
+ *  RenderTarget()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderTarget::RenderTarget()
+{
+	m_framebuffer = 0;
+	m_colorTexture = 0;
+	m_depthBuffer = 0;
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  ~RenderTarget()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RenderTarget::~RenderTarget()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used for allocating the color texture and
+ *  the depth buffer at the passed in size.  Nothing is done
+ *  when the size has not changed.
+ ***********************************************************/
+bool RenderTarget::Resize(int width, int height)
+{
+	if ((width == m_width) && (height == m_height) && (m_framebuffer != 0))
+	{
+		return(true);
+	}
+
+	Destroy();
+	if ((width <= 0) || (height <= 0))
+	{
+		return(false);
+	}
+
+	glGenTextures(1, &m_colorTexture);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, m_colorTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0);
+
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Offscreen framebuffer is incomplete: 0x" << std::hex << status << std::dec << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	m_width = width;
+	m_height = height;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the framebuffer and the
+ *  buffers attached to it.
+ ***********************************************************/
+void RenderTarget::Destroy()
+{
+	if (m_framebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_framebuffer);
+	}
+	if (m_colorTexture != 0)
+	{
+		GLStateCache::DeleteTextures(1, &m_colorTexture);
+	}
+	if (m_depthBuffer != 0)
+	{
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+	}
+
+	m_framebuffer = 0;
+	m_colorTexture = 0;
+	m_depthBuffer = 0;
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used for directing the following draw
+ *  calls into the framebuffer, limited to the lower left
+ *  area of the passed in size.
+ ***********************************************************/
+void RenderTarget::Bind(int renderWidth, int renderHeight)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glViewport(0, 0, renderWidth, renderHeight);
+}
+
+/***********************************************************
+ *  BlitToWindow()
+ *
+ *  This method is used for copying the rendered area to the
+ *  window framebuffer, scaled up with linear filtering to
+ *  fill the whole window.  The window framebuffer is left
+ *  bound for drawing.
+ ***********************************************************/
+void RenderTarget::BlitToWindow(int renderWidth, int renderHeight, int windowWidth, int windowHeight)
+{
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+	GLenum filter = ((renderWidth == windowWidth) && (renderHeight == windowHeight)) ? GL_NEAREST : GL_LINEAR;
+	glBlitFramebuffer(
+		0, 0, renderWidth, renderHeight,
+		0, 0, windowWidth, windowHeight,
+		GL_COLOR_BUFFER_BIT, filter);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, windowWidth, windowHeight);
+}
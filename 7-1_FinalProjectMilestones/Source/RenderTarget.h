@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+// rendertarget.h
+// ============
+// an offscreen framebuffer that the 3D scene can be rendered into
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  RenderTarget
+ *
+ *  This class contains the code for an offscreen framebuffer
+ *  object with a color texture and a depth buffer.  The
+ *  buffers are allocated at a maximum size, and a frame can
+ *  be rendered into any smaller area in the lower left
+ *  corner without allocating them again.
+ ***********************************************************/
+class RenderTarget
+{
+public:
+	// constructor
+	RenderTarget();
+	// destructor
+	~RenderTarget();
+
+	// allocate the buffers, if the size has changed
+	bool Resize(int width, int height);
+	// free the framebuffer and its buffers
+	void Destroy();
+
+	// render into the lower left area of the passed in size
+	void Bind(int renderWidth, int renderHeight);
+	// scale the rendered area up to the window framebuffer
+	void BlitToWindow(int renderWidth, int renderHeight, int windowWidth, int windowHeight);
+
+	// allocated size of the buffers
+	int GetWidth() const { return(m_width); }
+	int GetHeight() const { return(m_height); }
+	// framebuffer and color texture names
+	GLuint GetFramebuffer() const { return(m_framebuffer); }
+	GLuint GetColorTexture() const { return(m_colorTexture); }
+
+private:
+	// the buffers cannot be shared between objects
+	RenderTarget(const RenderTarget&) = delete;
+	RenderTarget& operator=(const RenderTarget&) = delete;
+
+	GLuint m_framebuffer;
+	GLuint m_colorTexture;
+	GLuint m_depthBuffer;
+	int m_width;
+	int m_height;
+};
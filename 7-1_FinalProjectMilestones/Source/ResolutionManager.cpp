@@ -0,0 +1,185 @@
+///////////////////////////////////////////////////////////////////////////////
+// resolutionmanager.cpp
+// ============
+// scale the rendering resolution to hold a frame time budget
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ResolutionManager.h"
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// lowest and highest fraction of the window size rendered
+	const float MIN_RENDER_SCALE = 0.5f;
+	const float MAX_RENDER_SCALE = 1.0f;
+
+	// a frame over this share of the budget lowers the scale
+	// right away, so a spike in scene cost is absorbed at once
+	const float SCALE_DOWN_THRESHOLD = 0.95f;
+	// the scale is lowered to aim at this share of the budget
+	const float SCALE_DOWN_TARGET = 0.85f;
+	// the average must be under this share of the budget, for
+	// this many frames, before the scale is raised one step
+	const float SCALE_UP_THRESHOLD = 0.7f;
+	const int SCALE_UP_DELAY_FRAMES = 30;
+	const float SCALE_UP_STEP = 0.05f;
+	// after a change, this many frames are measured before the
+	// scale is lowered again, so frames still in flight at the
+	// old scale do not lower it a second time
+	const int SCALE_DOWN_DELAY_FRAMES = 8;
+
+	// weight of the newest frame in the smoothed GPU time
+	const float AVERAGE_WEIGHT = 0.1f;
+}
+
+/***********************************************************
+ *  ResolutionManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ResolutionManager::ResolutionManager(float frameBudgetMs)
+{
+	m_frameBudgetMs = frameBudgetMs;
+	m_averageGPUTimeMs = 0.0f;
+	m_framesSinceChange = 0;
+	m_renderScale = MAX_RENDER_SCALE;
+	m_frameIndex = 0;
+	m_windowWidth = 0;
+	m_windowHeight = 0;
+	m_renderWidth = 0;
+	m_renderHeight = 0;
+
+	glGenQueries(TIMER_QUERY_COUNT, m_timerQueries);
+	for (int i = 0; i < TIMER_QUERY_COUNT; i++)
+	{
+		m_bQueryPending[i] = false;
+		m_queryScale[i] = MAX_RENDER_SCALE;
+	}
+}
+
+/***********************************************************
+ *  ~ResolutionManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ResolutionManager::~ResolutionManager()
+{
+	glDeleteQueries(TIMER_QUERY_COUNT, m_timerQueries);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting a frame.  The offscreen
+ *  target follows the window size, the area for the current
+ *  render scale is bound for drawing, and the GPU timer is
+ *  started.
+ ***********************************************************/
+void ResolutionManager::BeginFrame(int windowWidth, int windowHeight)
+{
+	m_windowWidth = windowWidth;
+	m_windowHeight = windowHeight;
+	m_renderTarget.Resize(windowWidth, windowHeight);
+
+	m_renderWidth = std::max(1, (int)std::lround(windowWidth * m_renderScale));
+	m_renderHeight = std::max(1, (int)std::lround(windowHeight * m_renderScale));
+	m_renderTarget.Bind(m_renderWidth, m_renderHeight);
+
+	// a query whose result was never read can be started again
+	// without reading it, which drops that frame's measurement
+	// instead of waiting for the GPU
+	int queryIndex = m_frameIndex % TIMER_QUERY_COUNT;
+	m_bQueryPending[queryIndex] = false;
+	m_queryScale[queryIndex] = m_renderScale;
+	glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[queryIndex]);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for finishing a frame.  The GPU timer
+ *  is stopped, the rendered area is scaled up to the window,
+ *  and the oldest finished timer result adjusts the render
+ *  scale of the next frames.
+ ***********************************************************/
+void ResolutionManager::EndFrame()
+{
+	int queryIndex = m_frameIndex % TIMER_QUERY_COUNT;
+	glEndQuery(GL_TIME_ELAPSED);
+	m_bQueryPending[queryIndex] = true;
+	m_frameIndex++;
+
+	m_renderTarget.BlitToWindow(m_renderWidth, m_renderHeight, m_windowWidth, m_windowHeight);
+
+	// the oldest query belongs to a frame that the GPU has
+	// most likely finished, so reading it does not stall
+	int oldestIndex = m_frameIndex % TIMER_QUERY_COUNT;
+	if (m_bQueryPending[oldestIndex])
+	{
+		GLint bAvailable = GL_FALSE;
+		glGetQueryObjectiv(m_timerQueries[oldestIndex], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+		if (bAvailable == GL_TRUE)
+		{
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(m_timerQueries[oldestIndex], GL_QUERY_RESULT, &elapsed);
+			m_bQueryPending[oldestIndex] = false;
+			UpdateRenderScale((float)(elapsed / 1000000.0), m_queryScale[oldestIndex]);
+		}
+	}
+}
+
+/***********************************************************
+ *  UpdateRenderScale()
+ *
+ *  This method is used for adjusting the render scale for a
+ *  measured GPU frame time.  Most of the GPU time grows with
+ *  the number of pixels, which is the square of the scale,
+ *  so an over budget frame scales by the square root of the
+ *  time ratio.  Raising the scale only happens in small steps
+ *  after a run of cheap frames, to keep it from oscillating.
+ *  The timer results arrive a few frames late, so a frame
+ *  rendered at an earlier scale is converted to the current
+ *  scale by its pixel count and only updates the average.
+ ***********************************************************/
+void ResolutionManager::UpdateRenderScale(float gpuTimeMs, float frameScale)
+{
+	gpuTimeMs *= (m_renderScale / frameScale) * (m_renderScale / frameScale);
+
+	if (m_averageGPUTimeMs == 0.0f)
+	{
+		m_averageGPUTimeMs = gpuTimeMs;
+	}
+	else
+	{
+		m_averageGPUTimeMs += (gpuTimeMs - m_averageGPUTimeMs) * AVERAGE_WEIGHT;
+	}
+	m_framesSinceChange++;
+
+	if (frameScale != m_renderScale)
+	{
+		return;
+	}
+
+	float scale = m_renderScale;
+	if ((gpuTimeMs > m_frameBudgetMs * SCALE_DOWN_THRESHOLD) && (m_framesSinceChange >= SCALE_DOWN_DELAY_FRAMES))
+	{
+		scale = m_renderScale * std::sqrt(m_frameBudgetMs * SCALE_DOWN_TARGET / gpuTimeMs);
+		// the average is restarted so that the next increase
+		// waits for frames rendered at the new scale
+		m_averageGPUTimeMs = gpuTimeMs * (scale / m_renderScale) * (scale / m_renderScale);
+	}
+	else if ((m_averageGPUTimeMs < m_frameBudgetMs * SCALE_UP_THRESHOLD) && (m_framesSinceChange >= SCALE_UP_DELAY_FRAMES))
+	{
+		scale = m_renderScale + SCALE_UP_STEP;
+	}
+
+	scale = std::min(MAX_RENDER_SCALE, std::max(MIN_RENDER_SCALE, scale));
+	if (scale != m_renderScale)
+	{
+		m_renderScale = scale;
+		m_framesSinceChange = 0;
+	}
+}
@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+// resolutionmanager.h
+// ============
+// scale the rendering resolution to hold a frame time budget
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderTarget.h"
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  ResolutionManager
+ *
+ *  This class contains the code for dynamic resolution.  The
+ *  scene is rendered into an offscreen target at a fraction
+ *  of the window size and scaled up to the window.  The GPU
+ *  time of every frame is measured with timer queries, and
+ *  the fraction is lowered quickly when a frame goes over the
+ *  budget and raised slowly when there is time to spare.
+ ***********************************************************/
+class ResolutionManager
+{
+public:
+	// constructor - the budget is the target GPU frame time
+	ResolutionManager(float frameBudgetMs);
+	// destructor
+	~ResolutionManager();
+
+	// start a frame, binding the offscreen target
+	void BeginFrame(int windowWidth, int windowHeight);
+	// finish a frame, scaling it up to the window
+	void EndFrame();
+
+	// fraction of the window size used for rendering
+	float GetRenderScale() const { return(m_renderScale); }
+	// size of the area rendered in the current frame
+	int GetRenderWidth() const { return(m_renderWidth); }
+	int GetRenderHeight() const { return(m_renderHeight); }
+
+private:
+	// number of timer queries in flight, so that results are
+	// read a few frames late instead of stalling the pipeline
+	static const int TIMER_QUERY_COUNT = 4;
+
+	// offscreen target the scene is rendered into
+	RenderTarget m_renderTarget;
+	// timer queries, whether each one has a pending result, and
+	// the render scale of the frame each one measures
+	GLuint m_timerQueries[TIMER_QUERY_COUNT];
+	bool m_bQueryPending[TIMER_QUERY_COUNT];
+	float m_queryScale[TIMER_QUERY_COUNT];
+	int m_frameIndex;
+
+	// target GPU time of a frame
+	float m_frameBudgetMs;
+	// smoothed GPU time of the recent frames
+	float m_averageGPUTimeMs;
+	// frames since the render scale was last changed
+	int m_framesSinceChange;
+	float m_renderScale;
+
+	// sizes of the current frame
+	int m_windowWidth;
+	int m_windowHeight;
+	int m_renderWidth;
+	int m_renderHeight;
+
+	// adjust the render scale for the measured GPU time of a
+	// frame rendered at the passed in scale
+	void UpdateRenderScale(float gpuTimeMs, float frameScale);
+};
@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+// spscqueue.h
+// ============
+// lock-free queue between one producer thread and one consumer thread
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/***********************************************************
+ *  SPSCQueue
+ *
+ *  This class contains a fixed size ring buffer that one
+ *  thread pushes into and one other thread pops from without
+ *  locking.  Each side only writes its own index, and reads
+ *  the index of the other side with acquire ordering, so an
+ *  element is fully written before the consumer can see it.
+ *  The same thread may also be both the producer and the
+ *  consumer.
+ ***********************************************************/
+template <typename T>
+class SPSCQueue
+{
+public:
+	// constructor - the capacity is rounded up to a power of two
+	SPSCQueue(size_t capacity)
+	{
+		size_t size = 2;
+		while (size < capacity)
+		{
+			size *= 2;
+		}
+		m_elements.resize(size);
+		m_mask = size - 1;
+		m_head.store(0, std::memory_order_relaxed);
+		m_tail.store(0, std::memory_order_relaxed);
+	}
+
+	// add an element, false if the queue is full
+	bool Push(const T& element)
+	{
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+		{
+			return(false);
+		}
+
+		m_elements[tail & m_mask] = element;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return(true);
+	}
+
+	// remove the oldest element, false if the queue is empty
+	bool Pop(T& element)
+	{
+		size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+		{
+			return(false);
+		}
+
+		element = m_elements[head & m_mask];
+		m_head.store(head + 1, std::memory_order_release);
+		return(true);
+	}
+
+	// true when there is nothing to pop
+	bool IsEmpty() const
+	{
+		return(m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire));
+	}
+
+private:
+	// the queue is only shared by reference
+	SPSCQueue(const SPSCQueue&) = delete;
+	SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+	std::vector<T> m_elements;
+	size_t m_mask;
+	// the indexes only grow, and are kept on separate cache
+	// lines so the two threads do not slow each other down
+	alignas(64) std::atomic<size_t> m_head;
+	alignas(64) std::atomic<size_t> m_tail;
+};
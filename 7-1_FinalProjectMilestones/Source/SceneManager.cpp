@@ -8,6 +8,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
+#include "GLStateCache.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -16,6 +17,10 @@
 
 #include <glm/gtx/transform.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
 // declaration of global variables
 namespace
 {
@@ -24,6 +29,12 @@ namespace
 	const char* g_TextureValueName = "objectTexture";
 	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_UVScaleName = "UVscale";
+
+	// mesh tag of the model file added from the command line
+	const char* g_LoadedModelTag = "loadedmodel";
+	// size of the largest side of the loaded model on the desk
+	const float LOADED_MODEL_SIZE = 3.0f;
 }
 
 /***********************************************************
@@ -31,10 +42,31 @@ namespace
  *
  *  The constructor for the class
  ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager)
+SceneManager::SceneManager(UniformManager *pUniformManager)
 {
-	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
+	m_pUniformManager = pUniformManager;
+	m_pMeshManager = new MeshManager(pUniformManager);
+	m_loadedTextures = 0;
+	m_bModelLoaded = false;
+	m_bCollectingResources = false;
+	m_textureLODBias = 0.0f;
+
+	// the uniforms set for every drawn object are looked up
+	// once, so setting them does not search by name
+	m_objectUniforms = { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+	if (NULL != m_pUniformManager)
+	{
+		m_objectUniforms.model = m_pUniformManager->GetHandle(g_ModelName);
+		m_objectUniforms.objectColor = m_pUniformManager->GetHandle(g_ColorValueName);
+		m_objectUniforms.objectTexture = m_pUniformManager->GetHandle(g_TextureValueName);
+		m_objectUniforms.useTexture = m_pUniformManager->GetHandle(g_UseTextureName);
+		m_objectUniforms.UVscale = m_pUniformManager->GetHandle(g_UVScaleName);
+		m_objectUniforms.materialAmbientColor = m_pUniformManager->GetHandle("material.ambientColor");
+		m_objectUniforms.materialAmbientStrength = m_pUniformManager->GetHandle("material.ambientStrength");
+		m_objectUniforms.materialDiffuseColor = m_pUniformManager->GetHandle("material.diffuseColor");
+		m_objectUniforms.materialSpecularColor = m_pUniformManager->GetHandle("material.specularColor");
+		m_objectUniforms.materialShininess = m_pUniformManager->GetHandle("material.shininess");
+	}
 }
 
 /***********************************************************
@@ -44,9 +76,72 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
  ***********************************************************/
 SceneManager::~SceneManager()
 {
-	m_pShaderManager = NULL;
-	delete m_basicMeshes;
-	m_basicMeshes = NULL;
+	m_pUniformManager = NULL;
+	delete m_pMeshManager;
+	m_pMeshManager = NULL;
+}
+
+/***********************************************************
+ *  SetPackedVertices()
+ *
+ *  This method is used for choosing whether the scene
+ *  meshes are uploaded in the compact packed vertex format.
+ *  It must be called before PrepareScene().
+ ***********************************************************/
+void SceneManager::SetPackedVertices(bool bPacked)
+{
+	m_pMeshManager->SetPackedVertices(bPacked);
+}
+
+/***********************************************************
+ *  SetViewProjection()
+ *
+ *  This method is used for passing the camera of the current
+ *  frame to the mesh manager, which uses it for culling
+ *  the meshlets of large meshes.
+ ***********************************************************/
+void SceneManager::SetViewProjection(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& cameraPosition,
+	bool bPerspective)
+{
+	m_pMeshManager->SetViewProjection(view, projection, cameraPosition, bPerspective);
+}
+
+/***********************************************************
+ *  SetTextureLODBias()
+ *
+ *  This method is used for setting the mipmap level bias of
+ *  the scene textures.  A positive bias samples smaller
+ *  mipmap levels, which lowers the texture detail and the
+ *  memory bandwidth used for texturing.
+ ***********************************************************/
+void SceneManager::SetTextureLODBias(float bias)
+{
+	m_textureLODBias = bias;
+
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, m_textureLODBias);
+	}
+	GLStateCache::BindTexture(GL_TEXTURE_2D, 0);
+
+	// the textures are bound to their slots again
+	BindGLTextures();
+}
+
+/***********************************************************
+ *  SetMeshLODBias()
+ *
+ *  This method is used for setting the level of detail bias
+ *  of the scene meshes, where each whole step selects the
+ *  next coarser level sooner.
+ ***********************************************************/
+void SceneManager::SetMeshLODBias(float bias)
+{
+	m_pMeshManager->SetLODBias(bias);
 }
 
 /***********************************************************
@@ -81,14 +176,16 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
 
 		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, textureID);
 
 		// set the texture wrapping parameters
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		// set texture filtering parameters, where minified
+		// textures sample the generated mipmaps
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, m_textureLODBias);
 
 		// if the loaded image is in RGB format
 		if (colorChannels == 3)
@@ -107,7 +204,7 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 
 		// free the image data from local memory
 		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+		GLStateCache::BindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
 
 		// register the loaded texture and associate it with the special tag string
 		m_textureIDs[m_loadedTextures].ID = textureID;
@@ -134,8 +231,8 @@ void SceneManager::BindGLTextures()
 	for (int i = 0; i < m_loadedTextures; i++)
 	{
 		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		GLStateCache::ActiveTexture(GL_TEXTURE0 + i);
+		GLStateCache::BindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
 	}
 }
 
@@ -253,6 +350,11 @@ void SceneManager::SetTransformations(
 	float ZrotationDegrees,
 	glm::vec3 positionXYZ)
 {
+	if (m_bCollectingResources)
+	{
+		return;
+	}
+
 	// variables for this method
 	glm::mat4 modelView;
 	glm::mat4 scale;
@@ -272,10 +374,13 @@ void SceneManager::SetTransformations(
 
 	modelView = translation * rotationZ * rotationY * rotationX * scale;
 
-	if (NULL != m_pShaderManager)
+	if (NULL != m_pUniformManager)
 	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
+		m_pUniformManager->SetMat4Value(m_objectUniforms.model, modelView);
 	}
+
+	// the model matrix is also needed for culling meshlets
+	m_pMeshManager->SetModelMatrix(modelView);
 }
 
 /***********************************************************
@@ -290,6 +395,11 @@ void SceneManager::SetShaderColor(
 	float blueColorValue,
 	float alphaValue)
 {
+	if (m_bCollectingResources)
+	{
+		return;
+	}
+
 	// variables for this method
 	glm::vec4 currentColor;
 
@@ -298,10 +408,10 @@ void SceneManager::SetShaderColor(
 	currentColor.b = blueColorValue;
 	currentColor.a = alphaValue;
 
-	if (NULL != m_pShaderManager)
+	if (NULL != m_pUniformManager)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+		m_pUniformManager->SetBoolValue(m_objectUniforms.useTexture, false);
+		m_pUniformManager->SetVec4Value(m_objectUniforms.objectColor, currentColor);
 	}
 }
 
@@ -318,16 +428,25 @@ void SceneManager::SetShaderColor(
 void SceneManager::SetShaderTexture(
 	std::string textureTag)
 {
-	if (NULL != m_pShaderManager)
+	if (m_bCollectingResources)
+	{
+		if (std::find(m_referencedTextures.begin(), m_referencedTextures.end(), textureTag) == m_referencedTextures.end())
+		{
+			m_referencedTextures.push_back(textureTag);
+		}
+		return;
+	}
+
+	if (NULL != m_pUniformManager)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
+		m_pUniformManager->SetBoolValue(m_objectUniforms.useTexture, true);
 
 		int textureID = FindTextureSlot(textureTag);
 		if (textureID != -1) 
 		{
-			glActiveTexture(GL_TEXTURE0 + textureID);
-			glBindTexture(GL_TEXTURE_2D, m_textureIDs[textureID].ID);
-			m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+			GLStateCache::ActiveTexture(GL_TEXTURE0 + textureID);
+			GLStateCache::BindTexture(GL_TEXTURE_2D, m_textureIDs[textureID].ID);
+			m_pUniformManager->SetIntValue(m_objectUniforms.objectTexture, textureID);
 		}
 	}
 }
@@ -340,9 +459,9 @@ void SceneManager::SetShaderTexture(
  ***********************************************************/
 void SceneManager::SetTextureUVScale(float u, float v)
 {
-	if (NULL != m_pShaderManager)
+	if ((NULL != m_pUniformManager) && (m_bCollectingResources == false))
 	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
+		m_pUniformManager->SetVec2Value(m_objectUniforms.UVscale, glm::vec2(u, v));
 	}
 }
 
@@ -355,7 +474,7 @@ void SceneManager::SetTextureUVScale(float u, float v)
 void SceneManager::SetShaderMaterial(
 	std::string materialTag)
 {
-	if (m_objectMaterials.size() > 0)
+	if ((m_objectMaterials.size() > 0) && (m_bCollectingResources == false))
 	{
 		OBJECT_MATERIAL material;
 		bool bReturn = false;
@@ -363,15 +482,105 @@ void SceneManager::SetShaderMaterial(
 		bReturn = FindMaterial(materialTag, material);
 		if (bReturn == true)
 		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+			m_pUniformManager->SetVec3Value(m_objectUniforms.materialAmbientColor, material.ambientColor);
+			m_pUniformManager->SetFloatValue(m_objectUniforms.materialAmbientStrength, material.ambientStrength);
+			m_pUniformManager->SetVec3Value(m_objectUniforms.materialDiffuseColor, material.diffuseColor);
+			m_pUniformManager->SetVec3Value(m_objectUniforms.materialSpecularColor, material.specularColor);
+			m_pUniformManager->SetFloatValue(m_objectUniforms.materialShininess, material.shininess);
 		}
 	}
 }
 
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing a loaded mesh with the
+ *  current transformation and shader settings.  While the
+ *  scene resources are being collected, the mesh is only
+ *  recorded as being used.
+ ***********************************************************/
+void SceneManager::DrawMesh(
+	std::string meshTag)
+{
+	if (m_bCollectingResources)
+	{
+		if (std::find(m_referencedMeshes.begin(), m_referencedMeshes.end(), meshTag) == m_referencedMeshes.end())
+		{
+			m_referencedMeshes.push_back(meshTag);
+		}
+		return;
+	}
+
+	m_pMeshManager->DrawMesh(meshTag);
+}
+
+/***********************************************************
+ *  DefineTexture()
+ *
+ *  This method is used for adding a texture file that the
+ *  scene can use.  The file is only loaded if the scene
+ *  actually draws with the texture.
+ ***********************************************************/
+void SceneManager::DefineTexture(const char* filename, std::string tag)
+{
+	TEXTURE_FILE textureFile;
+	textureFile.filename = filename;
+	textureFile.tag = tag;
+	m_textureFiles.push_back(textureFile);
+}
+
+/***********************************************************
+ *  CollectSceneResources()
+ *
+ *  This method is used for finding the meshes and textures
+ *  that the scene draws with.  RenderScene() is run once
+ *  with drawing and shader updates turned off, and every
+ *  mesh and texture tag it uses is recorded.
+ ***********************************************************/
+void SceneManager::CollectSceneResources()
+{
+	m_referencedMeshes.clear();
+	m_referencedTextures.clear();
+
+	m_bCollectingResources = true;
+	RenderScene();
+	m_bCollectingResources = false;
+}
+
+/***********************************************************
+ *  LoadReferencedResources()
+ *
+ *  This method is used for loading the meshes and textures
+ *  that were found by CollectSceneResources().  Textures are
+ *  loaded in the order they were defined, so every texture
+ *  keeps the same slot from one run to the next.
+ ***********************************************************/
+void SceneManager::LoadReferencedResources()
+{
+	for (size_t i = 0; i < m_textureFiles.size(); i++)
+	{
+		const TEXTURE_FILE& textureFile = m_textureFiles[i];
+		if (std::find(m_referencedTextures.begin(), m_referencedTextures.end(), textureFile.tag) != m_referencedTextures.end())
+		{
+			CreateGLTexture(textureFile.filename.c_str(), textureFile.tag);
+		}
+	}
+
+	for (size_t i = 0; i < m_referencedTextures.size(); i++)
+	{
+		if (FindTextureSlot(m_referencedTextures[i]) == -1)
+		{
+			std::cout << "Scene uses an undefined texture:" << m_referencedTextures[i] << std::endl;
+		}
+	}
+
+	// the meshes are generated in parallel and then uploaded
+	m_pMeshManager->LoadMeshes(m_referencedMeshes);
+
+	std::cout << "Loaded " << m_referencedMeshes.size() << " meshes and " << m_loadedTextures
+		<< " of " << m_textureFiles.size() << " textures used by the scene" << std::endl;
+}
+
 /**************************************************************/
 /*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
 /*** preparing and rendering their own 3D replicated scenes.***/
@@ -380,30 +589,25 @@ void SceneManager::SetShaderMaterial(
 /**************************************************************/
 
 /***********************************************************
-*	LoadSceneTextures()
+*	DefineSceneTextures()
 * 
-*	This method is used for loading the textures for the 3D
-*	scene.
+*	This method is used for defining the texture files that
+*	the 3D scene can use.  Only the textures that RenderScene()
+*	draws with are loaded.
 ************************************************************/
-void SceneManager::LoadSceneTextures()
+void SceneManager::DefineSceneTextures()
 {
-	// debug log
-	std::cout << "Loading textures for the 3D scene..." << std::endl;
-
-	CreateGLTexture("textures/ashberrysmooth.jpg", "ashberry");
-	CreateGLTexture("textures/flagstonerubble.jpg", "flagstone");
-	CreateGLTexture("textures/granite.jpg", "granite");
-	CreateGLTexture("textures/marmoreal.jpg", "marmoreal");
-	CreateGLTexture("textures/oak.jpg", "oak");
-	CreateGLTexture("textures/charredtimber.jpg", "charredtimber");
-	CreateGLTexture("textures/black-leather.jpg", "black-leather");
-	CreateGLTexture("textures/fabric.jpg", "fabric");
-	CreateGLTexture("textures/gray-surface.jpg", "gray-surface");
-	CreateGLTexture("textures/green-blue-surface.jpg", "green-blue-surface");
-	CreateGLTexture("textures/clock-face.jpg", "clock-face");
-
-	// debug log
-	std::cout << "Finished loading textures for the 3D scene." << std::endl;
+	DefineTexture("textures/ashberrysmooth.jpg", "ashberry");
+	DefineTexture("textures/flagstonerubble.jpg", "flagstone");
+	DefineTexture("textures/granite.jpg", "granite");
+	DefineTexture("textures/marmoreal.jpg", "marmoreal");
+	DefineTexture("textures/oak.jpg", "oak");
+	DefineTexture("textures/charredtimber.jpg", "charredtimber");
+	DefineTexture("textures/black-leather.jpg", "black-leather");
+	DefineTexture("textures/fabric.jpg", "fabric");
+	DefineTexture("textures/gray-surface.jpg", "gray-surface");
+	DefineTexture("textures/green-blue-surface.jpg", "green-blue-surface");
+	DefineTexture("textures/clock-face.jpg", "clock-face");
 }
 
 /***********************************************************
@@ -521,7 +725,7 @@ void SceneManager::SetupSceneLights()
 	// debug log
 	std::cout << "Setting up scene lights..." << std::endl;
 
-	m_pShaderManager->setBoolValue(g_UseLightingName, true);
+	m_pUniformManager->SetBoolValue(g_UseLightingName, true);
 
 	// General ambient light level
 	glm::vec3 ambientLight = glm::vec3(0.1f, 0.1f, 0.1f);
@@ -533,38 +737,38 @@ void SceneManager::SetupSceneLights()
 	glm::vec3 directionalLightSpecular = glm::vec3(1.0f, 0.9f, 0.8f); // Soft white
 
 	// Light source 1
-	m_pShaderManager->setVec3Value("lightSources[0].position", 3.0f, 14.0f, 0.0f);
-	m_pShaderManager->setVec3Value("lightSources[0].ambientColor", directionalLightAmbient);
-	m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", directionalLightDiffuse);
-	m_pShaderManager->setVec3Value("lightSources[0].specularColor", directionalLightSpecular);
-	m_pShaderManager->setFloatValue("lightSources[0].focalStrength", 32.0f);
-	m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", 0.05f);
+	m_pUniformManager->SetVec3Value("lightSources[0].position", glm::vec3(3.0f, 14.0f, 0.0f));
+	m_pUniformManager->SetVec3Value("lightSources[0].ambientColor", directionalLightAmbient);
+	m_pUniformManager->SetVec3Value("lightSources[0].diffuseColor", directionalLightDiffuse);
+	m_pUniformManager->SetVec3Value("lightSources[0].specularColor", directionalLightSpecular);
+	m_pUniformManager->SetFloatValue("lightSources[0].focalStrength", 32.0f);
+	m_pUniformManager->SetFloatValue("lightSources[0].specularIntensity", 0.05f);
 
 	// Light source 2
-	m_pShaderManager->setVec3Value("lightSources[1].position", -3.0f, 14.0f, 0.0f);
-	m_pShaderManager->setVec3Value("lightSources[1].ambientColor", directionalLightAmbient);
-	m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", directionalLightDiffuse);
-	m_pShaderManager->setVec3Value("lightSources[1].specularColor", directionalLightSpecular);
-	m_pShaderManager->setFloatValue("lightSources[1].focalStrength", 32.0f);
-	m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", 0.05f);
+	m_pUniformManager->SetVec3Value("lightSources[1].position", glm::vec3(-3.0f, 14.0f, 0.0f));
+	m_pUniformManager->SetVec3Value("lightSources[1].ambientColor", directionalLightAmbient);
+	m_pUniformManager->SetVec3Value("lightSources[1].diffuseColor", directionalLightDiffuse);
+	m_pUniformManager->SetVec3Value("lightSources[1].specularColor", directionalLightSpecular);
+	m_pUniformManager->SetFloatValue("lightSources[1].focalStrength", 32.0f);
+	m_pUniformManager->SetFloatValue("lightSources[1].specularIntensity", 0.05f);
 
 	// Light source 3 - Slightly Blue
-	m_pShaderManager->setVec3Value("lightSources[2].position", 0.6f, 5.0f, 6.0f);
-	m_pShaderManager->setVec3Value("lightSources[2].ambientColor", 0.2f, 0.2f, 0.4f);
-	m_pShaderManager->setVec3Value("lightSources[2].diffuseColor", 0.4f, 0.4f, 0.8f);
-	m_pShaderManager->setVec3Value("lightSources[2].specularColor", 0.5f, 0.5f, 1.0f);
-	m_pShaderManager->setFloatValue("lightSources[2].focalStrength", 12.0f);
-	m_pShaderManager->setFloatValue("lightSources[2].specularIntensity", 0.5f);
+	m_pUniformManager->SetVec3Value("lightSources[2].position", glm::vec3(0.6f, 5.0f, 6.0f));
+	m_pUniformManager->SetVec3Value("lightSources[2].ambientColor", glm::vec3(0.2f, 0.2f, 0.4f));
+	m_pUniformManager->SetVec3Value("lightSources[2].diffuseColor", glm::vec3(0.4f, 0.4f, 0.8f));
+	m_pUniformManager->SetVec3Value("lightSources[2].specularColor", glm::vec3(0.5f, 0.5f, 1.0f));
+	m_pUniformManager->SetFloatValue("lightSources[2].focalStrength", 12.0f);
+	m_pUniformManager->SetFloatValue("lightSources[2].specularIntensity", 0.5f);
 
 	// Light source 4
-	m_pShaderManager->setVec3Value("lightSources[3].position", -0.6f, 7.0f, -6.0f);
-	m_pShaderManager->setVec3Value("lightSources[3].ambientColor", 0.1f, 0.1f, 0.1f);
-	m_pShaderManager->setVec3Value("lightSources[3].diffuseColor", 0.6f, 0.6f, 0.6f);
-	m_pShaderManager->setVec3Value("lightSources[3].specularColor", 0.9f, 0.9f, 0.9f);
-	m_pShaderManager->setFloatValue("lightSources[3].focalStrength", 12.0f);
-	m_pShaderManager->setFloatValue("lightSources[3].specularIntensity", 0.5f);
-
-	m_pShaderManager->setBoolValue("bUseLighting", true);
+	m_pUniformManager->SetVec3Value("lightSources[3].position", glm::vec3(-0.6f, 7.0f, -6.0f));
+	m_pUniformManager->SetVec3Value("lightSources[3].ambientColor", glm::vec3(0.1f, 0.1f, 0.1f));
+	m_pUniformManager->SetVec3Value("lightSources[3].diffuseColor", glm::vec3(0.6f, 0.6f, 0.6f));
+	m_pUniformManager->SetVec3Value("lightSources[3].specularColor", glm::vec3(0.9f, 0.9f, 0.9f));
+	m_pUniformManager->SetFloatValue("lightSources[3].focalStrength", 12.0f);
+	m_pUniformManager->SetFloatValue("lightSources[3].specularIntensity", 0.5f);
+
+	m_pUniformManager->SetBoolValue("bUseLighting", true);
 }
 
 
@@ -581,17 +785,27 @@ void SceneManager::PrepareScene()
 	// loaded in memory no matter how many times it is drawn
 	// in the rendered 3D scene
 
-	LoadSceneTextures();
+	DefineSceneTextures();
 	DefineObjectMaterials();
 	SetupSceneLights();
 
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadTaperedCylinderMesh();
-	m_basicMeshes->LoadTorusMesh();
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadSphereMesh();
-	m_basicMeshes->LoadConeMesh();
+	// the basic shapes are read from the binary mesh cache,
+	// and are only generated on the first launch or after
+	// their tessellation has been changed
+	auto meshStartTime = std::chrono::steady_clock::now();
+
+	if (m_modelFilename.empty() == false)
+	{
+		m_bModelLoaded = m_pMeshManager->LoadModelMesh(m_modelFilename, g_LoadedModelTag);
+	}
+
+	// only the meshes and textures that RenderScene() draws
+	// with are loaded
+	CollectSceneResources();
+	LoadReferencedResources();
+
+	std::chrono::duration<double, std::milli> meshTime = std::chrono::steady_clock::now() - meshStartTime;
+	std::cout << "Prepared scene resources in " << meshTime.count() << " ms" << std::endl;
 
 }
 
@@ -638,7 +852,7 @@ void SceneManager::RenderScene()
 	SetShaderMaterial("charredtimber");
 
 	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	DrawMesh("plane");
 	/****************************************************************/
 
 	// BEGIN STUDENT CODE
@@ -669,7 +883,7 @@ void SceneManager::RenderScene()
 	SetShaderMaterial("ashberry");
 
 	// Draw the bottom cylinder with transformation values.
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh("cylinder");
 
 	//
 	// TOP CYLINDER
@@ -695,7 +909,7 @@ void SceneManager::RenderScene()
 	SetShaderMaterial("flagstone");
 
 	// Draw the top cylinder with transformation values.
-	m_basicMeshes->DrawTaperedCylinderMesh();
+	DrawMesh("taperedcylinder");
 
 	//
 	// BOTTOM TORUS
@@ -721,7 +935,7 @@ void SceneManager::RenderScene()
 	SetShaderMaterial("granite");
 
 	// Draw the bottom torus with transformation values.
-	m_basicMeshes->DrawTorusMesh();
+	DrawMesh("torus");
 
 	//
 	// MID-TORI CYLINDER
@@ -747,7 +961,7 @@ void SceneManager::RenderScene()
 	SetShaderMaterial("flagstone");
 
 	// Draw the bottom cylinder with transformation values.
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh("cylinder");
 
 	//
 	// TOP TORUS
@@ -773,7 +987,7 @@ void SceneManager::RenderScene()
 	SetShaderMaterial("granite");
 
 	// Draw the top torus with transformation values.
-	m_basicMeshes->DrawTorusMesh();
+	DrawMesh("torus");
 
 	//
 	// PEN 1
@@ -799,7 +1013,7 @@ void SceneManager::RenderScene()
 
 
 	// Draw the first pen with transformation values.
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh("cylinder");
 
 	//
 	// PEN 2
@@ -824,7 +1038,7 @@ void SceneManager::RenderScene()
 	SetShaderMaterial("flagstone");
 
 	// Draw the second pen with transformation values.
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh("cylinder");
 
 	// 
 	// LAMP
@@ -846,7 +1060,7 @@ void SceneManager::RenderScene()
 	SetShaderTexture("gray-surface");
 	SetShaderMaterial("gray-surface");
 
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh("cylinder");
 
 	// Lamp Stem (Thin Cylinder)
 	glm::vec3 lampStemScale = glm::vec3(0.2f, 3.0f, 0.2f);
@@ -865,7 +1079,7 @@ void SceneManager::RenderScene()
 	SetShaderTexture("gray-surface");
 	SetShaderMaterial("gray-surface");
 
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh("cylinder");
 
 	// Lamp Shade (Cone)
 	glm::vec3 lampShadeScale = glm::vec3(1.5f, 1.5f, 1.5f);
@@ -884,7 +1098,7 @@ void SceneManager::RenderScene()
 	SetShaderTexture("fabric");
 	SetShaderMaterial("fabric");
 
-	m_basicMeshes->DrawConeMesh();
+	DrawMesh("cone");
 
 	//
 	// CLOCK
@@ -906,7 +1120,7 @@ void SceneManager::RenderScene()
 	SetShaderTexture("black-leather");
 	SetShaderMaterial("black-leather");
 
-	m_basicMeshes->DrawBoxMesh();
+	DrawMesh("box");
 
 	//
 	// CLOCK SCREEN
@@ -928,7 +1142,7 @@ void SceneManager::RenderScene()
 	SetShaderTexture("clock-face");
 	SetShaderMaterial("clock-face");
 
-	m_basicMeshes->DrawBoxMesh();
+	DrawMesh("box");
 
 	//
 	// HANDSOAP BOTTLE
@@ -950,7 +1164,7 @@ void SceneManager::RenderScene()
 	SetShaderTexture("black-leather");
 	SetShaderMaterial("green-blue-surface");
 
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh("cylinder");
 
 	// Bottle Pump (Cylinder)
 	glm::vec3 lotionPumpScale = glm::vec3(0.2f, 0.5f, 0.2f);
@@ -969,7 +1183,7 @@ void SceneManager::RenderScene()
 	SetShaderTexture("gray-surface");
 	SetShaderMaterial("gray-surface");
 
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh("cylinder");
 
 	// Middle part of bottle pump (Cylinder)
 	glm::vec3 lotionPumpMiddleScale = glm::vec3(0.1f, 0.2f, 0.1f);
@@ -988,5 +1202,32 @@ void SceneManager::RenderScene()
 	SetShaderTexture("gray-surface");
 	SetShaderMaterial("gray-surface");
 
-	m_basicMeshes->DrawCylinderMesh();
+	DrawMesh("cylinder");
+
+	//
+	// LOADED MODEL
+	//
+	// The model file from the command line is scaled to fit the
+	// middle of the desk and stands on the desk surface.
+	glm::vec3 modelBoundsMin;
+	glm::vec3 modelBoundsMax;
+	if ((m_bModelLoaded) && (m_pMeshManager->GetMeshBounds(g_LoadedModelTag, modelBoundsMin, modelBoundsMax)))
+	{
+		glm::vec3 modelSize = modelBoundsMax - modelBoundsMin;
+		float largestSide = std::max(modelSize.x, std::max(modelSize.y, modelSize.z));
+		float modelScale = (largestSide > 0.0f) ? LOADED_MODEL_SIZE / largestSide : 1.0f;
+		glm::vec3 modelCenter = (modelBoundsMin + modelBoundsMax) * 0.5f;
+
+		SetTransformations(
+			glm::vec3(modelScale),
+			0.0f,
+			0.0f,
+			0.0f,
+			glm::vec3(-modelCenter.x * modelScale, -modelBoundsMin.y * modelScale, -modelCenter.z * modelScale));
+
+		SetShaderColor(0.8f, 0.8f, 0.8f, 1.0f);
+		SetShaderMaterial("gray-surface");
+
+		DrawMesh(g_LoadedModelTag);
+	}
 }
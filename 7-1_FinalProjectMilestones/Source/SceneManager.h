@@ -9,8 +9,8 @@
 
 #pragma once
 
-#include "ShaderManager.h"
-#include "ShapeMeshes.h"
+#include "UniformManager.h"
+#include "MeshManager.h"
 
 #include <string>
 #include <vector>
@@ -25,16 +25,52 @@ class SceneManager
 {
 public:
 	// constructor
-	SceneManager(ShaderManager *pShaderManager);
+	SceneManager(UniformManager *pUniformManager);
 	// destructor
 	~SceneManager();
 
+	// choose the vertex format used for the scene meshes
+	void SetPackedVertices(bool bPacked);
+	// set the model file that is added to the scene
+	void SetModelFile(std::string filename) { m_modelFilename = filename; }
+	// set the camera that large meshes are culled against
+	void SetViewProjection(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		const glm::vec3& cameraPosition,
+		bool bPerspective);
+	// set the mipmap level bias of the scene textures
+	void SetTextureLODBias(float bias);
+	// set the level of detail bias of the scene meshes
+	void SetMeshLODBias(float bias);
+
 	struct TEXTURE_INFO
 	{
 		std::string tag;
 		uint32_t ID;
 	};
 
+	struct TEXTURE_FILE
+	{
+		std::string filename;
+		std::string tag;
+	};
+
+	// handles of the uniforms set for each drawn object
+	struct OBJECT_UNIFORMS
+	{
+		int model;
+		int objectColor;
+		int objectTexture;
+		int useTexture;
+		int UVscale;
+		int materialAmbientColor;
+		int materialAmbientStrength;
+		int materialDiffuseColor;
+		int materialSpecularColor;
+		int materialShininess;
+	};
+
 	struct OBJECT_MATERIAL
 	{
 		float ambientStrength;
@@ -46,16 +82,31 @@ public:
 	};
 
 private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
+	// pointer to uniform manager object
+	UniformManager* m_pUniformManager;
+	// pointer to mesh manager object
+	MeshManager* m_pMeshManager;
+	// optional model file drawn on the desk
+	std::string m_modelFilename;
+	bool m_bModelLoaded;
 	// total number of loaded textures
 	int m_loadedTextures;
+	// uniform handles of the drawn objects
+	OBJECT_UNIFORMS m_objectUniforms;
 	// loaded textures info
 	TEXTURE_INFO m_textureIDs[16];
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// mipmap level bias applied to the scene textures
+	float m_textureLODBias;
+	// texture files that the scene can use, by tag
+	std::vector<TEXTURE_FILE> m_textureFiles;
+
+	// true while RenderScene() is run only to find the meshes
+	// and textures that the scene draws with
+	bool m_bCollectingResources;
+	std::vector<std::string> m_referencedMeshes;
+	std::vector<std::string> m_referencedTextures;
 
 	// load texture images and convert to OpenGL texture data
 	bool CreateGLTexture(const char* filename, std::string tag);
@@ -69,6 +120,17 @@ private:
 	// find a defined material by tag
 	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
 
+	// add a texture file that the scene can reference by tag
+	void DefineTexture(const char* filename, std::string tag);
+	// find the meshes and textures that the scene draws with
+	void CollectSceneResources();
+	// load only the meshes and textures found by the collection
+	void LoadReferencedResources();
+
+	// draw a loaded mesh with the current shader settings
+	void DrawMesh(
+		std::string meshTag);
+
 	// set the transformation values 
 	// into the transform buffer
 	void SetTransformations(
@@ -104,6 +166,6 @@ public:
 	void RenderScene();
 	void DefineObjectMaterials();
 	void SetupSceneLights();
-	void LoadSceneTextures();
+	void DefineSceneTextures();
 
 };
\ No newline at end of file
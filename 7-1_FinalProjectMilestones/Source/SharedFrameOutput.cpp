@@ -0,0 +1,408 @@
+///////////////////////////////////////////////////////////////////////////////
+// sharedframeoutput.cpp
+// ============
+// publish rendered frames into shared memory for local consumer processes
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SharedFrameOutput.h"
+#include "GLStateCache.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+// declaration of global variables
+namespace
+{
+	// a fence is waited for in slices, flushing the commands
+	// only on the first one so the fence can be reached
+	const GLuint64 FENCE_WAIT_NANOSECONDS = 1000000;
+	// slots hold at least a 4K frame, so resizing the window
+	// does not outgrow them
+	const int MIN_SLOT_WIDTH = 3840;
+	const int MIN_SLOT_HEIGHT = 2160;
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free,
+		"the sequence counters must be lock free to work across processes");
+
+	/***********************************************************
+	 *  GetTimeNs()
+	 *
+	 *  Get the steady clock time that consumers compare the
+	 *  publish times against.
+	 ***********************************************************/
+	uint64_t GetTimeNs()
+	{
+		return((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+}
+
+/***********************************************************
+ *  SharedFrameOutput()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SharedFrameOutput::SharedFrameOutput()
+{
+	m_pHeader = NULL;
+	m_size = 0;
+#ifdef _WIN32
+	m_hMapping = NULL;
+#endif
+	for (int i = 0; i < READBACK_BUFFERS; i++)
+	{
+		m_readbacks[i].buffer = 0;
+		m_readbacks[i].fence = NULL;
+		m_readbacks[i].width = 0;
+		m_readbacks[i].height = 0;
+		m_readbacks[i].queuedTimeNs = 0;
+	}
+	m_nextReadback = 0;
+	m_pendingReadbacks = 0;
+	m_publishedCount = 0;
+	m_totalLatencyMs = 0.0;
+	m_totalHandoffMs = 0.0;
+	m_bSizeWarningShown = false;
+}
+
+/***********************************************************
+ *  ~SharedFrameOutput()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SharedFrameOutput::~SharedFrameOutput()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the named shared memory
+ *  with room for frames up to the passed in size, and the
+ *  pixel buffers that the frames are copied into.  On Linux
+ *  the memory appears as /dev/shm/<name>.
+ ***********************************************************/
+bool SharedFrameOutput::Create(const std::string& name, int maxWidth, int maxHeight)
+{
+	Destroy();
+
+	maxWidth = std::max(maxWidth, MIN_SLOT_WIDTH);
+	maxHeight = std::max(maxHeight, MIN_SLOT_HEIGHT);
+
+	// the pixels of each slot start on a page boundary
+	const size_t pageSize = 4096;
+	size_t slotStride = (((size_t)maxWidth * maxHeight * 4 + pageSize - 1) / pageSize) * pageSize;
+	size_t pixelOffset = ((sizeof(SHARED_FRAME_HEADER) + pageSize - 1) / pageSize) * pageSize;
+	size_t size = pixelOffset + slotStride * SHARED_FRAME_SLOTS;
+	void* pMemory = NULL;
+
+#ifdef _WIN32
+	std::string mappingName = "Local\\" + name;
+	m_hMapping = CreateFileMappingA(
+		INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+		(DWORD)((uint64_t)size >> 32), (DWORD)(size & 0xFFFFFFFF), mappingName.c_str());
+	if (NULL != m_hMapping)
+	{
+		pMemory = MapViewOfFile(m_hMapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	}
+#else
+	std::string shmName = "/" + name;
+	int fileDescriptor = shm_open(shmName.c_str(), O_CREAT | O_RDWR, 0600);
+	if (fileDescriptor >= 0)
+	{
+		if (ftruncate(fileDescriptor, (off_t)size) == 0)
+		{
+			pMemory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+			if (pMemory == MAP_FAILED)
+			{
+				pMemory = NULL;
+			}
+		}
+		close(fileDescriptor);
+	}
+#endif
+
+	m_name = name;
+	m_size = size;
+	if (NULL == pMemory)
+	{
+		std::cout << "Could not create the shared frame memory: " << name << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	// the header is filled in before the magic number is set,
+	// so a consumer that sees the magic sees a valid header
+	m_pHeader = new (pMemory) SHARED_FRAME_HEADER();
+	m_pHeader->version = SHARED_FRAME_VERSION;
+	m_pHeader->format = SHARED_FRAME_FORMAT_RGBA8;
+	m_pHeader->slotCount = SHARED_FRAME_SLOTS;
+	m_pHeader->maxWidth = (uint32_t)maxWidth;
+	m_pHeader->maxHeight = (uint32_t)maxHeight;
+	m_pHeader->slotStride = slotStride;
+	m_pHeader->pixelOffset = pixelOffset;
+	m_pHeader->latestFrame.store(0, std::memory_order_relaxed);
+	for (uint32_t i = 0; i < SHARED_FRAME_SLOTS; i++)
+	{
+		m_pHeader->slots[i].sequence.store(0, std::memory_order_relaxed);
+	}
+	std::atomic_thread_fence(std::memory_order_release);
+	m_pHeader->magic = SHARED_FRAME_MAGIC;
+
+	for (int i = 0; i < READBACK_BUFFERS; i++)
+	{
+		glGenBuffers(1, &m_readbacks[i].buffer);
+		GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, m_readbacks[i].buffer);
+		glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)maxWidth * maxHeight * 4, NULL, GL_STREAM_READ);
+	}
+	GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	std::cout << "Publishing frames to shared memory: " << name << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for removing the shared memory and
+ *  freeing the pixel buffers.  Consumers that still have
+ *  the memory mapped keep it until they unmap it.
+ ***********************************************************/
+void SharedFrameOutput::Destroy()
+{
+	for (int i = 0; i < READBACK_BUFFERS; i++)
+	{
+		if (NULL != m_readbacks[i].fence)
+		{
+			glDeleteSync(m_readbacks[i].fence);
+			m_readbacks[i].fence = NULL;
+		}
+		if (0 != m_readbacks[i].buffer)
+		{
+			GLStateCache::DeleteBuffers(1, &m_readbacks[i].buffer);
+			m_readbacks[i].buffer = 0;
+		}
+	}
+	m_pendingReadbacks = 0;
+
+#ifdef _WIN32
+	if (NULL != m_pHeader)
+	{
+		UnmapViewOfFile(m_pHeader);
+	}
+	if (NULL != m_hMapping)
+	{
+		CloseHandle(m_hMapping);
+		m_hMapping = NULL;
+	}
+#else
+	if (NULL != m_pHeader)
+	{
+		munmap(m_pHeader, m_size);
+	}
+	if (m_name.empty() == false)
+	{
+		shm_unlink(("/" + m_name).c_str());
+	}
+#endif
+	m_pHeader = NULL;
+	m_size = 0;
+	m_name.clear();
+}
+
+/***********************************************************
+ *  PublishFrame()
+ *
+ *  This method is used for queueing the copy of the lower
+ *  left area of the bound read framebuffer into the next
+ *  pixel buffer.  The frame is published by Update() once
+ *  the GPU has finished the copy.  It returns false when
+ *  the frame is not published, such as when it is larger
+ *  than the slots of the shared memory.
+ ***********************************************************/
+bool SharedFrameOutput::PublishFrame(int width, int height)
+{
+	if ((NULL == m_pHeader) || (width <= 0) || (height <= 0))
+	{
+		return(false);
+	}
+	if ((width > (int)m_pHeader->maxWidth) || (height > (int)m_pHeader->maxHeight))
+	{
+		if (m_bSizeWarningShown == false)
+		{
+			std::cout << "Frames larger than " << m_pHeader->maxWidth << "x" << m_pHeader->maxHeight
+				<< " are not published to shared memory" << std::endl;
+			m_bSizeWarningShown = true;
+		}
+		return(false);
+	}
+
+	Update();
+	if (m_pendingReadbacks == READBACK_BUFFERS)
+	{
+		PublishOldestFrame(true);
+	}
+
+	READBACK& readback = m_readbacks[m_nextReadback];
+	GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	// the fence is flushed right away, so the GPU signals it
+	// as soon as the copy is done and not at the next flush
+	readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+	readback.width = width;
+	readback.height = height;
+	readback.queuedTimeNs = GetTimeNs();
+
+	m_nextReadback = (m_nextReadback + 1) % READBACK_BUFFERS;
+	m_pendingReadbacks++;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for publishing every frame that the
+ *  GPU has finished copying, without waiting.  It should be
+ *  called often, such as after each buffer swap and before
+ *  each frame, since a frame is only published once this
+ *  sees its fence has passed.
+ ***********************************************************/
+void SharedFrameOutput::Update()
+{
+	while ((m_pendingReadbacks > 0) && (PublishOldestFrame(false)))
+	{
+	}
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for waiting until the GPU has copied
+ *  every queued frame and publishing them, for callers that
+ *  need the frame right away.
+ ***********************************************************/
+void SharedFrameOutput::Finish()
+{
+	while (m_pendingReadbacks > 0)
+	{
+		PublishOldestFrame(true);
+	}
+}
+
+/***********************************************************
+ *  PublishOldestFrame()
+ *
+ *  This method is used for writing the oldest copied frame
+ *  straight from its mapped pixel buffer into the next slot
+ *  of the ring.  The slot sequence is made odd before the
+ *  write and set to twice the frame number after it, so a
+ *  consumer can tell a torn read.  A frame whose buffer can
+ *  not be mapped is dropped and leaves the slot untouched.
+ *  False is returned when bWait is false and the copy has
+ *  not finished yet.
+ ***********************************************************/
+bool SharedFrameOutput::PublishOldestFrame(bool bWait)
+{
+	int oldest = (m_nextReadback + READBACK_BUFFERS - m_pendingReadbacks) % READBACK_BUFFERS;
+	READBACK& readback = m_readbacks[oldest];
+
+	GLenum result = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	if ((result == GL_TIMEOUT_EXPIRED) && (bWait == false))
+	{
+		return(false);
+	}
+	while (result == GL_TIMEOUT_EXPIRED)
+	{
+		result = glClientWaitSync(readback.fence, 0, FENCE_WAIT_NANOSECONDS);
+	}
+	glDeleteSync(readback.fence);
+	readback.fence = NULL;
+	m_pendingReadbacks--;
+
+	uint64_t handoffStartNs = GetTimeNs();
+	uint64_t frameNumber = m_publishedCount + 1;
+	SHARED_FRAME_SLOT& slot = m_pHeader->slots[frameNumber % SHARED_FRAME_SLOTS];
+	uint8_t* pPixels = (uint8_t*)m_pHeader + m_pHeader->pixelOffset +
+		(frameNumber % SHARED_FRAME_SLOTS) * m_pHeader->slotStride;
+	size_t size = (size_t)readback.width * readback.height * 4;
+
+	// the buffer is mapped before the slot is marked as being
+	// written, so a failed map never publishes stale pixels
+	GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+	const void* pMapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+	if (NULL == pMapped)
+	{
+		GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		std::cout << "Could not map the pixel buffer of a shared frame" << std::endl;
+		return(true);
+	}
+
+	slot.sequence.store(frameNumber * 2 - 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	memcpy(pPixels, pMapped, size);
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	GLStateCache::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	uint64_t publishTimeNs = GetTimeNs();
+	slot.frameNumber = frameNumber;
+	slot.publishTimeNs = publishTimeNs;
+	slot.width = (uint32_t)readback.width;
+	slot.height = (uint32_t)readback.height;
+	slot.sequence.store(frameNumber * 2, std::memory_order_release);
+	m_pHeader->latestFrame.store(frameNumber, std::memory_order_release);
+
+	m_publishedCount = frameNumber;
+	m_totalLatencyMs += (publishTimeNs - readback.queuedTimeNs) / 1000000.0;
+	m_totalHandoffMs += (publishTimeNs - handoffStartNs) / 1000000.0;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetAverageLatencyMs()
+ *
+ *  This method is used for getting the average time from a
+ *  frame copy being queued until the frame was published,
+ *  which includes the GPU finishing the frame.
+ ***********************************************************/
+double SharedFrameOutput::GetAverageLatencyMs() const
+{
+	return((m_publishedCount > 0) ? m_totalLatencyMs / m_publishedCount : 0.0);
+}
+
+/***********************************************************
+ *  GetAverageHandoffMs()
+ *
+ *  This method is used for getting the average time of
+ *  writing a finished frame into its slot and publishing
+ *  it, after its copy on the GPU is done.
+ ***********************************************************/
+double SharedFrameOutput::GetAverageHandoffMs() const
+{
+	return((m_publishedCount > 0) ? m_totalHandoffMs / m_publishedCount : 0.0);
+}
@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////
+// sharedframeoutput.h
+// ============
+// publish rendered frames into shared memory for local consumer processes
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// identifies the shared memory layout below
+const uint32_t SHARED_FRAME_MAGIC = 0x4D524653;	// "SFRM"
+const uint32_t SHARED_FRAME_VERSION = 1;
+// frames are 8 bit RGBA, with the rows from the bottom up
+const uint32_t SHARED_FRAME_FORMAT_RGBA8 = 1;
+// number of frame slots in the ring
+const uint32_t SHARED_FRAME_SLOTS = 3;
+
+/***********************************************************
+ *  SHARED_FRAME_SLOT
+ *
+ *  The description of one frame slot of the ring.  The
+ *  sequence is odd while the renderer writes the slot, and
+ *  twice the frame number once the frame is complete.
+ ***********************************************************/
+struct alignas(64) SHARED_FRAME_SLOT
+{
+	std::atomic<uint64_t> sequence;
+	uint64_t frameNumber;
+	// steady clock time in nanoseconds when it was published
+	uint64_t publishTimeNs;
+	uint32_t width;
+	uint32_t height;
+};
+
+/***********************************************************
+ *  SHARED_FRAME_HEADER
+ *
+ *  The start of the shared memory.  The pixels of slot i
+ *  begin pixelOffset + i * slotStride bytes from the start.
+ *
+ *  A consumer maps the memory read only and, for each frame:
+ *    1. loads latestFrame; zero means no frame yet
+ *    2. loads the sequence of slot latestFrame % slotCount,
+ *       which must equal 2 * latestFrame
+ *    3. uses the pixels in place
+ *    4. loads the sequence again; if it changed, the slot
+ *       was overwritten meanwhile and the frame is dropped
+ *  The renderer never waits for consumers.
+ ***********************************************************/
+struct alignas(64) SHARED_FRAME_HEADER
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t format;
+	uint32_t slotCount;
+	// largest frame size that fits in a slot
+	uint32_t maxWidth;
+	uint32_t maxHeight;
+	uint64_t slotStride;
+	uint64_t pixelOffset;
+	// number of the newest complete frame
+	alignas(64) std::atomic<uint64_t> latestFrame;
+	SHARED_FRAME_SLOT slots[SHARED_FRAME_SLOTS];
+};
+
+/***********************************************************
+ *  SharedFrameOutput
+ *
+ *  This class contains the code for publishing frames into
+ *  a named shared memory ring.  Each frame is copied into a
+ *  pixel buffer on the GPU, and as soon as the fence after
+ *  the copy passes it is copied once more, straight into
+ *  the next slot, and published by its sequence counter.
+ ***********************************************************/
+class SharedFrameOutput
+{
+public:
+	// constructor
+	SharedFrameOutput();
+	// destructor
+	~SharedFrameOutput();
+
+	// create the shared memory for frames up to the passed in size
+	bool Create(const std::string& name, int maxWidth, int maxHeight);
+	// remove the shared memory and the pixel buffers
+	void Destroy();
+
+	// start copying the lower left area of the read framebuffer
+	bool PublishFrame(int width, int height);
+	// publish the frames that the GPU has finished copying
+	void Update();
+	// wait until every queued frame is published
+	void Finish();
+
+	// name of the shared memory
+	const std::string& GetName() const { return(m_name); }
+
+	// number of frames published so far
+	uint64_t GetPublishedCount() const { return(m_publishedCount); }
+	// average time from the copy being queued to its publishing
+	double GetAverageLatencyMs() const;
+	// average time of writing a finished frame into its slot
+	double GetAverageHandoffMs() const;
+
+private:
+	// the GPU has two frames to finish a copy before its
+	// pixel buffer is needed again
+	static const int READBACK_BUFFERS = 3;
+
+	// a pixel buffer and the frame it holds
+	struct READBACK
+	{
+		GLuint buffer;
+		GLsync fence;
+		int width;
+		int height;
+		uint64_t queuedTimeNs;
+	};
+
+	// the memory cannot be shared between objects
+	SharedFrameOutput(const SharedFrameOutput&) = delete;
+	SharedFrameOutput& operator=(const SharedFrameOutput&) = delete;
+
+	// write the oldest copied frame into the next slot
+	bool PublishOldestFrame(bool bWait);
+
+	std::string m_name;
+	SHARED_FRAME_HEADER* m_pHeader;
+	size_t m_size;
+#ifdef _WIN32
+	// shared memory mapping object handle
+	void* m_hMapping;
+#endif
+
+	READBACK m_readbacks[READBACK_BUFFERS];
+	int m_nextReadback;
+	int m_pendingReadbacks;
+	uint64_t m_publishedCount;
+	double m_totalLatencyMs;
+	double m_totalHandoffMs;
+	bool m_bSizeWarningShown;
+};
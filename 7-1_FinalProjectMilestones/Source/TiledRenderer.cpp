@@ -0,0 +1,167 @@
+///////////////////////////////////////////////////////////////////////////////
+// tiledrenderer.cpp
+// ============
+// render still images larger than a framebuffer, one tile at a time
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TiledRenderer.h"
+#include "ImageWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// tiles are kept to a size that most GPUs hold easily
+	const int MAX_DEFAULT_TILE_SIZE = 4096;
+}
+
+/***********************************************************
+ *  TiledRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TiledRenderer::TiledRenderer(ViewManager* pViewManager, std::function<void()> drawFrame)
+{
+	m_pViewManager = pViewManager;
+	m_drawFrame = drawFrame;
+}
+
+/***********************************************************
+ *  ~TiledRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TiledRenderer::~TiledRenderer()
+{
+	m_pViewManager = NULL;
+	m_renderTarget.Destroy();
+}
+
+/***********************************************************
+ *  GetMaxTileSize()
+ *
+ *  This method is used for getting the largest square tile
+ *  that can be rendered, limited by the texture, renderbuffer
+ *  and viewport sizes of the OpenGL implementation.
+ ***********************************************************/
+int TiledRenderer::GetMaxTileSize()
+{
+	GLint maxTextureSize = MAX_DEFAULT_TILE_SIZE;
+	GLint maxRenderbufferSize = MAX_DEFAULT_TILE_SIZE;
+	GLint maxViewportSize[2] = { MAX_DEFAULT_TILE_SIZE, MAX_DEFAULT_TILE_SIZE };
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+	glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxRenderbufferSize);
+	glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxViewportSize);
+
+	return(std::min(std::min(maxTextureSize, maxRenderbufferSize), std::min(maxViewportSize[0], maxViewportSize[1])));
+}
+
+/***********************************************************
+ *  GetDefaultTileSize()
+ *
+ *  This method is used for getting the tile size used when
+ *  none is given, the largest supported size up to 4096.
+ ***********************************************************/
+int TiledRenderer::GetDefaultTileSize()
+{
+	return(std::min(GetMaxTileSize(), MAX_DEFAULT_TILE_SIZE));
+}
+
+/***********************************************************
+ *  RenderStill()
+ *
+ *  This method is used for rendering the image of a camera
+ *  in tiles.  Every tile has the full tile size, and the
+ *  tiles on the right and bottom edges reach past the image
+ *  and are cropped, so every tile has the same projection
+ *  scale and the level of detail matches across the seams.
+ *  A tile size of zero uses the default size.
+ ***********************************************************/
+bool TiledRenderer::RenderStill(
+	const std::string& filename,
+	int width,
+	int height,
+	const glm::vec3& position,
+	const glm::vec3& target,
+	float fieldOfView,
+	int tileSize)
+{
+	if (tileSize <= 0)
+	{
+		tileSize = GetDefaultTileSize();
+	}
+	tileSize = std::min(tileSize, GetMaxTileSize());
+
+	if ((m_renderTarget.Resize(std::max(tileSize, m_renderTarget.GetWidth()), std::max(tileSize, m_renderTarget.GetHeight())) == false))
+	{
+		return(false);
+	}
+
+	ImageFileStream imageFile;
+	if (imageFile.Open(filename, width, height) == false)
+	{
+		return(false);
+	}
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	// the camera and aspect ratio are those of the full image
+	m_pViewManager->SetFramebufferSize(width, height);
+	m_pViewManager->SetCameraPose(position, target, fieldOfView);
+
+	size_t imageRowSize = (size_t)width * 3;
+	m_rowPixels.resize(imageRowSize * tileSize);
+	m_tilePixels.resize((size_t)tileSize * tileSize * 3);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+	bool bWritten = true;
+	int columns = (width + tileSize - 1) / tileSize;
+	int rows = (height + tileSize - 1) / tileSize;
+	for (int row = 0; (row < rows) && (bWritten); row++)
+	{
+		// rows are counted from the top of the image, and the
+		// projection window from the bottom
+		int rowTop = row * tileSize;
+		int rowHeight = std::min(tileSize, height - rowTop);
+		float windowTop = 1.0f - (float)rowTop / height;
+		float windowBottom = 1.0f - (float)(rowTop + tileSize) / height;
+
+		for (int column = 0; column < columns; column++)
+		{
+			int columnLeft = column * tileSize;
+			int columnWidth = std::min(tileSize, width - columnLeft);
+			float windowLeft = (float)columnLeft / width;
+			float windowRight = (float)(columnLeft + tileSize) / width;
+
+			m_pViewManager->SetProjectionWindow(windowLeft, windowBottom, windowRight, windowTop);
+			m_renderTarget.Bind(tileSize, tileSize);
+			m_drawFrame();
+
+			// the part inside the image is the top left of the
+			// tile, and OpenGL returns its rows from the bottom up
+			glReadPixels(0, tileSize - rowHeight, columnWidth, rowHeight, GL_RGB, GL_UNSIGNED_BYTE, m_tilePixels.data());
+			size_t tileRowSize = (size_t)columnWidth * 3;
+			for (int y = 0; y < rowHeight; y++)
+			{
+				memcpy(&m_rowPixels[y * imageRowSize + columnLeft * 3],
+					&m_tilePixels[(rowHeight - 1 - y) * tileRowSize],
+					tileRowSize);
+			}
+		}
+
+		bWritten = imageFile.WriteRows(m_rowPixels.data(), rowHeight);
+	}
+
+	m_pViewManager->SetProjectionWindow(0.0f, 0.0f, 1.0f, 1.0f);
+	bWritten = (imageFile.Close()) && (bWritten);
+
+	std::chrono::duration<double> renderTime = std::chrono::steady_clock::now() - startTime;
+	std::cout << "Rendered " << filename << " at " << width << "x" << height << " in "
+		<< columns * rows << " tiles of " << tileSize << " pixels, " << renderTime.count() << " s" << std::endl;
+
+	return(bWritten);
+}
@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////
+// tiledrenderer.h
+// ============
+// render still images larger than a framebuffer, one tile at a time
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ViewManager.h"
+#include "RenderTarget.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TiledRenderer
+ *
+ *  This class contains the code for rendering a still image
+ *  of any size.  The image is split into square tiles, and
+ *  each tile is drawn with the projection of the full image
+ *  narrowed to its area, which is an off-center frustum.
+ *  The tiles are rendered a row at a time from the top, and
+ *  each finished row is written to the file, so only one
+ *  row of tiles is ever held in memory.
+ ***********************************************************/
+class TiledRenderer
+{
+public:
+	// constructor
+	TiledRenderer(ViewManager* pViewManager, std::function<void()> drawFrame);
+	// destructor
+	~TiledRenderer();
+
+	// largest tile size that the OpenGL implementation supports
+	static int GetMaxTileSize();
+	// tile size used when none is given
+	static int GetDefaultTileSize();
+
+	// render the image of a camera into a PNG or PPM file
+	bool RenderStill(
+		const std::string& filename,
+		int width,
+		int height,
+		const glm::vec3& position,
+		const glm::vec3& target,
+		float fieldOfView,
+		int tileSize);
+
+private:
+	// pointer to view manager object
+	ViewManager* m_pViewManager;
+	// draws the scene into the bound framebuffer
+	std::function<void()> m_drawFrame;
+	// offscreen target that every tile is drawn into
+	RenderTarget m_renderTarget;
+	// pixels of one tile and of one row of tiles
+	std::vector<uint8_t> m_tilePixels;
+	std::vector<uint8_t> m_rowPixels;
+};
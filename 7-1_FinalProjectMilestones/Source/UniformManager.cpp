@@ -0,0 +1,385 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformmanager.cpp
+// ============
+// look up the uniforms of the shader program once and set them by handle
+///////////////////////////////////////////////////////////////////////////////
+
+#include "UniformManager.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+#include <iostream>
+
+/***********************************************************
+ *  UniformManager()
+ *
+ *  The constructor for the class, which reads the uniforms
+ *  of the shader program in use.
+ ***********************************************************/
+UniformManager::UniformManager()
+{
+	GLint program = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+	m_program = (GLuint)program;
+	m_uniformCount = 0;
+	m_bReportUnused = true;
+	m_bCacheEnabled = true;
+	m_frameUploads = 0;
+	m_frameRedundantWrites = 0;
+	m_stats = { 0, 0, 0, 0, 0 };
+
+	ReflectProgram();
+}
+
+/***********************************************************
+ *  ReflectProgram()
+ *
+ *  This method is used for reading the active uniforms and
+ *  uniform blocks of the program into the tables.  An array
+ *  is added by its name, and by the name of each element,
+ *  since the elements of arrays of structures are each a
+ *  separate active uniform while those of arrays of basic
+ *  types are only reported once.
+ ***********************************************************/
+void UniformManager::ReflectProgram()
+{
+	m_uniforms.clear();
+	m_blocks.clear();
+	m_uniformCount = 0;
+
+	if (m_program == 0)
+	{
+		std::cout << "No shader program is in use to read the uniforms of" << std::endl;
+		return;
+	}
+
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	std::vector<char> nameBuffer(maxNameLength + 1);
+
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		GLuint uniformIndex = (GLuint)i;
+		GLint blockIndex = -1;
+		glGetActiveUniformsiv(m_program, 1, &uniformIndex, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+		if (blockIndex != -1)
+		{
+			// members of uniform blocks are set through buffers
+			continue;
+		}
+
+		GLsizei nameLength = 0;
+		UNIFORM_INFO uniform;
+		glGetActiveUniform(m_program, uniformIndex, (GLsizei)nameBuffer.size(), &nameLength,
+			&uniform.arraySize, &uniform.type, nameBuffer.data());
+		std::string name(nameBuffer.data(), nameLength);
+		uniform.location = glGetUniformLocation(m_program, name.c_str());
+		m_uniforms[name] = uniform;
+		m_uniformCount++;
+
+		// arrays are reported with the first element in the name
+		const std::string firstElement = "[0]";
+		if ((name.size() > firstElement.size()) &&
+			(name.compare(name.size() - firstElement.size(), firstElement.size(), firstElement) == 0))
+		{
+			std::string arrayName = name.substr(0, name.size() - firstElement.size());
+			m_uniforms[arrayName] = uniform;
+			for (GLint element = 1; element < uniform.arraySize; element++)
+			{
+				std::string elementName = arrayName + "[" + std::to_string(element) + "]";
+				UNIFORM_INFO elementUniform = uniform;
+				elementUniform.location = glGetUniformLocation(m_program, elementName.c_str());
+				elementUniform.arraySize = uniform.arraySize - element;
+				m_uniforms[elementName] = elementUniform;
+			}
+		}
+	}
+
+	GLint blockCount = 0;
+	GLint maxBlockNameLength = 0;
+	glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+	glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockNameLength);
+	nameBuffer.resize(maxBlockNameLength + 1);
+
+	for (GLint i = 0; i < blockCount; i++)
+	{
+		GLsizei nameLength = 0;
+		UNIFORM_BLOCK_INFO block;
+		block.index = (GLuint)i;
+		glGetActiveUniformBlockName(m_program, block.index, (GLsizei)nameBuffer.size(), &nameLength, nameBuffer.data());
+		glGetActiveUniformBlockiv(m_program, block.index, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+		m_blocks[std::string(nameBuffer.data(), nameLength)] = block;
+	}
+
+	std::cout << "Shader program has " << m_uniformCount << " active uniforms and "
+		<< m_blocks.size() << " uniform blocks" << std::endl;
+}
+
+/***********************************************************
+ *  SetProgram()
+ *
+ *  This method is used for moving to another program, which
+ *  must already be in use.  The uniform blocks are given the
+ *  bindings that the blocks of the same name had in the
+ *  earlier program, each handle is looked up again, and the
+ *  kept values are uploaded to the new program.
+ ***********************************************************/
+void UniformManager::SetProgram(GLuint program)
+{
+	GLuint previousProgram = m_program;
+	std::unordered_map<std::string, UNIFORM_BLOCK_INFO> previousBlocks = m_blocks;
+
+	m_program = program;
+	ReflectProgram();
+
+	for (const auto& block : m_blocks)
+	{
+		auto previous = previousBlocks.find(block.first);
+		if ((previousProgram != 0) && (previous != previousBlocks.end()))
+		{
+			GLint binding = 0;
+			glGetActiveUniformBlockiv(previousProgram, previous->second.index, GL_UNIFORM_BLOCK_BINDING, &binding);
+			glUniformBlockBinding(m_program, block.second.index, (GLuint)binding);
+		}
+	}
+
+	for (UNIFORM_SLOT& slot : m_slots)
+	{
+		auto found = m_uniforms.find(slot.name);
+		slot.location = (found != m_uniforms.end()) ? found->second.location : -1;
+		if ((slot.location == -1) && (m_bReportUnused))
+		{
+			std::cout << "Uniform " << slot.name << " is not used by the shader program" << std::endl;
+		}
+		if ((slot.location != -1) && (slot.size > 0))
+		{
+			UploadValue(slot);
+		}
+	}
+}
+
+/***********************************************************
+ *  GetHandle()
+ *
+ *  This method is used for getting the handle of a uniform
+ *  from its name.  The same name always gets the same
+ *  handle, and setting a name that the program does not use
+ *  keeps the value without uploading it.
+ ***********************************************************/
+int UniformManager::GetHandle(const std::string& name)
+{
+	auto handle = m_handles.find(name);
+	if (handle != m_handles.end())
+	{
+		return(handle->second);
+	}
+
+	UNIFORM_SLOT slot;
+	slot.name = name;
+	slot.location = -1;
+	slot.type = GL_NONE;
+	slot.size = 0;
+
+	auto found = m_uniforms.find(name);
+	if (found != m_uniforms.end())
+	{
+		slot.location = found->second.location;
+	}
+	else if (m_bReportUnused)
+	{
+		std::cout << "Uniform " << name << " is not used by the shader program" << std::endl;
+	}
+
+	m_slots.push_back(slot);
+	m_handles[name] = (int)m_slots.size() - 1;
+	return((int)m_slots.size() - 1);
+}
+
+/***********************************************************
+ *  GetBlockIndex()
+ *
+ *  This method is used for getting the index of a uniform
+ *  block from its name.
+ ***********************************************************/
+GLuint UniformManager::GetBlockIndex(const std::string& name)
+{
+	auto found = m_blocks.find(name);
+	if (found != m_blocks.end())
+	{
+		return(found->second.index);
+	}
+
+	std::cout << "Uniform block " << name << " is not used by the shader program" << std::endl;
+	return(GL_INVALID_INDEX);
+}
+
+/***********************************************************
+ *  WriteValue()
+ *
+ *  This method is used for writing a value through a handle.
+ *  A value that matches the kept one is counted as redundant
+ *  and is not uploaded.  Other values are kept and uploaded,
+ *  unless the program does not use the uniform.
+ ***********************************************************/
+void UniformManager::WriteValue(int handle, GLenum type, const void* pValue, uint32_t size)
+{
+	if ((handle < 0) || (handle >= (int)m_slots.size()))
+	{
+		return;
+	}
+
+	UNIFORM_SLOT& slot = m_slots[handle];
+	if ((slot.size == size) && (slot.type == type) && (memcmp(slot.data, pValue, size) == 0))
+	{
+		if (slot.location == -1)
+		{
+			return;
+		}
+		m_frameRedundantWrites++;
+		if (m_bCacheEnabled)
+		{
+			return;
+		}
+	}
+	else
+	{
+		slot.type = type;
+		slot.size = size;
+		memcpy(slot.data, pValue, size);
+	}
+
+	if (slot.location != -1)
+	{
+		UploadValue(slot);
+		m_frameUploads++;
+	}
+}
+
+/***********************************************************
+ *  UploadValue()
+ *
+ *  This method is used for uploading the kept value of a
+ *  slot into the program in use.
+ ***********************************************************/
+void UniformManager::UploadValue(const UNIFORM_SLOT& slot)
+{
+	const GLint* pInt = (const GLint*)slot.data;
+	const GLfloat* pFloat = (const GLfloat*)slot.data;
+
+	switch (slot.type)
+	{
+	case GL_INT:
+		glUniform1iv(slot.location, 1, pInt);
+		break;
+	case GL_FLOAT:
+		glUniform1fv(slot.location, 1, pFloat);
+		break;
+	case GL_FLOAT_VEC2:
+		glUniform2fv(slot.location, 1, pFloat);
+		break;
+	case GL_FLOAT_VEC3:
+		glUniform3fv(slot.location, 1, pFloat);
+		break;
+	case GL_FLOAT_VEC4:
+		glUniform4fv(slot.location, 1, pFloat);
+		break;
+	case GL_FLOAT_MAT4:
+		glUniformMatrix4fv(slot.location, 1, GL_FALSE, pFloat);
+		break;
+	default:
+		break;
+	}
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for closing the write counts of the
+ *  frame, and starting those of the next one.
+ ***********************************************************/
+void UniformManager::EndFrame()
+{
+	m_stats.frameUploads = m_frameUploads;
+	m_stats.frameRedundantWrites = m_frameRedundantWrites;
+	m_stats.totalUploads += m_frameUploads;
+	m_stats.totalRedundantWrites += m_frameRedundantWrites;
+	m_stats.frameCount++;
+
+	m_frameUploads = 0;
+	m_frameRedundantWrites = 0;
+}
+
+/***********************************************************
+ *  SetBoolValue()
+ *
+ *  This method is used for setting a bool uniform.
+ ***********************************************************/
+void UniformManager::SetBoolValue(int handle, bool value)
+{
+	GLint intValue = (GLint)value;
+	WriteValue(handle, GL_INT, &intValue, sizeof(intValue));
+}
+
+/***********************************************************
+ *  SetIntValue()
+ *
+ *  This method is used for setting an int or sampler uniform.
+ ***********************************************************/
+void UniformManager::SetIntValue(int handle, int value)
+{
+	GLint intValue = (GLint)value;
+	WriteValue(handle, GL_INT, &intValue, sizeof(intValue));
+}
+
+/***********************************************************
+ *  SetFloatValue()
+ *
+ *  This method is used for setting a float uniform.
+ ***********************************************************/
+void UniformManager::SetFloatValue(int handle, float value)
+{
+	WriteValue(handle, GL_FLOAT, &value, sizeof(value));
+}
+
+/***********************************************************
+ *  SetVec2Value()
+ *
+ *  This method is used for setting a vec2 uniform.
+ ***********************************************************/
+void UniformManager::SetVec2Value(int handle, const glm::vec2& value)
+{
+	WriteValue(handle, GL_FLOAT_VEC2, glm::value_ptr(value), sizeof(value));
+}
+
+/***********************************************************
+ *  SetVec3Value()
+ *
+ *  This method is used for setting a vec3 uniform.
+ ***********************************************************/
+void UniformManager::SetVec3Value(int handle, const glm::vec3& value)
+{
+	WriteValue(handle, GL_FLOAT_VEC3, glm::value_ptr(value), sizeof(value));
+}
+
+/***********************************************************
+ *  SetVec4Value()
+ *
+ *  This method is used for setting a vec4 uniform.
+ ***********************************************************/
+void UniformManager::SetVec4Value(int handle, const glm::vec4& value)
+{
+	WriteValue(handle, GL_FLOAT_VEC4, glm::value_ptr(value), sizeof(value));
+}
+
+/***********************************************************
+ *  SetMat4Value()
+ *
+ *  This method is used for setting a mat4 uniform.
+ ***********************************************************/
+void UniformManager::SetMat4Value(int handle, const glm::mat4& value)
+{
+	WriteValue(handle, GL_FLOAT_MAT4, glm::value_ptr(value), sizeof(value));
+}
@@ -0,0 +1,163 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformmanager.h
+// ============
+// look up the uniforms of the shader program once and set them by location
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  UNIFORM_INFO
+ *
+ *  An active uniform of the program.
+ ***********************************************************/
+struct UNIFORM_INFO
+{
+	GLint location;
+	GLenum type;
+	GLint arraySize;
+};
+
+/***********************************************************
+ *  UNIFORM_BLOCK_INFO
+ *
+ *  An active uniform block of the program.
+ ***********************************************************/
+struct UNIFORM_BLOCK_INFO
+{
+	GLuint index;
+	GLint dataSize;
+};
+
+/***********************************************************
+ *  UNIFORM_STATS
+ *
+ *  Counts of the uniform writes that were uploaded, and of
+ *  the redundant ones that matched the value the uniform
+ *  already had.
+ ***********************************************************/
+struct UNIFORM_STATS
+{
+	// writes of the last finished frame
+	uint64_t frameUploads;
+	uint64_t frameRedundantWrites;
+	// totals over all of the finished frames
+	uint64_t totalUploads;
+	uint64_t totalRedundantWrites;
+	uint64_t frameCount;
+};
+
+/***********************************************************
+ *  UniformManager
+ *
+ *  This class contains the code for reading the active
+ *  uniforms and uniform blocks of the shader program in use
+ *  into tables hashed by name.  A uniform is looked up once
+ *  for a handle, and the setters taking a handle are then an
+ *  index into an array and a direct call into OpenGL.  A
+ *  name that the program does not use is reported when it
+ *  is looked up, and setting it does not upload anything.
+ *
+ *  The last value written through each handle is kept, and a
+ *  write of the same value again is skipped, so objects that
+ *  share a material or color do not upload it for every
+ *  draw.  When another program is put in use, the handles
+ *  are looked up in it and the kept values are uploaded to
+ *  it, so the values set for the earlier program carry over.
+ ***********************************************************/
+class UniformManager
+{
+public:
+	// constructor
+	UniformManager();
+
+	// read the uniforms of another program that is now in use,
+	// and upload the kept values to it
+	void SetProgram(GLuint program);
+	// report the names that the program does not use, which is
+	// turned off while a simpler stand-in program is in use
+	void SetReportUnused(bool bReportUnused) { m_bReportUnused = bReportUnused; }
+
+	// get the handle of a uniform, which stays valid when the
+	// program is changed
+	int GetHandle(const std::string& name);
+	// get the index of a uniform block, or GL_INVALID_INDEX
+	GLuint GetBlockIndex(const std::string& name);
+	// get the number of active uniforms and uniform blocks
+	int GetUniformCount() const { return(m_uniformCount); }
+	int GetBlockCount() const { return((int)m_blocks.size()); }
+
+	// upload every write, still counting the redundant ones,
+	// for comparing against skipping them
+	void SetCacheEnabled(bool bEnabled) { m_bCacheEnabled = bEnabled; }
+	// finish counting the writes of a frame
+	void EndFrame();
+	// get the write counts
+	const UNIFORM_STATS& GetStats() const { return(m_stats); }
+
+	// set a uniform by its handle
+	void SetBoolValue(int handle, bool value);
+	void SetIntValue(int handle, int value);
+	void SetFloatValue(int handle, float value);
+	void SetVec2Value(int handle, const glm::vec2& value);
+	void SetVec3Value(int handle, const glm::vec3& value);
+	void SetVec4Value(int handle, const glm::vec4& value);
+	void SetMat4Value(int handle, const glm::mat4& value);
+
+	// set a uniform by its name, for values set only once
+	void SetBoolValue(const std::string& name, bool value) { SetBoolValue(GetHandle(name), value); }
+	void SetIntValue(const std::string& name, int value) { SetIntValue(GetHandle(name), value); }
+	void SetFloatValue(const std::string& name, float value) { SetFloatValue(GetHandle(name), value); }
+	void SetVec2Value(const std::string& name, const glm::vec2& value) { SetVec2Value(GetHandle(name), value); }
+	void SetVec3Value(const std::string& name, const glm::vec3& value) { SetVec3Value(GetHandle(name), value); }
+	void SetVec4Value(const std::string& name, const glm::vec4& value) { SetVec4Value(GetHandle(name), value); }
+	void SetMat4Value(const std::string& name, const glm::mat4& value) { SetMat4Value(GetHandle(name), value); }
+
+private:
+	// program that the uniforms were read from
+	GLuint m_program;
+	// active uniforms of the program by name, including each
+	// array element
+	std::unordered_map<std::string, UNIFORM_INFO> m_uniforms;
+	int m_uniformCount;
+	// uniform blocks by name
+	std::unordered_map<std::string, UNIFORM_BLOCK_INFO> m_blocks;
+	bool m_bReportUnused;
+
+	// a looked up uniform, with its location in the program and
+	// the last value written to it as raw bytes that fit the
+	// largest supported type
+	struct UNIFORM_SLOT
+	{
+		std::string name;
+		GLint location;
+		GLenum type;
+		uint32_t size;
+		unsigned char data[sizeof(glm::mat4)];
+	};
+	// looked up uniforms by handle, and the handles by name
+	std::vector<UNIFORM_SLOT> m_slots;
+	std::unordered_map<std::string, int> m_handles;
+	bool m_bCacheEnabled;
+
+	// write counts of the frame in progress and earlier ones
+	uint64_t m_frameUploads;
+	uint64_t m_frameRedundantWrites;
+	UNIFORM_STATS m_stats;
+
+	// read the active uniforms and blocks of the program
+	void ReflectProgram();
+	// keep a value written through a handle, and upload it
+	// unless it matches the kept value
+	void WriteValue(int handle, GLenum type, const void* pValue, uint32_t size);
+	// upload the kept value of a slot
+	void UploadValue(const UNIFORM_SLOT& slot);
+};
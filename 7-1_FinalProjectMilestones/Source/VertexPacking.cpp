@@ -0,0 +1,153 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexpacking.cpp
+// ============
+// convert mesh vertices into the compact 16 bytes per vertex format
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VertexPacking.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	/***********************************************************
+	 *  ToSnorm16()
+	 *
+	 *  Convert a value in the -1 to 1 range into a signed
+	 *  normalized 16-bit integer.
+	 ***********************************************************/
+	int16_t ToSnorm16(float value)
+	{
+		value = std::min(std::max(value, -1.0f), 1.0f);
+		return((int16_t)std::lround(value * 32767.0f));
+	}
+
+	/***********************************************************
+	 *  ToUnorm16()
+	 *
+	 *  Convert a value in the 0 to 1 range into an unsigned
+	 *  normalized 16-bit integer.
+	 ***********************************************************/
+	uint16_t ToUnorm16(float value)
+	{
+		value = std::min(std::max(value, 0.0f), 1.0f);
+		return((uint16_t)std::lround(value * 65535.0f));
+	}
+
+	/***********************************************************
+	 *  SignNotZero()
+	 *
+	 *  Return -1 for negative values and 1 for all others.
+	 ***********************************************************/
+	float SignNotZero(float value)
+	{
+		return((value < 0.0f) ? -1.0f : 1.0f);
+	}
+}
+
+/***********************************************************
+ *  EncodeOctahedralNormal()
+ *
+ *  This function is used for projecting a unit normal onto
+ *  an octahedron and unfolding it into a square, so that
+ *  the direction can be stored in two components.  The
+ *  vertex shader reverses this in OctahedralDecode().
+ ***********************************************************/
+void EncodeOctahedralNormal(const float normal[3], int16_t encoded[2])
+{
+	float length = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+	if (length <= 0.0f)
+	{
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+	}
+
+	float x = normal[0] / length;
+	float y = normal[1] / length;
+
+	// fold the lower half of the octahedron over the upper half
+	if (normal[2] < 0.0f)
+	{
+		float foldedX = (1.0f - std::fabs(y)) * SignNotZero(x);
+		float foldedY = (1.0f - std::fabs(x)) * SignNotZero(y);
+		x = foldedX;
+		y = foldedY;
+	}
+
+	encoded[0] = ToSnorm16(x);
+	encoded[1] = ToSnorm16(y);
+}
+
+/***********************************************************
+ *  PackMeshVertices()
+ *
+ *  This function is used for converting full precision
+ *  vertices into the packed format.  Positions and texture
+ *  coordinates are quantized relative to the bounds of the
+ *  mesh, and the matching dequantize values are returned.
+ ***********************************************************/
+void PackMeshVertices(
+	const std::vector<MESH_VERTEX>& vertices,
+	std::vector<MESH_VERTEX_PACKED>& packed,
+	VERTEX_DEQUANTIZE& dequantize)
+{
+	float positionMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float positionMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	float uvMin[2] = { FLT_MAX, FLT_MAX };
+	float uvMax[2] = { -FLT_MAX, -FLT_MAX };
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			positionMin[axis] = std::min(positionMin[axis], vertices[i].position[axis]);
+			positionMax[axis] = std::max(positionMax[axis], vertices[i].position[axis]);
+		}
+		for (int axis = 0; axis < 2; axis++)
+		{
+			uvMin[axis] = std::min(uvMin[axis], vertices[i].textureCoordinate[axis]);
+			uvMax[axis] = std::max(uvMax[axis], vertices[i].textureCoordinate[axis]);
+		}
+	}
+
+	// positions map -1..1 onto the bounds, texture coordinates
+	// map 0..1 onto the bounds - a flat axis keeps a scale of 1
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float halfExtent = 0.5f * (positionMax[axis] - positionMin[axis]);
+		dequantize.positionOffset[axis] = vertices.empty() ? 0.0f : 0.5f * (positionMax[axis] + positionMin[axis]);
+		dequantize.positionScale[axis] = (halfExtent > 0.0f) ? halfExtent : 1.0f;
+	}
+	for (int axis = 0; axis < 2; axis++)
+	{
+		float extent = uvMax[axis] - uvMin[axis];
+		dequantize.textureCoordinateOffset[axis] = vertices.empty() ? 0.0f : uvMin[axis];
+		dequantize.textureCoordinateScale[axis] = (extent > 0.0f) ? extent : 1.0f;
+	}
+
+	packed.resize(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		const MESH_VERTEX& vertex = vertices[i];
+		MESH_VERTEX_PACKED& output = packed[i];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			output.position[axis] = ToSnorm16(
+				(vertex.position[axis] - dequantize.positionOffset[axis]) / dequantize.positionScale[axis]);
+		}
+		output.padding = 0;
+
+		EncodeOctahedralNormal(vertex.normal, output.normal);
+
+		for (int axis = 0; axis < 2; axis++)
+		{
+			output.textureCoordinate[axis] = ToUnorm16(
+				(vertex.textureCoordinate[axis] - dequantize.textureCoordinateOffset[axis]) / dequantize.textureCoordinateScale[axis]);
+		}
+	}
+}
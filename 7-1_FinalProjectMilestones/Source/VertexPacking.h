@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexpacking.h
+// ============
+// convert mesh vertices into the compact 16 bytes per vertex format
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  MESH_VERTEX_PACKED
+ *
+ *  One compact vertex, half the size of MESH_VERTEX.  The
+ *  position is a normalized 16-bit value inside the mesh
+ *  bounds, the normal is octahedral encoded into two
+ *  normalized 16-bit values, and the texture coordinate is
+ *  a normalized 16-bit value inside the mesh UV bounds.
+ ***********************************************************/
+struct MESH_VERTEX_PACKED
+{
+	int16_t position[3];
+	int16_t padding;
+	int16_t normal[2];
+	uint16_t textureCoordinate[2];
+};
+
+/***********************************************************
+ *  VERTEX_DEQUANTIZE
+ *
+ *  The per mesh scale and offset that the vertex shader
+ *  applies to turn packed values back into positions and
+ *  texture coordinates.
+ ***********************************************************/
+struct VERTEX_DEQUANTIZE
+{
+	float positionScale[3];
+	float positionOffset[3];
+	float textureCoordinateScale[2];
+	float textureCoordinateOffset[2];
+};
+
+// convert full precision vertices into the packed format
+void PackMeshVertices(
+	const std::vector<MESH_VERTEX>& vertices,
+	std::vector<MESH_VERTEX_PACKED>& packed,
+	VERTEX_DEQUANTIZE& dequantize);
+
+// encode a unit normal into two octahedral coordinates
+void EncodeOctahedralNormal(const float normal[3], int16_t encoded[2]);
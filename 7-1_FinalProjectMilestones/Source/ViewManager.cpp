@@ -8,20 +8,27 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "ViewManager.h"
+#include "GLStateCache.h"
+#include "SPSCQueue.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>    
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+
 // declaration of the global variables and defines
 namespace
 {
 	// Variables for window width and height
 	const int WINDOW_WIDTH = 1000;
 	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
 
 	// camera object used for viewing and interacting with
 	// the 3D scene
@@ -32,9 +39,90 @@ namespace
 	float gLastY = WINDOW_HEIGHT / 2.0f;
 	bool gFirstMouse = true;
 
-	// time between current frame and last frame
-	float gDeltaTime = 0.0f; 
-	float gLastFrame = 0.0f;
+	// the input and window events are received on the main
+	// thread, and reach the thread that renders through a
+	// lock-free queue, which is drained once per frame
+	enum INPUT_EVENT_TYPE
+	{
+		INPUT_MOUSE_MOVE,
+		INPUT_SCROLL,
+		INPUT_PROJECTION,
+		INPUT_FRAMEBUFFER_SIZE,
+		INPUT_REFRESH
+	};
+
+	struct INPUT_EVENT
+	{
+		INPUT_EVENT_TYPE type;
+		float x;
+		float y;
+		int width;
+		int height;
+	};
+
+	const size_t INPUT_QUEUE_CAPACITY = 1024;
+	SPSCQueue<INPUT_EVENT> g_inputQueue(INPUT_QUEUE_CAPACITY);
+
+	// mouse movement and scrolling received by the callbacks
+	// on the main thread, which are sent as one event for each
+	// round of event processing
+	float g_mouseOffsetX = 0.0f;
+	float g_mouseOffsetY = 0.0f;
+	float g_scrollOffset = 0.0f;
+
+	// one bit for each held camera key, in the order of
+	// CAMERA_KEYS, written by the main thread only
+	const int CAMERA_KEYS[] = { GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D, GLFW_KEY_Q, GLFW_KEY_E };
+	const int CAMERA_KEY_COUNT = sizeof(CAMERA_KEYS) / sizeof(CAMERA_KEYS[0]);
+	std::atomic<unsigned int> g_heldCameraKeys(0);
+
+	// the render thread sleeps on this signal in on-demand mode
+	// until the main thread sends an event or the window closes
+	std::mutex g_eventMutex;
+	std::condition_variable g_eventSignal;
+	std::atomic<bool> g_bCloseRequested(false);
+
+	// mouse movement and scrolling taken from the queue, which
+	// the next update step applies to the camera
+	float g_pendingMouseX = 0.0f;
+	float g_pendingMouseY = 0.0f;
+	float g_pendingScroll = 0.0f;
+
+	// current size of the window framebuffer in pixels, which
+	// differs from the window size on high DPI displays
+	int g_framebufferWidth = WINDOW_WIDTH;
+	int g_framebufferHeight = WINDOW_HEIGHT;
+
+	// set by input and window events, and by RequestRedraw(),
+	// when the next frame must be drawn in on-demand mode
+	std::atomic<bool> g_bRedrawRequested(true);
+
+	/***********************************************************
+	 *  WakeRenderThread()
+	 *
+	 *  Wake the render thread if it is waiting for events.  The
+	 *  lock is always taken, so the signal cannot fall between
+	 *  the render thread checking for events and going to sleep.
+	 ***********************************************************/
+	void WakeRenderThread()
+	{
+		std::lock_guard<std::mutex> lock(g_eventMutex);
+		g_eventSignal.notify_one();
+	}
+
+	/***********************************************************
+	 *  SendInputEvent()
+	 *
+	 *  Add an event to the input queue.  The queue only fills
+	 *  up when the render thread has stopped taking events for
+	 *  a long time, and the event is dropped then.
+	 ***********************************************************/
+	void SendInputEvent(INPUT_EVENT_TYPE type, float x, float y, int width, int height)
+	{
+		INPUT_EVENT event = { type, x, y, width, height };
+		g_inputQueue.Push(event);
+		WakeRenderThread();
+	}
 
 	// the following variable is false when orthographic projection
 	// is off and true when it is on
@@ -52,6 +140,12 @@ ViewManager::ViewManager(
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
 	m_pWindow = NULL;
+	m_bRenderThread = false;
+	m_pFrameSync = NULL;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_viewPosition = glm::vec3(0.0f);
+	m_projectionWindow = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
 	g_pCamera = new Camera();
 	// default camera view parameters
 	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
@@ -59,6 +153,10 @@ ViewManager::ViewManager(
 	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
 	g_pCamera->Zoom = 80;
 	g_pCamera->MovementSpeed = 20;
+
+	m_previousCamera.position = g_pCamera->Position;
+	m_previousCamera.front = g_pCamera->Front;
+	m_previousCamera.up = g_pCamera->Up;
 }
 
 /***********************************************************
@@ -71,6 +169,7 @@ ViewManager::~ViewManager()
 	// free up allocated memory
 	m_pShaderManager = NULL;
 	m_pWindow = NULL;
+	m_pFrameSync = NULL;
 	if (NULL != g_pCamera)
 	{
 		delete g_pCamera;
@@ -86,8 +185,7 @@ ViewManager::~ViewManager()
  ***********************************************************/
 void scrollCallback(GLFWwindow* window, double xOffset, double yOffset)
 {
-	g_pCamera->ProcessMouseScroll(yOffset);
-	g_pCamera->MovementSpeed = std::max(0.1f, g_pCamera->MovementSpeed);
+	g_scrollOffset += (float)yOffset;
 }
 
 /***********************************************************
@@ -122,9 +220,16 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 	// this callback is used to receive mouse scrolling events
 	glfwSetScrollCallback(window, scrollCallback);
 
+	// these callbacks are used to know when a new frame must
+	// be drawn in the on-demand render mode
+	glfwSetKeyCallback(window, &ViewManager::Key_Callback);
+	glfwSetWindowRefreshCallback(window, &ViewManager::Window_Refresh_Callback);
+	glfwSetFramebufferSizeCallback(window, &ViewManager::Framebuffer_Size_Callback);
+	glfwGetFramebufferSize(window, &g_framebufferWidth, &g_framebufferHeight);
+
 	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GLStateCache::Enable(GL_BLEND);
+	GLStateCache::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	m_pWindow = window;
 
@@ -157,64 +262,185 @@ void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos,
 	gLastX = xMousePos;
 	gLastY = yMousePos;
 
-	// move the 3D camera according to the calculated offsets
-	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
+	// the offsets move the 3D camera in the next update step
+	g_mouseOffsetX += xOffset;
+	g_mouseOffsetY += yOffset;
 }
 
 /***********************************************************
- *  ProcessKeyboardEvents()
+ *  Key_Callback()
  *
- *  This method is called to process any keyboard events
- *  that may be waiting in the event queue.
+ *  This method is automatically called from GLFW whenever a
+ *  key is pressed or released.  The held camera keys are
+ *  kept for ProcessKeyboardEvents(), and the keys that
+ *  switch the projection are sent as events.
  ***********************************************************/
-void ViewManager::ProcessKeyboardEvents()
+void ViewManager::Key_Callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
 	// close the window if the escape key has been pressed
-	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+	if ((key == GLFW_KEY_ESCAPE) && (action == GLFW_PRESS))
 	{
-		glfwSetWindowShouldClose(m_pWindow, true);
+		glfwSetWindowShouldClose(window, true);
 	}
 
-	// process camera zooming in and out
-	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
+	for (int i = 0; i < CAMERA_KEY_COUNT; i++)
+	{
+		if (key == CAMERA_KEYS[i])
+		{
+			if (action == GLFW_PRESS)
+			{
+				g_heldCameraKeys.fetch_or(1u << i);
+			}
+			else if (action == GLFW_RELEASE)
+			{
+				g_heldCameraKeys.fetch_and(~(1u << i));
+			}
+		}
+	}
+
+	// process switching projection mode
+	if ((key == GLFW_KEY_P) && (action == GLFW_PRESS))
 	{
-		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
+		SendInputEvent(INPUT_PROJECTION, 0.0f, 0.0f, 0, 0);
 	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
+	else if ((key == GLFW_KEY_O) && (action == GLFW_PRESS))
 	{
-		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
+		SendInputEvent(INPUT_PROJECTION, 0.0f, 0.0f, 1, 0);
 	}
 
-	// process camera panning left and right
-	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
+	g_bRedrawRequested = true;
+	WakeRenderThread();
+}
+
+/***********************************************************
+ *  Window_Refresh_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the window contents were damaged and must be redrawn.
+ ***********************************************************/
+void ViewManager::Window_Refresh_Callback(GLFWwindow* window)
+{
+	SendInputEvent(INPUT_REFRESH, 0.0f, 0.0f, 0, 0);
+}
+
+/***********************************************************
+ *  Framebuffer_Size_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the size of the window framebuffer changes.  The new size
+ *  is used for the viewport and the projection aspect ratio.
+ ***********************************************************/
+void ViewManager::Framebuffer_Size_Callback(GLFWwindow* window, int width, int height)
+{
+	SendInputEvent(INPUT_FRAMEBUFFER_SIZE, 0.0f, 0.0f, width, height);
+}
+
+/***********************************************************
+ *  FlushInputEvents()
+ *
+ *  This method is used on the main thread after the waiting
+ *  window events were processed.  The mouse movement and
+ *  scrolling of all the processed events are sent as one
+ *  event each, so fast mouse movement cannot fill the queue.
+ ***********************************************************/
+void ViewManager::FlushInputEvents()
+{
+	if ((g_mouseOffsetX != 0.0f) || (g_mouseOffsetY != 0.0f))
 	{
-		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
+		SendInputEvent(INPUT_MOUSE_MOVE, g_mouseOffsetX, g_mouseOffsetY, 0, 0);
+		g_mouseOffsetX = 0.0f;
+		g_mouseOffsetY = 0.0f;
 	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
+	if (g_scrollOffset != 0.0f)
 	{
-		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
+		SendInputEvent(INPUT_SCROLL, 0.0f, g_scrollOffset, 0, 0);
+		g_scrollOffset = 0.0f;
 	}
+}
 
-	// process camera moving up and down
-	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
+/***********************************************************
+ *  ProcessInputEvents()
+ *
+ *  This method is used on the rendering thread at the start
+ *  of a frame, for taking all the events from the queue.
+ *  When the main thread also renders, the window events are
+ *  processed here first.
+ ***********************************************************/
+void ViewManager::ProcessInputEvents()
+{
+	if (m_bRenderThread == false)
 	{
-		g_pCamera->Position.y += gDeltaTime * g_pCamera->MovementSpeed;
+		glfwPollEvents();
+		FlushInputEvents();
 	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
+
+	INPUT_EVENT event;
+	while (g_inputQueue.Pop(event))
 	{
-		g_pCamera->Position.y -= gDeltaTime * g_pCamera->MovementSpeed;
+		switch (event.type)
+		{
+		case INPUT_MOUSE_MOVE:
+			g_pendingMouseX += event.x;
+			g_pendingMouseY += event.y;
+			break;
+		case INPUT_SCROLL:
+			g_pendingScroll += event.y;
+			break;
+		case INPUT_PROJECTION:
+			bOrthographicProjection = (event.width != 0);
+			break;
+		case INPUT_FRAMEBUFFER_SIZE:
+			g_framebufferWidth = event.width;
+			g_framebufferHeight = event.height;
+			break;
+		case INPUT_REFRESH:
+			break;
+		}
+
+		g_bRedrawRequested = true;
 	}
+}
 
-	// process switching projection mode
-	if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS)
+/***********************************************************
+ *  ProcessKeyboardEvents()
+ *
+ *  This method is called to process any keyboard events
+ *  that may be waiting in the event queue.  The camera moves
+ *  for the passed in length of one update step.
+ ***********************************************************/
+void ViewManager::ProcessKeyboardEvents(float deltaTime)
+{
+	// the held keys are one bit each, in the order of CAMERA_KEYS
+	unsigned int heldKeys = g_heldCameraKeys.load();
+
+	// process camera zooming in and out
+	if (heldKeys & (1u << 0))
+	{
+		g_pCamera->ProcessKeyboard(FORWARD, deltaTime);
+	}
+	if (heldKeys & (1u << 1))
+	{
+		g_pCamera->ProcessKeyboard(BACKWARD, deltaTime);
+	}
+
+	// process camera panning left and right
+	if (heldKeys & (1u << 2))
+	{
+		g_pCamera->ProcessKeyboard(LEFT, deltaTime);
+	}
+	if (heldKeys & (1u << 3))
+	{
+		g_pCamera->ProcessKeyboard(RIGHT, deltaTime);
+	}
+
+	// process camera moving up and down
+	if (heldKeys & (1u << 4))
 	{
-		bOrthographicProjection = false;
-		UpdateProjectionMatrix();
+		g_pCamera->Position.y += deltaTime * g_pCamera->MovementSpeed;
 	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_PRESS)
+	if (heldKeys & (1u << 5))
 	{
-		bOrthographicProjection = true;
-		UpdateProjectionMatrix();
+		g_pCamera->Position.y -= deltaTime * g_pCamera->MovementSpeed;
 	}
 }
 
@@ -229,60 +455,353 @@ void ViewManager::UpdateProjectionMatrix()
 {
 	glm::mat4 projection;
 
+	// the aspect ratio follows the window as it is resized,
+	// and a minimized window keeps the last valid ratio
+	static float aspectRatio = (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT;
+	if ((g_framebufferWidth > 0) && (g_framebufferHeight > 0))
+	{
+		aspectRatio = (float)g_framebufferWidth / (float)g_framebufferHeight;
+	}
+
 	if (bOrthographicProjection)
 	{
 		// Orthographic projection
-		projection = glm::ortho(-WINDOW_WIDTH / 2.0f, WINDOW_WIDTH / 2.0f, -WINDOW_HEIGHT / 2.0f, WINDOW_HEIGHT / 2.0f, 0.1f, 100.0f);
+		float halfHeight = WINDOW_HEIGHT / 2.0f;
+		projection = glm::ortho(-halfHeight * aspectRatio, halfHeight * aspectRatio, -halfHeight, halfHeight, 0.1f, 100.0f);
 	}
 	else
 	{
 		// Perspective projection
-		projection = glm::perspective(glm::radians(g_pCamera->Zoom), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 0.1f, 100.0f);
+		projection = glm::perspective(glm::radians(g_pCamera->Zoom), aspectRatio, 0.1f, 100.0f);
 	}
 
-	if (m_pShaderManager != NULL)
+	// a tile of the image is projected by stretching its area
+	// of the normalized device coordinates over the whole
+	// range, which gives the off-center frustum of the tile
+	if (m_projectionWindow != glm::vec4(0.0f, 0.0f, 1.0f, 1.0f))
 	{
-		// set the projection matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
+		glm::vec4 window = m_projectionWindow * 2.0f - glm::vec4(1.0f);
+		glm::mat4 tile(1.0f);
+		tile[0][0] = 2.0f / (window.z - window.x);
+		tile[1][1] = 2.0f / (window.w - window.y);
+		tile[3][0] = -(window.z + window.x) / (window.z - window.x);
+		tile[3][1] = -(window.w + window.y) / (window.w - window.y);
+		projection = tile * projection;
 	}
+
+	m_projectionMatrix = projection;
 }
 
 /***********************************************************
- *  PrepareSceneView()
+ *  UpdateView()
  *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
+ *  This method is used for running one fixed length update
+ *  step of the camera.  The state before the step is kept
+ *  for interpolating, then the mouse movement received since
+ *  the last step and the held keys are applied.
  ***********************************************************/
-void ViewManager::PrepareSceneView()
+void ViewManager::UpdateView(double stepSeconds)
 {
-	glm::mat4 view;
-	glm::mat4 projection;
+	m_previousCamera.position = g_pCamera->Position;
+	m_previousCamera.front = g_pCamera->Front;
+	m_previousCamera.up = g_pCamera->Up;
 
-	// per-frame timing
-	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
-	gLastFrame = currentFrame;
+	if ((g_pendingMouseX != 0.0f) || (g_pendingMouseY != 0.0f))
+	{
+		g_pCamera->ProcessMouseMovement(g_pendingMouseX, g_pendingMouseY);
+		g_pendingMouseX = 0.0f;
+		g_pendingMouseY = 0.0f;
+	}
+	if (g_pendingScroll != 0.0f)
+	{
+		g_pCamera->ProcessMouseScroll(g_pendingScroll);
+		g_pCamera->MovementSpeed = std::max(0.1f, g_pCamera->MovementSpeed);
+		g_pendingScroll = 0.0f;
+	}
 
 	// process any keyboard events that may be waiting in the 
 	// event queue
-	ProcessKeyboardEvents();
+	ProcessKeyboardEvents((float)stepSeconds);
+}
+
+/***********************************************************
+ *  PrepareSceneView()
+ *
+ *  This method is used for setting the view and projection
+ *  of the frame into the per-frame uniform buffer.  The
+ *  camera is placed the passed in fraction of the way from
+ *  the state before the last update step to the state after
+ *  it, so the movement is smooth at any frame rate.
+ ***********************************************************/
+void ViewManager::PrepareSceneView(double interpolation)
+{
+	glm::mat4 view;
+	float alpha = (float)interpolation;
 
 	// call to update projection on every frame.
 	UpdateProjectionMatrix();
 
+	// the direction vectors are blended and normalized again,
+	// which is close enough to a rotation for one short step
+	glm::vec3 position = glm::mix(m_previousCamera.position, g_pCamera->Position, alpha);
+	glm::vec3 front = glm::normalize(glm::mix(m_previousCamera.front, g_pCamera->Front, alpha));
+	glm::vec3 up = glm::normalize(glm::mix(m_previousCamera.up, g_pCamera->Up, alpha));
+
 	// get the current view matrix from the camera
-	view = g_pCamera->GetViewMatrix();
+	view = glm::lookAt(position, position + front, up);
+	m_viewMatrix = view;
+	m_viewPosition = position;
+
+	// the view, projection and view position of the frame are
+	// written into its region of the per-frame uniform buffer
+	if (NULL != m_pFrameSync)
+	{
+		m_pFrameSync->SetFrameUniforms(view, m_projectionMatrix, position);
+	}
+}
+
+/***********************************************************
+ *  GetCameraPosition()
+ *
+ *  This method is used for getting the world position of
+ *  the camera in the current frame.
+ ***********************************************************/
+glm::vec3 ViewManager::GetCameraPosition() const
+{
+	return(m_viewPosition);
+}
+
+/***********************************************************
+ *  IsPerspective()
+ *
+ *  This method is used for checking whether the scene is
+ *  rendered with the perspective projection.
+ ***********************************************************/
+bool ViewManager::IsPerspective() const
+{
+	return(bOrthographicProjection == false);
+}
+
+/***********************************************************
+ *  IsCameraKeyHeld()
+ *
+ *  This method is used for checking whether any of the keys
+ *  that move the camera is held down.  The camera keeps
+ *  moving while they are held, without any new events.
+ ***********************************************************/
+bool ViewManager::IsCameraKeyHeld() const
+{
+	return(g_heldCameraKeys.load() != 0);
+}
+
+/***********************************************************
+ *  RequestRedraw()
+ *
+ *  This method is used for marking the next frame as needing
+ *  to be drawn.  Code that edits or animates the scene calls
+ *  it so that the on-demand render loop shows the change.
+ *  It can be called from any thread.
+ ***********************************************************/
+void ViewManager::RequestRedraw()
+{
+	g_bRedrawRequested = true;
+	WakeRenderThread();
+}
+
+/***********************************************************
+ *  NeedsRedraw()
+ *
+ *  This method is used for checking whether a new frame has
+ *  to be drawn, because of an input or window event, a
+ *  redraw request, a held camera key, or a camera that moved
+ *  in the last update step.  The pending request is cleared
+ *  by the check.
+ ***********************************************************/
+bool ViewManager::NeedsRedraw()
+{
+	// the camera has not come to rest while the last update
+	// step still moved it
+	bool bCameraSettling =
+		(m_previousCamera.position != g_pCamera->Position) ||
+		(m_previousCamera.front != g_pCamera->Front) ||
+		(m_previousCamera.up != g_pCamera->Up);
+
+	bool bNeedsRedraw = (g_bRedrawRequested.exchange(false)) || (IsCameraKeyHeld()) || (bCameraSettling);
+
+	return(bNeedsRedraw);
+}
+
+/***********************************************************
+ *  WaitForEvents()
+ *
+ *  This method is used for blocking the calling thread until
+ *  a window or input event arrives, so an unchanged scene
+ *  uses no CPU or GPU time.  A render thread waits for the
+ *  main thread to send an event, a redraw request, or the
+ *  request to close.  A timeout above zero ends the wait
+ *  early, for a caller that polls work of its own.
+ ***********************************************************/
+void ViewManager::WaitForEvents(double timeoutSeconds)
+{
+	if (m_bRenderThread == false)
+	{
+		if (timeoutSeconds > 0.0)
+		{
+			glfwWaitEventsTimeout(timeoutSeconds);
+		}
+		else
+		{
+			glfwWaitEvents();
+		}
+		FlushInputEvents();
+		return;
+	}
+
+	auto bEventArrived = []()
+		{
+			return((g_inputQueue.IsEmpty() == false) || (g_bRedrawRequested.load()) ||
+				(g_heldCameraKeys.load() != 0) || (g_bCloseRequested.load()));
+		};
+
+	std::unique_lock<std::mutex> lock(g_eventMutex);
+	if (timeoutSeconds > 0.0)
+	{
+		g_eventSignal.wait_for(lock, std::chrono::duration<double>(timeoutSeconds), bEventArrived);
+	}
+	else
+	{
+		g_eventSignal.wait(lock, bEventArrived);
+	}
+}
+
+/***********************************************************
+ *  GetFramebufferSize()
+ *
+ *  This method is used for getting the current size of the
+ *  window framebuffer in pixels.  The size is zero while the
+ *  window is minimized.
+ ***********************************************************/
+void ViewManager::GetFramebufferSize(int& width, int& height) const
+{
+	width = g_framebufferWidth;
+	height = g_framebufferHeight;
+}
 
-	// define the current projection matrix
-	projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
+/***********************************************************
+ *  SetFramebufferSize()
+ *
+ *  This method is used for setting the size that the
+ *  projection aspect ratio is made for, when the frame is
+ *  rendered into an offscreen target instead of a window.
+ ***********************************************************/
+void ViewManager::SetFramebufferSize(int width, int height)
+{
+	g_framebufferWidth = width;
+	g_framebufferHeight = height;
+}
+
+/***********************************************************
+ *  SetProjectionWindow()
+ *
+ *  This method is used for projecting only an area of the
+ *  full image, given as fractions of its width and height
+ *  from the lower left corner.  The area may reach past the
+ *  image edges.  Passing 0, 0, 1, 1 projects the full image.
+ ***********************************************************/
+void ViewManager::SetProjectionWindow(float left, float bottom, float right, float top)
+{
+	m_projectionWindow = glm::vec4(left, bottom, right, top);
+}
+
+/***********************************************************
+ *  SetCameraPose()
+ *
+ *  This method is used for placing the camera at a position,
+ *  looking at a target point with the passed in vertical
+ *  field of view in degrees.  The pose replaces both update
+ *  states, so the next frame is not blended with the last.
+ ***********************************************************/
+void ViewManager::SetCameraPose(const glm::vec3& position, const glm::vec3& target, float fieldOfView)
+{
+	glm::vec3 front = target - position;
+	if (glm::length(front) <= 0.0f)
+	{
+		front = glm::vec3(0.0f, 0.0f, -1.0f);
+	}
+	front = glm::normalize(front);
+
+	// a camera looking straight up or down takes its up
+	// direction from the world depth axis instead
+	glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+	if (std::abs(glm::dot(front, up)) > 0.999f)
+	{
+		up = glm::vec3(0.0f, 0.0f, -1.0f);
+	}
+
+	g_pCamera->Position = position;
+	g_pCamera->Front = front;
+	g_pCamera->Up = up;
+	g_pCamera->Yaw = glm::degrees(atan2f(front.z, front.x));
+	g_pCamera->Pitch = glm::degrees(asinf(front.y));
+	g_pCamera->Zoom = fieldOfView;
+	bOrthographicProjection = false;
+
+	m_previousCamera.position = g_pCamera->Position;
+	m_previousCamera.front = g_pCamera->Front;
+	m_previousCamera.up = g_pCamera->Up;
+}
+
+/***********************************************************
+ *  SetRenderThread()
+ *
+ *  This method is used for choosing whether the scene is
+ *  rendered on a thread of its own.  The main thread then
+ *  only processes the window events, and the rendering
+ *  thread never calls the GLFW event functions, which may
+ *  only be used on the main thread.
+ ***********************************************************/
+void ViewManager::SetRenderThread(bool bRenderThread)
+{
+	m_bRenderThread = bRenderThread;
+}
+
+/***********************************************************
+ *  RequestClose()
+ *
+ *  This method is used on the main thread for telling the
+ *  render thread to stop when the window is closing.
+ ***********************************************************/
+void ViewManager::RequestClose()
+{
+	g_bCloseRequested = true;
+
+	std::lock_guard<std::mutex> lock(g_eventMutex);
+	g_eventSignal.notify_one();
+}
 
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
+/***********************************************************
+ *  IsClosing()
+ *
+ *  This method is used by the render loop for checking
+ *  whether it must stop.
+ ***********************************************************/
+bool ViewManager::IsClosing() const
+{
+	if (m_bRenderThread)
 	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+		return(g_bCloseRequested.load());
 	}
-}
\ No newline at end of file
+
+	return(glfwWindowShouldClose(m_pWindow) != 0);
+}
+
+/***********************************************************
+ *  SetFrameSync()
+ *
+ *  This method is used for setting the per-frame uniform
+ *  buffer that PrepareSceneView() writes the camera into.
+ ***********************************************************/
+void ViewManager::SetFrameSync(FrameSync* pFrameSync)
+{
+	m_pFrameSync = pFrameSync;
+}
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "FrameSync.h"
 #include "camera.h"
 
 // GLFW library
@@ -26,23 +27,93 @@ public:
 
 	// mouse position callback for mouse interaction with the 3D scene
 	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
+	// keyboard callback, used for waking up an idle on-demand loop
+	static void Key_Callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+	// window callbacks for when the window contents must be redrawn
+	static void Window_Refresh_Callback(GLFWwindow* window);
+	static void Framebuffer_Size_Callback(GLFWwindow* window, int width, int height);
+	// send the collected mouse movement to the rendering thread
+	static void FlushInputEvents();
 
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// true when the scene is rendered on a separate thread
+	bool m_bRenderThread;
+	// per-frame uniform buffer the camera is written into
+	FrameSync* m_pFrameSync;
+	// view and projection matrices of the current frame
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	glm::vec3 m_viewPosition;
+	// area of the full image that the projection covers, as
+	// left, bottom, right and top fractions of the image
+	glm::vec4 m_projectionWindow;
+
+	// camera state before the last update step
+	struct CAMERA_STATE
+	{
+		glm::vec3 position;
+		glm::vec3 front;
+		glm::vec3 up;
+	};
+	CAMERA_STATE m_previousCamera;
 
 	// process keyboard events for interaction with the 3D scene
-	void ProcessKeyboardEvents();
+	void ProcessKeyboardEvents(float deltaTime);
+	// true while a key that moves the camera is held down
+	bool IsCameraKeyHeld() const;
 
 public:
 	// create the initial OpenGL display window
 	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
 	
-	// prepare the conversion from 3D object display to 2D scene display
-	void PrepareSceneView();
+	// take the events sent from the main thread
+	void ProcessInputEvents();
+	// move the camera by one fixed length update step
+	void UpdateView(double stepSeconds);
+	// prepare the conversion from 3D object display to 2D scene display,
+	// between the camera states before and after the last update
+	void PrepareSceneView(double interpolation = 1.0);
+
+	// set the per-frame uniform buffer for the camera
+	void SetFrameSync(FrameSync* pFrameSync);
 
 	// update the projection matrix for the 3D scene
 	void UpdateProjectionMatrix();
+
+	// get the matrices and camera position of the current frame
+	glm::mat4 GetViewMatrix() const { return(m_viewMatrix); }
+	glm::mat4 GetProjectionMatrix() const { return(m_projectionMatrix); }
+	glm::vec3 GetCameraPosition() const;
+	// true when the perspective projection is active
+	bool IsPerspective() const;
+	// get the current size of the window framebuffer
+	void GetFramebufferSize(int& width, int& height) const;
+	// set the size that the projection is made for, when
+	// rendering into an offscreen target
+	void SetFramebufferSize(int width, int height);
+	// place the camera at a position looking at a target point
+	void SetCameraPose(const glm::vec3& position, const glm::vec3& target, float fieldOfView);
+	// project only an area of the full image, for rendering
+	// it in tiles, where 0 to 1 covers the whole image
+	void SetProjectionWindow(float left, float bottom, float right, float top);
+
+	// mark the next frame as needing to be drawn, for scene
+	// edits and animations in the on-demand render mode
+	static void RequestRedraw();
+	// check whether anything changed since the last frame
+	bool NeedsRedraw();
+	// sleep until the next window or input event arrives, or
+	// until the passed in number of seconds, when above zero
+	void WaitForEvents(double timeoutSeconds = 0.0);
+
+	// render the scene on a thread other than the event thread
+	void SetRenderThread(bool bRenderThread);
+	// tell the render loop to stop, from the main thread
+	static void RequestClose();
+	// true when the render loop must stop
+	bool IsClosing() const;
 };
\ No newline at end of file
@@ -0,0 +1,175 @@
+///////////////////////////////////////////////////////////////////////////////
+// workerpool.cpp
+// ============
+// a fixed set of worker threads that run queued tasks
+///////////////////////////////////////////////////////////////////////////////
+
+#include "WorkerPool.h"
+
+#include <atomic>
+
+/***********************************************************
+ *  WorkerPool()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+WorkerPool::WorkerPool(unsigned int threadCount)
+{
+	m_pendingTasks = 0;
+	m_bStopping = false;
+
+	if (threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+	if (threadCount == 0)
+	{
+		threadCount = 1;
+	}
+
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		m_threads.push_back(std::thread(&WorkerPool::WorkerLoop, this));
+	}
+}
+
+/***********************************************************
+ *  ~WorkerPool()
+ *
+ *  The destructor for the class - the queued tasks are
+ *  finished before the worker threads are joined.
+ ***********************************************************/
+WorkerPool::~WorkerPool()
+{
+	WaitForAll();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_taskReady.notify_all();
+
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for queueing a task to run on the
+ *  next free worker thread.
+ ***********************************************************/
+void WorkerPool::Submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasks.push_back(std::move(task));
+		m_pendingTasks++;
+	}
+	m_taskReady.notify_one();
+}
+
+/***********************************************************
+ *  WaitForAll()
+ *
+ *  This method is used for blocking until all the queued
+ *  and running tasks have finished.
+ ***********************************************************/
+void WorkerPool::WaitForAll()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_allDone.wait(lock, [this]() { return(m_pendingTasks == 0); });
+}
+
+/***********************************************************
+ *  ParallelFor()
+ *
+ *  This method is used for running a task once for every
+ *  index from 0 to count - 1.  The workers and the calling
+ *  thread take indices from a shared counter, and the call
+ *  returns when every index has been processed.
+ ***********************************************************/
+void WorkerPool::ParallelFor(size_t count, const std::function<void(size_t)>& task)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	if (count == 1)
+	{
+		task(0);
+		return;
+	}
+
+	std::atomic<size_t> nextIndex(0);
+	std::atomic<size_t> finished(0);
+	std::mutex doneMutex;
+	std::condition_variable doneSignal;
+
+	auto RunIndices = [&]()
+	{
+		size_t completed = 0;
+		for (size_t index = nextIndex++; index < count; index = nextIndex++)
+		{
+			task(index);
+			completed++;
+		}
+		if ((completed > 0) && (finished.fetch_add(completed) + completed == count))
+		{
+			std::lock_guard<std::mutex> lock(doneMutex);
+			doneSignal.notify_all();
+		}
+	};
+
+	size_t helpers = std::min(count - 1, m_threads.size());
+	for (size_t i = 0; i < helpers; i++)
+	{
+		Submit(RunIndices);
+	}
+	RunIndices();
+
+	std::unique_lock<std::mutex> lock(doneMutex);
+	doneSignal.wait(lock, [&]() { return(finished.load() == count); });
+	lock.unlock();
+
+	// helpers that found no work left may still be exiting, and
+	// they reference the local variables of this call
+	WaitForAll();
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is run by every worker thread.  It takes
+ *  tasks from the queue until the pool is stopped.
+ ***********************************************************/
+void WorkerPool::WorkerLoop()
+{
+	for (;;)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_taskReady.wait(lock, [this]() { return(m_bStopping || (m_tasks.empty() == false)); });
+			if (m_tasks.empty())
+			{
+				return;
+			}
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+
+		task();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_pendingTasks--;
+			if (m_pendingTasks == 0)
+			{
+				m_allDone.notify_all();
+			}
+		}
+	}
+}
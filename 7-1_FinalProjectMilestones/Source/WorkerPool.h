@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////
+// workerpool.h
+// ============
+// a fixed set of worker threads that run queued tasks
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  WorkerPool
+ *
+ *  This class contains the code for running CPU work on a
+ *  fixed number of worker threads.  Tasks can be queued to
+ *  run in the background, or a loop can be split across
+ *  the workers with ParallelFor().  The tasks must not make
+ *  any OpenGL calls, since the context belongs to the
+ *  thread that created it.
+ ***********************************************************/
+class WorkerPool
+{
+public:
+	// constructor - zero threads means one per CPU core
+	WorkerPool(unsigned int threadCount);
+	// destructor
+	~WorkerPool();
+
+	// queue a task to run on one of the worker threads
+	void Submit(std::function<void()> task);
+	// wait until every queued task has finished
+	void WaitForAll();
+	// run task(0) to task(count - 1) across the workers and wait
+	void ParallelFor(size_t count, const std::function<void(size_t)>& task);
+
+	// number of worker threads
+	unsigned int GetThreadCount() const { return((unsigned int)m_threads.size()); }
+
+private:
+	// the pool cannot be copied
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	// the loop that each worker thread runs
+	void WorkerLoop();
+
+	std::vector<std::thread> m_threads;
+	std::deque<std::function<void()>> m_tasks;
+	std::mutex m_mutex;
+	// signaled when a task is queued or the pool stops
+	std::condition_variable m_taskReady;
+	// signaled when the last running task finishes
+	std::condition_variable m_allDone;
+	// queued plus running tasks
+	size_t m_pendingTasks;
+	bool m_bStopping;
+};
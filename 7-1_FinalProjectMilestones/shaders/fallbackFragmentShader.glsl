@@ -0,0 +1,29 @@
+#version 330 core
+
+// a stand-in for the scene shaders that compiles quickly, used
+// for the first frames while the scene shaders are compiled
+
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+
+out vec4 outFragmentColor;
+
+uniform bool bUseTexture=false;
+uniform vec4 objectColor = vec4(1.0f);
+uniform sampler2D objectTexture;
+uniform vec2 UVscale = vec2(1.0f, 1.0f);
+
+void main()
+{
+   // one fixed light from above instead of the scene lights
+   vec3 lightDirection = normalize(vec3(0.3f, 1.0f, 0.5f));
+   float shade = 0.4f + (0.6f * max(dot(normalize(fragmentVertexNormal), lightDirection), 0.0f));
+
+   vec4 color = objectColor;
+   if(bUseTexture == true)
+   {
+      color = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+   }
+
+   outFragmentColor = vec4(color.rgb * shade, color.a);
+}
@@ -0,0 +1,56 @@
+#version 330 core
+
+// a stand-in for the scene shaders that compiles quickly, used
+// for the first frames while the scene shaders are compiled
+
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+
+uniform mat4 model;
+
+// the camera of the frame, shared with the scene shaders
+layout (std140) uniform FrameUniforms
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPosition;
+};
+
+// packed vertices are decoded the same way as in the scene shaders
+uniform bool bPackedVertices = false;
+uniform vec3 positionScale = vec3(1.0f);
+uniform vec3 positionOffset = vec3(0.0f);
+uniform vec2 textureCoordinateScale = vec2(1.0f);
+uniform vec2 textureCoordinateOffset = vec2(0.0f);
+
+// decodes a normal that was encoded onto an octahedron
+vec3 OctahedralDecode(vec2 encoded)
+{
+   vec3 normal = vec3(encoded.xy, 1.0 - abs(encoded.x) - abs(encoded.y));
+   float fold = max(-normal.z, 0.0);
+   normal.x += (normal.x >= 0.0) ? -fold : fold;
+   normal.y += (normal.y >= 0.0) ? -fold : fold;
+   return normalize(normal);
+}
+
+void main()
+{
+   vec3 vertexPosition = inVertexPosition;
+   vec3 vertexNormal = inVertexNormal;
+   vec2 textureCoordinate = inTextureCoordinate;
+
+   if(bPackedVertices == true)
+   {
+      vertexPosition = positionOffset + (positionScale * inVertexPosition);
+      vertexNormal = OctahedralDecode(inVertexNormal.xy);
+      textureCoordinate = textureCoordinateOffset + (textureCoordinateScale * inTextureCoordinate);
+   }
+
+   gl_Position = projection * view * model * vec4(vertexPosition, 1.0f);
+   fragmentVertexNormal = mat3(model) * vertexNormal;
+   fragmentTextureCoordinate = textureCoordinate;
+}
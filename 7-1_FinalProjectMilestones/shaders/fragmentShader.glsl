@@ -21,14 +21,25 @@ struct LightSource
 in vec3 fragmentPosition;
 in vec3 fragmentVertexNormal;
 in vec2 fragmentTextureCoordinate;
+in vec3 vertexLightColor;
 
 out vec4 outFragmentColor;
 
+// the camera of the frame, written once per frame into a
+// region of a uniform buffer that is shared by both stages
+layout (std140) uniform FrameUniforms
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPosition;
+};
+
 uniform bool bUseTexture=false;
 uniform bool bUseLighting=false;
+uniform bool bPerVertexLighting=false;
+uniform int activeLightCount=TOTAL_LIGHTS;
 uniform vec4 objectColor = vec4(1.0f);
 uniform sampler2D objectTexture;
-uniform vec3 viewPosition;
 uniform vec2 UVscale = vec2(1.0f, 1.0f);
 uniform LightSource lightSources[TOTAL_LIGHTS];
 uniform Material material;
@@ -42,15 +53,24 @@ void main()
 {
    if(bUseLighting == true)
    {
-      // properties
-      vec3 lightNormal = normalize(fragmentVertexNormal);
-      vec3 viewDirection = normalize(viewPosition - fragmentPosition);
       vec3 phongResult = vec3(0.0f);
 
-      for(int i = 0; i < TOTAL_LIGHTS; i++)
+      // the lighting was already calculated for each vertex
+      if(bPerVertexLighting == true)
       {
-         phongResult += CalcLightSource(lightSources[i], lightNormal, fragmentPosition, viewDirection); 
-      }   
+         phongResult = vertexLightColor;
+      }
+      else
+      {
+         // properties
+         vec3 lightNormal = normalize(fragmentVertexNormal);
+         vec3 viewDirection = normalize(viewPosition - fragmentPosition);
+
+         for(int i = 0; i < activeLightCount; i++)
+         {
+            phongResult += CalcLightSource(lightSources[i], lightNormal, fragmentPosition, viewDirection); 
+         }   
+      }
     
       if(bUseTexture == true)
       {
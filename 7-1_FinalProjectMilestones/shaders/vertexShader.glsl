@@ -1,4 +1,23 @@
 #version 330 core
+
+struct Material 
+{
+    vec3 diffuseColor;
+    vec3 specularColor;
+    float shininess;
+}; 
+
+struct LightSource 
+{
+    vec3 position;	
+    vec3 diffuseColor;
+    vec3 specularColor;
+    float focalStrength;
+    float specularIntensity;
+};
+
+#define TOTAL_LIGHTS 4
+
 layout (location = 0) in vec3 inVertexPosition;
 layout (location = 1) in vec3 inVertexNormal;
 layout (location = 2) in vec2 inTextureCoordinate;
@@ -6,15 +25,93 @@ layout (location = 2) in vec2 inTextureCoordinate;
 out vec3 fragmentPosition;
 out vec3 fragmentVertexNormal;
 out vec2 fragmentTextureCoordinate;
+out vec3 vertexLightColor;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// the camera of the frame, written once per frame into a
+// region of a uniform buffer that is shared by both stages
+layout (std140) uniform FrameUniforms
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPosition;
+};
+
+// packed vertices store the position and texture coordinate
+// relative to the mesh bounds, and the normal as two
+// octahedral coordinates in the first two components
+uniform bool bPackedVertices = false;
+uniform vec3 positionScale = vec3(1.0f);
+uniform vec3 positionOffset = vec3(0.0f);
+uniform vec2 textureCoordinateScale = vec2(1.0f);
+uniform vec2 textureCoordinateOffset = vec2(0.0f);
+
+// the lower quality tiers light each vertex instead of each
+// fragment, and can use fewer of the scene lights
+uniform bool bUseLighting=false;
+uniform bool bPerVertexLighting=false;
+uniform int activeLightCount=TOTAL_LIGHTS;
+uniform LightSource lightSources[TOTAL_LIGHTS];
+uniform Material material;
+uniform vec3 globalAmbientColor;
+
+// function prototypes
+vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
+
+// decodes a normal that was encoded onto an octahedron
+vec3 OctahedralDecode(vec2 encoded)
+{
+   vec3 normal = vec3(encoded.xy, 1.0 - abs(encoded.x) - abs(encoded.y));
+   float fold = max(-normal.z, 0.0);
+   normal.x += (normal.x >= 0.0) ? -fold : fold;
+   normal.y += (normal.y >= 0.0) ? -fold : fold;
+   return normalize(normal);
+}
 
 void main()
 {
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
-   fragmentVertexNormal = inVertexNormal;
-   fragmentTextureCoordinate = inTextureCoordinate;
+   vec3 vertexPosition = inVertexPosition;
+   vec3 vertexNormal = inVertexNormal;
+   vec2 textureCoordinate = inTextureCoordinate;
+
+   if(bPackedVertices == true)
+   {
+      vertexPosition = positionOffset + (positionScale * inVertexPosition);
+      vertexNormal = OctahedralDecode(inVertexNormal.xy);
+      textureCoordinate = textureCoordinateOffset + (textureCoordinateScale * inTextureCoordinate);
+   }
+
+   fragmentPosition = vec3(model * vec4(vertexPosition, 1.0));
+   gl_Position = projection * view * model * vec4(vertexPosition, 1.0f);
+   fragmentVertexNormal = vertexNormal;
+   fragmentTextureCoordinate = textureCoordinate;
+
+   vertexLightColor = vec3(0.0f);
+   if((bUseLighting == true) && (bPerVertexLighting == true))
+   {
+      vec3 lightNormal = normalize(vertexNormal);
+      vec3 viewDirection = normalize(viewPosition - fragmentPosition);
+
+      for(int i = 0; i < activeLightCount; i++)
+      {
+         vertexLightColor += CalcLightSource(lightSources[i], lightNormal, fragmentPosition, viewDirection);
+      }
+   }
+}
+
+// calculates the color when using a directional light.
+vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+{
+   vec3 ambient = globalAmbientColor;
+
+   vec3 lightDirection = normalize(light.position - vertexPosition); 
+   float impact = max(dot(lightNormal, lightDirection), 0.0);
+   vec3 diffuse = impact * material.diffuseColor; 
+
+   vec3 reflectDir = reflect(-lightDirection, lightNormal);
+   float specularComponent = pow(max(dot(viewDirection, reflectDir), 0.0), light.focalStrength);
+   vec3 specular = (light.specularIntensity * material.shininess) * specularComponent * material.specularColor;
+  
+   return(ambient + diffuse + specular);
 }
\ No newline at end of file